@@ -0,0 +1,37 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace gtx::bench {
+
+// best_ms runs fn reps times and returns the fastest run in milliseconds,
+// the fastest run is the least disturbed by the rest of the machine
+template <typename Fn> auto best_ms(Fn&& fn, int reps = 7) -> double
+{
+    using clock = std::chrono::steady_clock;
+    auto best = 1e300;
+    for (int i = 0; i < reps; ++i) {
+        auto const t0 = clock::now();
+        fn();
+        auto const t1 = clock::now();
+        best = std::min(
+            best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+    }
+    return best;
+}
+
+// gbps is the throughput of bytes processed in ms
+inline auto gbps(double bytes, double ms) -> double
+{
+    return bytes / (ms * 1e6);
+}
+
+// keep stops the compiler from dropping work whose result is unused
+template <typename T> void keep(T const& v)
+{
+    asm volatile("" : : "g"(&v) : "memory");
+}
+
+} // namespace gtx::bench
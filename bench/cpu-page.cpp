@@ -0,0 +1,103 @@
+#include <gtx/tx-page.hpp>
+
+#include <algorithm>
+
+// cpu pages keep their texels in host memory in place of a backend, so that
+// the benchmarks and tests can run the CPU paths that end in page updates
+// without a device. An update copies the box like an upload into staging
+// memory.
+
+namespace gtx {
+
+struct texture::page_data {
+    page_data(page_data const&) = delete;
+    page_data(texel_size const& sz, format fmt, uint32_t levels)
+        : sz{sz}
+        , fmt{fmt}
+        , levels{levels}
+        , texels(std::size_t(sz.w) * sz.h)
+    {
+    }
+    ~page_data() { registry.erase(handle); }
+
+    texel_size sz;
+    format fmt;
+    uint32_t levels;
+    std::vector<uint32_t> texels;
+    page_handle handle;
+};
+
+static std::vector<std::shared_ptr<texture::page_data>> pages;
+
+auto texture::supports(format fmt) -> bool { return !is_compressed(fmt); }
+
+void texture::page::setup(
+    texel_size const& sz, bool, format fmt, uint32_t levels)
+{
+    auto pd = std::make_shared<page_data>(sz, fmt, is_plane(fmt) ? 1 : levels);
+    pd->handle =
+        registry.insert(pd, pd->texels.data(), uint32_t(-1), pd->sz);
+    pages.push_back(pd);
+    pd_ = pd;
+}
+
+auto texture::page::update(texel_box const& box, uint32_t const* data,
+    size_t data_stride, bool) -> bool
+{
+    auto pp = pd_.lock();
+    if (!pp || !data || data_stride < box.w || box.x + box.w > pp->sz.w ||
+        box.y + box.h > pp->sz.h || is_plane(pp->fmt))
+        return false;
+    for (uint32_t y = 0; y < box.h; ++y)
+        std::copy_n(data + y * data_stride, box.w,
+            pp->texels.data() + std::size_t(box.y + y) * pp->sz.w + box.x);
+    return true;
+}
+
+auto texture::page::update_blocks(texel_box const&, void const*, uint32_t)
+    -> bool
+{
+    return false;
+}
+
+auto texture::page::update_plane(texel_box const&, void const*, size_t)
+    -> bool
+{
+    return false;
+}
+
+auto texture::page::native_handle() const -> void*
+{
+    auto pp = pd_.lock();
+    return pp ? pp->texels.data() : nullptr;
+}
+
+auto texture::page::native_index() const -> uint32_t { return uint32_t(-1); }
+
+auto texture::page::handle() const -> page_handle
+{
+    auto pp = pd_.lock();
+    return pp ? pp->handle : page_handle{};
+}
+
+auto texture::page::get_size() const -> texel_size
+{
+    auto pp = pd_.lock();
+    return pp ? pp->sz : texel_size{};
+}
+
+auto texture::page::get_format() const -> format
+{
+    auto pp = pd_.lock();
+    return pp ? pp->fmt : format::rgba8;
+}
+
+auto texture::page::get_levels() const -> uint32_t
+{
+    auto pp = pd_.lock();
+    return pp ? pp->levels : 0;
+}
+
+void texture::page::release_all() { pages.clear(); }
+
+} // namespace gtx
@@ -0,0 +1,140 @@
+#include "bench.hpp"
+
+#include <gtx/pixel/raster.hpp>
+#include <gtx/tx-glyphs.hpp>
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// glyph-cache measures glyphs per millisecond for a full-screen text layout
+// through texture::glyph_cache. A cold frame rasterizes, packs and uploads
+// every distinct glyph on its first use, a warm frame only looks the glyphs
+// up and emits their quads the way shdr::glyph_run::add does. Outlines are
+// synthesized per glyph id and filled with pixel::fill in place of a font
+// library, pages are kept in host memory (see cpu-page.cpp).
+
+using namespace gtx;
+
+namespace {
+
+constexpr uint32_t cell_w = 10;
+constexpr uint32_t cell_h = 18;
+constexpr uint32_t screen_w = 1920;
+constexpr uint32_t screen_h = 1080;
+
+struct quad {
+    vec2<float> pos;
+    vec2<float> ax;
+    vec2<float> ay;
+    texture::uv_rect uv;
+};
+
+// outlines rasterizes a ring with a stem whose proportions depend on the
+// id, 32 (space) has no outline
+struct outlines {
+    pixel::path p;
+    std::vector<pixel::a8> coverage;
+    std::vector<uint32_t> pixels;
+
+    auto operator()(uint32_t id, texture::glyph_bitmap& bm) -> bool
+    {
+        if (id == 32)
+            return true;
+        auto const w = cell_w - 2;
+        auto const h = cell_h - 4 - id % 5;
+        auto const cx = 0.5f * float(w);
+        auto const cy = 0.5f * float(h);
+        auto const rx = cx - 0.5f;
+        auto const ry = cy - 0.5f;
+        auto const t = 1.0f + float(id % 3) * 0.5f;
+        p.clear();
+        ellipse(cx, cy, rx, ry);
+        ellipse(cx, cy, rx - t, ry - t);
+        if (id % 2) {
+            p.move_to({float(w) - t, 0.0f});
+            p.line_to({float(w), 0.0f});
+            p.line_to({float(w), float(h)});
+            p.line_to({float(w) - t, float(h)});
+            p.close();
+        }
+        coverage.resize(std::size_t(w) * h);
+        auto opts = pixel::fill_options{};
+        opts.rule = pixel::fill_rule::even_odd;
+        pixel::fill(p, surface<pixel::a8>{coverage.data(), w, h}, opts);
+        pixels.resize(coverage.size());
+        for (std::size_t i = 0; i < coverage.size(); ++i)
+            pixels[i] = uint32_t(coverage[i].value) << 24 | 0xffffff;
+        bm = {pixels.data(), w, h, w, 1.0f, -float(h)};
+        return true;
+    }
+
+    void ellipse(float cx, float cy, float rx, float ry)
+    {
+        // four quadratic arcs, close enough for a benchmark
+        p.move_to({cx + rx, cy});
+        p.quad_to({cx + rx, cy + ry}, {cx, cy + ry});
+        p.quad_to({cx - rx, cy + ry}, {cx - rx, cy});
+        p.quad_to({cx - rx, cy - ry}, {cx, cy - ry});
+        p.quad_to({cx + rx, cy - ry}, {cx + rx, cy});
+        p.close();
+    }
+};
+
+// layout emits a quad per inked glyph, as glyph_run::add
+void layout(texture::glyph_cache& cache, std::vector<uint32_t> const& text,
+    std::vector<quad>& quads)
+{
+    quads.clear();
+    auto const cols = screen_w / cell_w;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        auto const* g = cache.find(text[i]);
+        if (g->empty)
+            continue;
+        auto const& box = g->spr.get_box();
+        auto const x = float(i % cols * cell_w);
+        auto const y = float(i / cols * cell_h + cell_h);
+        quads.push_back({{x + g->left, y + g->top}, {float(box.w), 0.0f},
+            {0.0f, float(box.h)}, g->spr.uv_rect()});
+    }
+}
+
+void run(char const* name, float sdf_radius,
+    std::vector<uint32_t> const& text)
+{
+    auto quads = std::vector<quad>{};
+    quads.reserve(text.size());
+    auto const cold = bench::best_ms([&] {
+        auto cache =
+            texture::glyph_cache{{1024, 1024}, outlines{}, sdf_radius};
+        layout(cache, text, quads);
+    });
+    auto cache = texture::glyph_cache{{1024, 1024}, outlines{}, sdf_radius};
+    layout(cache, text, quads);
+    auto const warm = bench::best_ms([&] { layout(cache, text, quads); });
+    bench::keep(quads);
+    std::printf("%-8s %8zu glyphs  cold %8.1f glyphs/ms  warm %9.1f "
+                "glyphs/ms\n",
+        name, text.size(), double(text.size()) / cold,
+        double(text.size()) / warm);
+}
+
+} // namespace
+
+int main()
+{
+    // printable ascii with about one space in six, a fixed sequence
+    auto text =
+        std::vector<uint32_t>((screen_w / cell_w) * (screen_h / cell_h));
+    auto seed = uint32_t(1);
+    for (auto& id : text) {
+        seed = seed * 1664525 + 1013904223;
+        id = (seed >> 8) % 6 == 0 ? 32 : 33 + (seed >> 16) % 94;
+    }
+
+    std::printf("full-screen layout %ux%u, %ux%u cells\n", screen_w, screen_h,
+        cell_w, cell_h);
+    run("bitmap", 0.0f, text);
+    run("sdf", 4.0f, text);
+    return 0;
+}
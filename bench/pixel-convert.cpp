@@ -0,0 +1,117 @@
+#include "bench.hpp"
+#include "simd.hpp"
+
+#include <gtx/pixel/convert.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// pixel-convert measures the throughput of pixel::convert in GB/s (bytes
+// read plus bytes written) for the scalar, SSE4.1 and AVX2 kernels. The
+// kernels are picked once per process, so the benchmark runs itself once
+// per instruction set with GTX_SIMD set. "1 thread" converts the frame in
+// strips small enough to stay on the calling thread, "pool" converts it in
+// one call spread over the default executor.
+
+using namespace gtx;
+
+namespace {
+
+constexpr std::size_t frame_w = 1920;
+constexpr std::size_t frame_h = 1080;
+constexpr std::size_t strip_h = 8;
+
+template <typename Src, typename Dst> void run(char const* name)
+{
+    auto src = std::vector<Src>(frame_w * frame_h);
+    auto dst = std::vector<Dst>(frame_w * frame_h);
+    auto seed = uint32_t(1);
+    for (auto& p : src) {
+        seed = seed * 1664525 + 1013904223;
+        p.value = typename Src::value_type(seed >> 8);
+    }
+    auto const s = surface<Src>{src.data(), frame_w, frame_h};
+    auto d = surface<Dst>{dst.data(), frame_w, frame_h};
+
+    auto const one = bench::best_ms([&] {
+        for (std::size_t y = 0; y < frame_h; y += strip_h)
+            pixel::convert(s.subsurface(0, y, frame_w, strip_h),
+                d.subsurface(0, y, frame_w, strip_h));
+        bench::keep(dst);
+    });
+    auto const pool = bench::best_ms([&] {
+        pixel::convert(s, d);
+        bench::keep(dst);
+    });
+    auto const bytes = double(frame_w * frame_h * (sizeof(Src) + sizeof(Dst)));
+    std::printf("  %-18s 1 thread %7.2f GB/s  pool %7.2f GB/s\n", name,
+        bench::gbps(bytes, one), bench::gbps(bytes, pool));
+}
+
+auto isa_name(simd::isa v) -> char const*
+{
+    switch (v) {
+    case simd::isa::scalar:
+        return "scalar";
+    case simd::isa::sse41:
+        return "sse41";
+    case simd::isa::avx2:
+        return "avx2";
+    case simd::isa::neon:
+        return "neon";
+    }
+    return "?";
+}
+
+// measure runs the conversions with the kernels selected for this process
+auto measure(char const* wanted) -> int
+{
+    auto const got = isa_name(simd::active());
+    if (std::strcmp(got, wanted)) {
+        std::printf("%s: not supported here, %s selected\n", wanted, got);
+        return 0;
+    }
+    std::printf("%s, %zux%zu\n", got, frame_w, frame_h);
+    run<pixel::nargb8888, pixel::xrgb8888>("nargb8888 -> xrgb");
+    run<pixel::xrgb8888, pixel::rgb565>("xrgb8888 -> 565");
+    run<pixel::rgb565, pixel::xrgb8888>("rgb565 -> xrgb");
+    run<pixel::xrgb8888, pixel::l8>("xrgb8888 -> l8");
+    run<pixel::nargb8888, pixel::a8>("nargb8888 -> a8");
+    run<pixel::l8, pixel::xrgb8888>("l8 -> xrgb");
+    run<pixel::a8, pixel::nargb8888>("a8 -> nargb");
+    return 0;
+}
+
+void set_simd(char const* v)
+{
+#if defined(_WIN32)
+    _putenv_s("GTX_SIMD", v);
+#else
+    setenv("GTX_SIMD", v, 1);
+#endif
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc > 1) {
+        set_simd(argv[1]);
+        return measure(argv[1]);
+    }
+#if defined(GTX_SIMD_NEON)
+    char const* const variants[] = {"scalar", "neon"};
+#else
+    char const* const variants[] = {"scalar", "sse41", "avx2"};
+#endif
+    for (auto const* v : variants) {
+        auto const cmd = "\"" + std::string(argv[0]) + "\" " + v;
+        std::fflush(stdout);
+        if (std::system(cmd.c_str()))
+            return 1;
+    }
+    return 0;
+}
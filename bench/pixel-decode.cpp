@@ -0,0 +1,176 @@
+#include "bench.hpp"
+
+#include <gtx/image.hpp>
+#include <gtx/pixel/convert.hpp>
+#include <gtx/pixel/decode.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+// pixel-decode compares pixel::decode straight into an atlas tile with the
+// usual path of decoding to an nargb8888 image, converting it to the page
+// format and copying it into the tile. The images are a 1920x1080 frame of
+// gradients and flat areas, encoded as QOI and as a binary PPM, and the
+// tile is a subsurface of a 2048x2048 staging page.
+
+using namespace gtx;
+
+namespace {
+
+constexpr uint32_t frame_w = 1920;
+constexpr uint32_t frame_h = 1080;
+constexpr std::size_t page_side = 2048;
+constexpr std::size_t tile_x = 64;
+constexpr std::size_t tile_y = 64;
+
+struct rgba {
+    uint8_t r, g, b, a;
+};
+
+auto frame() -> std::vector<rgba>
+{
+    auto px = std::vector<rgba>(std::size_t(frame_w) * frame_h);
+    auto seed = uint32_t(1);
+    for (uint32_t y = 0; y < frame_h; ++y)
+        for (uint32_t x = 0; x < frame_w; ++x) {
+            seed = seed * 1664525 + 1013904223;
+            auto& p = px[std::size_t(y) * frame_w + x];
+            if ((x / 240 + y / 135) % 3 == 0)
+                p = {40, 90, 160, 255}; // flat, runs
+            else
+                p = {uint8_t(x / 8), uint8_t(y / 5),
+                    uint8_t((x + y) / 12 + (seed >> 30)), 255};
+        }
+    return px;
+}
+
+void put(std::vector<std::byte>& out, std::initializer_list<unsigned> v)
+{
+    for (auto x : v)
+        out.push_back(std::byte(x));
+}
+
+void put32(std::vector<std::byte>& out, uint32_t v)
+{
+    put(out, {v >> 24, (v >> 16) & 0xff, (v >> 8) & 0xff, v & 0xff});
+}
+
+auto encode_qoi(std::vector<rgba> const& px) -> std::vector<std::byte>
+{
+    auto out = std::vector<std::byte>{};
+    put(out, {'q', 'o', 'i', 'f'});
+    put32(out, frame_w);
+    put32(out, frame_h);
+    put(out, {4, 0});
+
+    rgba index[64] = {};
+    auto prev = rgba{0, 0, 0, 255};
+    auto run = 0u;
+    for (std::size_t i = 0; i < px.size(); ++i) {
+        auto const p = px[i];
+        if (!std::memcmp(&p, &prev, sizeof p)) {
+            if (++run == 62 || i + 1 == px.size()) {
+                put(out, {0xc0 | (run - 1)});
+                run = 0;
+            }
+            continue;
+        }
+        if (run) {
+            put(out, {0xc0 | (run - 1)});
+            run = 0;
+        }
+        auto const h = (p.r * 3 + p.g * 5 + p.b * 7 + p.a * 11) % 64;
+        if (!std::memcmp(&index[h], &p, sizeof p))
+            put(out, {unsigned(h)});
+        else if (p.a != prev.a)
+            put(out, {0xff, p.r, p.g, p.b, p.a});
+        else {
+            auto const dr = int8_t(p.r - prev.r);
+            auto const dg = int8_t(p.g - prev.g);
+            auto const db = int8_t(p.b - prev.b);
+            if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 &&
+                db <= 1)
+                put(out, {0x40 | unsigned(dr + 2) << 4 |
+                          unsigned(dg + 2) << 2 | unsigned(db + 2)});
+            else if (dg >= -32 && dg <= 31 && dr - dg >= -8 && dr - dg <= 7 &&
+                     db - dg >= -8 && db - dg <= 7)
+                put(out, {0x80 | unsigned(dg + 32),
+                    unsigned(dr - dg + 8) << 4 | unsigned(db - dg + 8)});
+            else
+                put(out, {0xfe, p.r, p.g, p.b});
+        }
+        index[h] = p;
+        prev = p;
+    }
+    put(out, {0, 0, 0, 0, 0, 0, 0, 1});
+    return out;
+}
+
+auto encode_ppm(std::vector<rgba> const& px) -> std::vector<std::byte>
+{
+    char header[32];
+    auto const n = std::snprintf(
+        header, sizeof header, "P6\n%u %u\n255\n", frame_w, frame_h);
+    auto out = std::vector<std::byte>{};
+    for (int i = 0; i < n; ++i)
+        put(out, {unsigned(uint8_t(header[i]))});
+    for (auto const& p : px)
+        put(out, {p.r, p.g, p.b});
+    return out;
+}
+
+template <typename T>
+void run(char const* name, std::vector<std::byte> const& data)
+{
+    auto page = std::vector<T>(page_side * page_side);
+    auto tile = surface<T>{page.data(), page_side, page_side}.subsurface(
+        tile_x, tile_y, frame_w, frame_h);
+    if (!pixel::decode(data, tile)) {
+        std::printf("  %-10s decode failed\n", name);
+        return;
+    }
+
+    auto const direct = bench::best_ms([&] {
+        pixel::decode(data, tile);
+        bench::keep(page);
+    });
+
+    auto decoded = image<pixel::nargb8888>{frame_w, frame_h};
+    auto converted = image<T>{frame_w, frame_h};
+    auto const staged = bench::best_ms([&] {
+        pixel::decode(data, decoded.view());
+        pixel::convert(decoded.view(), converted.view());
+        auto const c = converted.view();
+        for (std::size_t y = 0; y < frame_h; ++y)
+            std::memcpy(tile.data() + y * tile.stride(),
+                c.data() + y * c.stride(), frame_w * sizeof(T));
+        bench::keep(page);
+    });
+
+    auto const mpx = double(frame_w) * frame_h / 1e6;
+    std::printf("  %-10s direct %8.1f Mpx/s  decode+convert+copy %8.1f "
+                "Mpx/s  %5.2fx\n",
+        name, mpx / direct * 1e3, mpx / staged * 1e3, staged / direct);
+}
+
+} // namespace
+
+int main()
+{
+    auto const px = frame();
+    auto const qoi = encode_qoi(px);
+    auto const ppm = encode_ppm(px);
+    for (auto const& [label, data] :
+        {std::pair{"qoi", &qoi}, std::pair{"ppm", &ppm}}) {
+        std::printf("%s %ux%u, %zu bytes\n", label, frame_w, frame_h,
+            data->size());
+        run<pixel::nargb8888>("nargb8888", *data);
+        run<pixel::xrgb8888>("xrgb8888", *data);
+        run<pixel::rgb565>("rgb565", *data);
+        run<pixel::l8>("l8", *data);
+    }
+    return 0;
+}
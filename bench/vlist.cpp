@@ -0,0 +1,105 @@
+#include "bench.hpp"
+
+#include <gtx/geom/vec.hpp>
+#include <gtx/vlist.hpp>
+
+#include <cstdio>
+#include <functional>
+#include <span>
+#include <vector>
+
+// vlist measures how fast polylines are built into a vlist, in millions of
+// vertices per second, with one write per vertex through a type erased
+// callback_type, one write per vertex through a lambda, a single span
+// write per segment and emplace filling the segment in place. The vertex
+// has the layout of shdr::polyline::vertex. All runs share one list that is
+// cleared but keeps its capacity, as it does from frame to frame, so that
+// they write to the same memory.
+
+using namespace gtx;
+
+namespace {
+
+constexpr std::size_t segment_count = 2000;
+constexpr std::size_t segment_size = 500;
+
+struct vertex {
+    vec2<float> pos;
+    float thk = 0.0f;
+    float dummy = 0.0f;
+    vec4<float> clr;
+    vertex() = default;
+    vertex(vec2<float> const& pos, float thk, vec4<float> const& clr)
+        : pos{pos}
+        , thk{thk}
+        , clr{clr}
+    {
+    }
+};
+
+using list = vlist<vertex>;
+
+auto at(std::size_t s, std::size_t i) -> vertex
+{
+    return {{float(i), float(s)}, 1.5f, {1.0f, 0.5f, 0.25f, 1.0f}};
+}
+
+// run is kept out of line, inlined into main the runs were compiled into
+// one body and the speed of a run depended on the runs around it
+template <typename Fn>
+[[gnu::noinline]] void run(list& vl, char const* name, Fn&& build)
+{
+    vl.clear();
+    build(vl);
+    auto const ms = bench::best_ms([&] {
+        vl.clear();
+        build(vl);
+        bench::keep(vl);
+    });
+    auto const mv = double(segment_count * segment_size) / 1e6;
+    std::printf("  %-24s %8.1f Mvertices/s\n", name, mv / ms * 1e3);
+}
+
+} // namespace
+
+int main()
+{
+    std::printf("%zu segments of %zu vertices, %zu bytes each\n",
+        segment_count, segment_size, sizeof(vertex));
+    auto vl = list{};
+
+    run(vl, "callback_type per vertex", [](list& vl) {
+        for (std::size_t s = 0; s < segment_count; ++s) {
+            auto const cb = list::callback_type{[s](list::write const& w) {
+                for (std::size_t i = 0; i < segment_size; ++i)
+                    w(at(s, i));
+            }};
+            vl.insert(cb);
+        }
+    });
+    run(vl, "lambda per vertex", [](list& vl) {
+        for (std::size_t s = 0; s < segment_count; ++s)
+            vl.insert([s](list::write const& w) {
+                for (std::size_t i = 0; i < segment_size; ++i)
+                    w(at(s, i));
+            });
+    });
+
+    auto scratch = std::vector<vertex>(segment_size);
+    run(vl, "span per segment", [&](list& vl) {
+        for (std::size_t s = 0; s < segment_count; ++s) {
+            for (std::size_t i = 0; i < segment_size; ++i)
+                scratch[i] = at(s, i);
+            vl.insert(std::span<vertex const>{scratch});
+        }
+    });
+    run(vl, "emplace per segment", [](list& vl) {
+        for (std::size_t s = 0; s < segment_count; ++s)
+            vl.insert([s](list::write const& w) {
+                auto* v = w.emplace(segment_size);
+                for (std::size_t i = 0; i < segment_size; ++i)
+                    v[i] = at(s, i);
+            });
+    });
+    return 0;
+}
@@ -91,6 +91,11 @@ struct input_layout : public Microsoft::WRL::ComPtr<ID3D11InputLayout> {
     void bind();
 };
 
+struct sampler_state : public Microsoft::WRL::ComPtr<ID3D11SamplerState> {
+    sampler_state(D3D11_TEXTURE_ADDRESS_MODE address_mode);
+    void bind_ps(unsigned slot);
+};
+
 template <typename T>
 struct constant_buffer : public Microsoft::WRL::ComPtr<ID3D11Buffer> {
     using value_type = T;
@@ -244,6 +249,10 @@ enum class state {
     vertex_buffer_0,
     input_layout,
     primitive_topology,
+    ps_shader_resource_0,
+    ps_shader_resource_1,
+    ps_shader_resource_2,
+    ps_sampler_0,
 };
 
 namespace detail {
@@ -455,6 +464,55 @@ template <> struct save<state::primitive_topology> {
     D3D11_PRIMITIVE_TOPOLOGY save_primitive_topology;
 };
 
+template <UINT Slot> struct save_ps_shader_resource {
+    save_ps_shader_resource()
+    {
+        auto context = get_device().context;
+        if (!context)
+            throw error("missing context");
+        context->PSGetShaderResources(Slot, 1, &save_srv);
+    }
+
+    ~save_ps_shader_resource()
+    {
+        auto context = get_device().context;
+        if (context)
+            context->PSSetShaderResources(Slot, 1, &save_srv);
+        if (save_srv)
+            save_srv->Release();
+    }
+
+    ID3D11ShaderResourceView* save_srv;
+};
+
+template <>
+struct save<state::ps_shader_resource_0> : save_ps_shader_resource<0> {};
+template <>
+struct save<state::ps_shader_resource_1> : save_ps_shader_resource<1> {};
+template <>
+struct save<state::ps_shader_resource_2> : save_ps_shader_resource<2> {};
+
+template <> struct save<state::ps_sampler_0> {
+    save()
+    {
+        auto context = get_device().context;
+        if (!context)
+            throw error("missing context");
+        context->PSGetSamplers(0, 1, &save_sampler);
+    }
+
+    ~save()
+    {
+        auto context = get_device().context;
+        if (context)
+            context->PSSetSamplers(0, 1, &save_sampler);
+        if (save_sampler)
+            save_sampler->Release();
+    }
+
+    ID3D11SamplerState* save_sampler;
+};
+
 } // namespace detail
 
 template <state... Args> using save = std::tuple<detail::save<Args>...>;
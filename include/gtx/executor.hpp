@@ -0,0 +1,130 @@
+#pragma once
+
+#include <gtx/pixel/pixel.hpp>
+#include <gtx/surface.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace gtx {
+
+// scratch_arena is a per-worker bump allocator for temporary buffers, its
+// blocks come from the default buffer_pool and are kept between tasks,
+// everything allocated by a task is released when the task returns
+class scratch_arena {
+public:
+    struct marker {
+        std::size_t block = 0;
+        std::size_t offset = 0;
+    };
+
+    scratch_arena() = default;
+    scratch_arena(scratch_arena const&) = delete;
+    ~scratch_arena();
+
+    // align must be a power of two, at most 64
+    auto allocate(std::size_t bytes, std::size_t align = 16) -> void*;
+
+    template <typename T> auto allocate_array(std::size_t n) -> std::span<T>
+    {
+        static_assert(std::is_trivially_destructible_v<T>);
+        return {static_cast<T*>(allocate(n * sizeof(T), alignof(T))), n};
+    }
+
+    auto mark() const -> marker { return {current_, offset_}; }
+    void rewind(marker m)
+    {
+        current_ = m.block;
+        offset_ = m.offset;
+    }
+    void reset() { rewind({}); }
+
+private:
+    struct block {
+        void* data;
+        std::size_t size;
+    };
+    std::vector<block> blocks_;
+    std::size_t current_ = 0;
+    std::size_t offset_ = 0;
+};
+
+// executor is a small work-stealing pool: parallel_for splits the index
+// range evenly across the participants (the calling thread included),
+// each participant takes indices from the front of its own range and, once
+// that is exhausted, steals the back half of another one. Calls from
+// inside a task run inline. The first exception thrown by a task is
+// rethrown by parallel_for once all participants are done, remaining
+// indices are skipped.
+class executor {
+public:
+    // threads counts the calling thread, 0 uses all hardware threads
+    explicit executor(unsigned threads = 0);
+    executor(executor const&) = delete;
+    ~executor();
+
+    auto concurrency() const -> unsigned;
+
+    // fn(std::size_t index, scratch_arena&) is called once per index, with
+    // deterministic set every participant processes a fixed contiguous part
+    // of the range in ascending order and nothing is stolen
+    template <typename Fn>
+    void parallel_for(std::size_t n, Fn&& fn, bool deterministic = false)
+    {
+        using F = std::remove_reference_t<Fn>;
+        run(
+            n,
+            [](void* ctx, std::size_t i, scratch_arena& arena) {
+                (*static_cast<F*>(ctx))(i, arena);
+            },
+            const_cast<void*>(static_cast<void const*>(&fn)), deterministic);
+    }
+
+private:
+    using task_fn = void (*)(void* ctx, std::size_t i, scratch_arena& arena);
+    void run(std::size_t n, task_fn fn, void* ctx, bool deterministic);
+
+    struct impl;
+    std::unique_ptr<impl> impl_;
+};
+
+// default_executor is shared by the library kernels, it is created on
+// first use with one participant per hardware thread
+auto default_executor() -> executor&;
+
+struct tile_options {
+    bool deterministic = false;
+    executor* exec = nullptr; // default_executor() when null
+};
+
+// parallel_for_tiles carves s into tiles of at most tile_size (edge tiles
+// are clipped) and calls fn(surface<T> tile, pixel::coord origin,
+// scratch_arena&) for each of them concurrently, tiles are numbered in
+// row-major order which is the processing order of the deterministic mode
+template <typename T, typename Fn>
+void parallel_for_tiles(surface<T> const& s, pixel::size tile_size, Fn&& fn,
+    tile_options const& opts = {})
+{
+    if (s.empty() || !tile_size.w || !tile_size.h)
+        return;
+
+    auto const tw = std::size_t(tile_size.w);
+    auto const th = std::size_t(tile_size.h);
+    auto const cols = (s.width() + tw - 1) / tw;
+    auto const rows = (s.height() + th - 1) / th;
+    auto& ex = opts.exec ? *opts.exec : default_executor();
+    ex.parallel_for(
+        cols * rows,
+        [&](std::size_t i, scratch_arena& arena) {
+            auto const x = i % cols * tw;
+            auto const y = i / cols * th;
+            fn(s.subsurface(x, y, tw, th), pixel::coord{unsigned(x), unsigned(y)},
+                arena);
+        },
+        opts.deterministic);
+}
+
+} // namespace gtx
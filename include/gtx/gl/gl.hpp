@@ -2,6 +2,7 @@
 
 #include <glad/glad.h>
 #include <initializer_list>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -25,6 +26,9 @@ enum class state {
     program,
     array_buffer,
     vertex_array,
+    texture_2d,
+    texture_2d_1,
+    texture_2d_2,
 };
 
 namespace detail {
@@ -49,6 +53,51 @@ template <> struct save<state::vertex_array> {
     GLint v;
 };
 
+// saves the 2d texture bound to unit 0, leaves unit 0 active until restored
+template <> struct save<state::texture_2d> {
+    save()
+    {
+        glGetIntegerv(GL_ACTIVE_TEXTURE, &unit);
+        glActiveTexture(GL_TEXTURE0);
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &v);
+    }
+    ~save()
+    {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, v);
+        glActiveTexture(unit);
+    }
+    GLint unit;
+    GLint v;
+};
+
+// saves the 2d texture bound to another unit, the active unit is kept so
+// that the order of the savers does not matter
+template <GLenum Unit> struct save_texture_unit {
+    save_texture_unit()
+    {
+        GLint active;
+        glGetIntegerv(GL_ACTIVE_TEXTURE, &active);
+        glActiveTexture(Unit);
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &v);
+        glActiveTexture(active);
+    }
+    ~save_texture_unit()
+    {
+        GLint active;
+        glGetIntegerv(GL_ACTIVE_TEXTURE, &active);
+        glActiveTexture(Unit);
+        glBindTexture(GL_TEXTURE_2D, v);
+        glActiveTexture(active);
+    }
+    GLint v;
+};
+
+template <>
+struct save<state::texture_2d_1> : save_texture_unit<GL_TEXTURE1> {};
+template <>
+struct save<state::texture_2d_2> : save_texture_unit<GL_TEXTURE2> {};
+
 } // namespace detail
 
 template <state... Args> using save = std::tuple<detail::save<Args>...>;
@@ -369,14 +418,34 @@ struct vertex_attrib {
     comp comptype;
     size_t stride;
     size_t offset;
+    GLuint divisor = 0; // non-zero for per-instance attributes
 };
 
 struct vertex_array : public named {
     vertex_array() noexcept { glGenVertexArrays(1, &name); }
     vertex_array(buffer<GL_ARRAY_BUFFER> const& vertex_buffer, program const& p,
         std::initializer_list<vertex_attrib> attribs)
+        : vertex_array{vertex_buffer, p,
+              std::span<vertex_attrib const>{attribs.begin(), attribs.size()}}
+    {
+    }
+    vertex_array(buffer<GL_ARRAY_BUFFER> const& vertex_buffer, program const& p,
+        std::span<vertex_attrib const> attribs)
     {
         glGenVertexArrays(1, &name);
+        setup(vertex_buffer, p, attribs);
+    }
+
+    vertex_array(vertex_array&& other) noexcept = default;
+    ~vertex_array() { glDeleteVertexArrays(1, &name); }
+    void bind() { glBindVertexArray(name); }
+
+    // setup binds the array and points attributes into vertex_buffer,
+    // base_offset shifts all attributes (e.g. to the first instance of a run
+    // when base instance drawing is unavailable)
+    void setup(buffer<GL_ARRAY_BUFFER> const& vertex_buffer, program const& p,
+        std::span<vertex_attrib const> attribs, size_t base_offset = 0)
+    {
         bind();
         vertex_buffer.bind();
         for (auto&& attr : attribs) {
@@ -385,29 +454,32 @@ struct vertex_array : public named {
                 continue;
 
             glEnableVertexAttribArray(location);
+            if (attr.divisor)
+                glVertexAttribDivisor(location, attr.divisor);
+
+            auto const offset = base_offset + attr.offset;
 
             auto as_unorm = [&](GLenum type) {
                 glVertexAttribPointer(location, attr.ncomps, type, GL_FALSE,
                     static_cast<GLsizei>(attr.stride),
-                    reinterpret_cast<GLvoid const*>(attr.offset));
+                    reinterpret_cast<GLvoid const*>(offset));
             };
             auto as_norm = [&](GLenum type) {
                 glVertexAttribPointer(location, attr.ncomps, type, GL_FALSE,
                     static_cast<GLsizei>(attr.stride),
-                    reinterpret_cast<GLvoid const*>(attr.offset));
+                    reinterpret_cast<GLvoid const*>(offset));
             };
             auto as_int = [&](GLenum type) {
                 glVertexAttribIPointer(location, attr.ncomps, type,
                     static_cast<GLsizei>(attr.stride),
-                    reinterpret_cast<GLvoid const*>(attr.offset));
+                    reinterpret_cast<GLvoid const*>(offset));
             };
 
             auto as_dbl = [&]() {
                 glVertexAttribLPointer(location, attr.ncomps, GL_DOUBLE,
                     static_cast<GLsizei>(attr.stride),
-                    reinterpret_cast<GLvoid const*>(attr.offset));
+                    reinterpret_cast<GLvoid const*>(offset));
             };
-
             switch (attr.comptype) {
             case comp::f32_unorm:
                 as_unorm(GL_FLOAT);
@@ -482,10 +554,6 @@ struct vertex_array : public named {
             }
         }
     }
-
-    vertex_array(vertex_array&& other) noexcept = default;
-    ~vertex_array() { glDeleteVertexArrays(1, &name); }
-    void bind() { glBindVertexArray(name); }
 };
 
 } // namespace gtx::gl
\ No newline at end of file
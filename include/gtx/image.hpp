@@ -0,0 +1,199 @@
+#pragma once
+
+#include <gtx/surface.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace gtx {
+
+// buffer_pool recycles 64-byte aligned allocations by power-of-two size
+// class, released buffers are cached for reuse until the cache limit is
+// reached or trim is called, requests above the largest class bypass it
+struct buffer_pool {
+    static constexpr std::size_t alignment = 64;
+    static constexpr std::size_t min_class = 12; // 4 KiB
+    static constexpr std::size_t max_class = 28; // 256 MiB
+
+    buffer_pool(std::size_t max_cached_bytes = std::size_t(256) << 20)
+        : max_cached_{max_cached_bytes}
+    {
+    }
+
+    buffer_pool(buffer_pool const&) = delete;
+    ~buffer_pool() { trim(); }
+
+    // capacity returns the size of the buffer actually handed out for a
+    // request of the given size
+    static auto capacity(std::size_t bytes) -> std::size_t
+    {
+        auto const c = size_class(bytes);
+        return c > max_class ? bytes : std::size_t(1) << c;
+    }
+
+    auto acquire(std::size_t bytes) -> void*
+    {
+        if (!bytes)
+            return nullptr;
+        auto const c = size_class(bytes);
+        if (c <= max_class) {
+            auto lock = std::lock_guard{mutex_};
+            auto& list = free_[c - min_class];
+            if (!list.empty()) {
+                auto p = list.back();
+                list.pop_back();
+                cached_ -= std::size_t(1) << c;
+                return p;
+            }
+        }
+        return ::operator new(capacity(bytes), std::align_val_t{alignment});
+    }
+
+    void release(void* p, std::size_t bytes)
+    {
+        if (!p)
+            return;
+        auto const c = size_class(bytes);
+        if (c <= max_class) {
+            auto lock = std::lock_guard{mutex_};
+            if (cached_ + (std::size_t(1) << c) <= max_cached_) {
+                free_[c - min_class].push_back(p);
+                cached_ += std::size_t(1) << c;
+                return;
+            }
+        }
+        ::operator delete(p, std::align_val_t{alignment});
+    }
+
+    // trim frees all cached buffers
+    void trim()
+    {
+        auto lock = std::lock_guard{mutex_};
+        for (auto& list : free_) {
+            for (auto p : list)
+                ::operator delete(p, std::align_val_t{alignment});
+            list.clear();
+        }
+        cached_ = 0;
+    }
+
+    auto cached_bytes() const -> std::size_t { return cached_; }
+
+private:
+    std::mutex mutex_;
+    std::vector<void*> free_[max_class - min_class + 1];
+    std::size_t cached_ = 0;
+    std::size_t max_cached_;
+
+    static auto size_class(std::size_t bytes) -> std::size_t
+    {
+        return std::max(min_class, std::size_t(std::bit_width(bytes - 1)));
+    }
+};
+
+inline auto default_buffer_pool() -> buffer_pool&
+{
+    static buffer_pool pool;
+    return pool;
+}
+
+// image is an owning pixel buffer, rows start on 64-byte boundaries (the
+// stride is rounded up accordingly) and the memory comes from a
+// buffer_pool, the pixels are not initialized
+template <typename T> struct image {
+    using pixel_type = T;
+    static_assert(buffer_pool::alignment % sizeof(T) == 0);
+
+    image() noexcept {}
+
+    image(std::size_t w, std::size_t h,
+        buffer_pool& pool = default_buffer_pool())
+        : pool_{&pool}
+        , width_{w}
+        , height_{h}
+        , stride_{aligned_stride(w)}
+    {
+        data_ = static_cast<T*>(pool_->acquire(bytes()));
+    }
+
+    image(image const&) = delete;
+
+    image(image&& other) noexcept
+        : pool_{other.pool_}
+        , data_{std::exchange(other.data_, nullptr)}
+        , width_{std::exchange(other.width_, 0)}
+        , height_{std::exchange(other.height_, 0)}
+        , stride_{std::exchange(other.stride_, 0)}
+    {
+    }
+
+    auto operator=(image&& other) noexcept -> image&
+    {
+        if (this != &other) {
+            reset();
+            pool_ = other.pool_;
+            data_ = std::exchange(other.data_, nullptr);
+            width_ = std::exchange(other.width_, 0);
+            height_ = std::exchange(other.height_, 0);
+            stride_ = std::exchange(other.stride_, 0);
+        }
+        return *this;
+    }
+
+    ~image() { reset(); }
+
+    // reset returns the buffer to its pool
+    void reset()
+    {
+        if (data_)
+            pool_->release(data_, bytes());
+        data_ = nullptr;
+        width_ = height_ = stride_ = 0;
+    }
+
+    void fill(T const& value)
+    {
+        for (std::size_t y = 0; y < height_; ++y)
+            std::fill_n(row(y), width_, value);
+    }
+
+    auto empty() const noexcept { return !data_ || !width_ || !height_; }
+    auto width() const noexcept { return width_; }
+    auto height() const noexcept { return height_; }
+    auto stride() const noexcept { return stride_; } // in pixels
+    auto data() const noexcept -> T const* { return data_; }
+    auto data() noexcept -> T* { return data_; }
+    auto row(std::size_t y) noexcept -> T* { return data_ + y * stride_; }
+    auto row(std::size_t y) const noexcept -> T const*
+    {
+        return data_ + y * stride_;
+    }
+
+    auto view() const noexcept -> surface<T>
+    {
+        return surface<T>{data_, width_, height_, stride_};
+    }
+    operator surface<T>() const noexcept { return view(); }
+
+    static auto aligned_stride(std::size_t w) -> std::size_t
+    {
+        constexpr auto per_line = buffer_pool::alignment / sizeof(T);
+        return (w + per_line - 1) / per_line * per_line;
+    }
+
+private:
+    buffer_pool* pool_ = nullptr;
+    T* data_ = nullptr;
+    std::size_t width_ = 0;
+    std::size_t height_ = 0;
+    std::size_t stride_ = 0;
+
+    auto bytes() const -> std::size_t { return stride_ * height_ * sizeof(T); }
+};
+
+} // namespace gtx
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <gtx/pixel/pixel.hpp>
+#include <gtx/surface.hpp>
+
+namespace gtx::pixel {
+
+// premultiply scales the color channels by alpha with an exact rounded
+// division by 255, c' = (c * a + 127) / 255, alpha is unchanged
+void premultiply(surface<nargb8888>& s);
+void premultiply(surface<nargb8888> const& src, surface<nargb8888>& dst);
+
+// unpremultiply is the inverse: c' = min(255, round(c * 255 / a)), fully
+// transparent pixels come out as zero
+void unpremultiply(surface<nargb8888>& s);
+void unpremultiply(surface<nargb8888> const& src, surface<nargb8888>& dst);
+
+// premultiply over raw nargb8888 rows (strides in pixels), used by the
+// upload paths to premultiply while copying into staging memory
+void premultiply(uint32_t const* src, std::size_t src_stride, uint32_t* dst,
+    std::size_t dst_stride, std::size_t w, std::size_t h);
+
+inline void premultiply(surface<nargb8888>&& s) { premultiply(s); }
+inline void premultiply(
+    surface<nargb8888> const& src, surface<nargb8888>&& dst)
+{
+    premultiply(src, dst);
+}
+inline void unpremultiply(surface<nargb8888>&& s) { unpremultiply(s); }
+inline void unpremultiply(
+    surface<nargb8888> const& src, surface<nargb8888>&& dst)
+{
+    unpremultiply(src, dst);
+}
+
+} // namespace gtx::pixel
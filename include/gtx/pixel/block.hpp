@@ -0,0 +1,50 @@
+#pragma once
+
+#include <gtx/pixel/pixel.hpp>
+#include <gtx/surface.hpp>
+
+#include <cstddef>
+
+namespace gtx {
+class executor;
+}
+
+namespace gtx::pixel {
+
+// block_format is a 4x4 block compression format
+enum class block_format {
+    bc1, // 8 bytes per block, rgb with 1-bit alpha
+    bc3, // 16 bytes per block, rgb and interpolated alpha
+    bc7, // 16 bytes per block, rgba (mode 6 only)
+};
+
+constexpr auto block_bytes(block_format f) -> std::size_t
+{
+    return f == block_format::bc1 ? 8 : 16;
+}
+
+// encoded_size returns the bytes of tightly packed blocks for w x h pixels
+constexpr auto encoded_size(block_format f, std::size_t w, std::size_t h)
+    -> std::size_t
+{
+    return (w + 3) / 4 * ((h + 3) / 4) * block_bytes(f);
+}
+
+// encode_blocks compresses src into rows of blocks at dst, row_bytes is the
+// distance between block rows (0 for tightly packed). Blocks that extend
+// past the edge of src repeat its last row and column.
+//
+// - bc1 switches a block to its 3-color mode with transparent texels when
+//   it holds alpha below 128
+// - the color endpoints are fitted along the principal axis of the block
+//   and refined once by least squares, index selection is vectorized
+//   (SSE4.1/AVX2, NEON) and selected at runtime
+// - block rows are encoded concurrently on exec (default_executor() when
+//   null)
+//
+// nargb8888 should be premultiplied when the page is sampled with linear
+// filtering, as for resample
+void encode_blocks(surface<nargb8888> const& src, block_format f, void* dst,
+    std::size_t row_bytes = 0, executor* exec = nullptr);
+
+} // namespace gtx::pixel
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <gtx/pixel/pixel.hpp>
+#include <gtx/surface.hpp>
+
+namespace gtx {
+class executor;
+}
+
+namespace gtx::pixel {
+
+enum class blur_filter {
+    gaussian,
+    box,
+};
+
+struct blur_options {
+    // gaussian: blur radius as in CSS (sigma = radius / 2), box: half the
+    // window width, rounded to whole pixels
+    float radius = 4.0f;
+    blur_filter filter = blur_filter::gaussian;
+    executor* exec = nullptr; // default_executor() when null
+};
+
+// blur applies a separable blur to the common top-left region of src and
+// dst, which may be the same surface. Small gaussians are convolved with
+// their taps, larger ones (sigma >= 2) are approximated by three box
+// passes, box passes are sliding windows so their cost does not depend on
+// the radius. Rows are filtered in strips and columns in bands run on the
+// executor, the passes are vectorized (SSE4.1/AVX2, NEON) and selected at
+// runtime.
+//
+// - available for nargb8888, xrgb8888, l8 and a8
+// - nargb8888 should be premultiplied (see alpha.hpp)
+// - pixels outside src are transparent (zero), so pad the source by the
+//   reach of the blur (1.5 * radius for gaussians) to keep it unclipped
+template <typename T>
+void blur(surface<T> const& src, surface<T>& dst,
+    blur_options const& opts = {});
+
+template <typename T>
+void blur(surface<T> const& src, surface<T>&& dst,
+    blur_options const& opts = {})
+{
+    blur(src, dst, opts);
+}
+
+} // namespace gtx::pixel
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <gtx/pixel/pixel.hpp>
+#include <gtx/surface.hpp>
+
+#include <span>
+
+namespace gtx {
+class executor;
+}
+
+namespace gtx::pixel {
+
+// linear16 holds linear light color with 16 bits per channel, in the
+// channel order of nargb8888, alpha is v * 257 of the 8-bit alpha
+struct linear16 {
+    uint16_t b;
+    uint16_t g;
+    uint16_t r;
+    uint16_t a;
+};
+
+// srgb_to_linear and linear_to_srgb convert the color channels of the
+// common top-left region of src and dst (which may be the same surface for
+// the 8-bit variants) through lookup tables, alpha is copied. 8-bit linear
+// light keeps only 3 levels for the darkest 10% of sRGB, convert to
+// linear16 when the result is blended or filtered. linear16 is encoded
+// through a 4096 entry table (v >> 4), within one level of the exact curve.
+// The rows are split into strips run on the executor (default_executor()
+// when null), the table lookups are vectorized with AVX2 gathers and
+// AArch64 NEON table lookups and selected at runtime.
+void srgb_to_linear(surface<nargb8888> const& src, surface<nargb8888>& dst,
+    executor* exec = nullptr);
+void linear_to_srgb(surface<nargb8888> const& src, surface<nargb8888>& dst,
+    executor* exec = nullptr);
+void srgb_to_linear(surface<nargb8888> const& src, surface<linear16>& dst,
+    executor* exec = nullptr);
+void linear_to_srgb(surface<linear16> const& src, surface<nargb8888>& dst,
+    executor* exec = nullptr);
+
+template <typename Src, typename Dst>
+void srgb_to_linear(surface<Src> const& src, surface<Dst>&& dst,
+    executor* exec = nullptr)
+{
+    srgb_to_linear(src, dst, exec);
+}
+
+template <typename Src, typename Dst>
+void linear_to_srgb(surface<Src> const& src, surface<Dst>&& dst,
+    executor* exec = nullptr)
+{
+    linear_to_srgb(src, dst, exec);
+}
+
+struct colormap_options {
+    float lo = 0.0f; // value mapped to the first entry
+    float hi = 1.0f; // value mapped to the last entry
+    executor* exec = nullptr; // default_executor() when null
+};
+
+// colormap maps a scalar field through a color map (typically 256 or 4096
+// entries) into dst, the common top-left region of src and dst is mapped:
+//
+//   dst = map[round(clamp((v - lo) / (hi - lo), 0, 1) * (map.size() - 1))]
+//
+// NaN maps to the first entry, uint16_t fields use lo and hi in their own
+// units. The rows are split into strips run on the executor, the index
+// computation is vectorized (SSE4.1/AVX2, NEON) and the lookups use AVX2
+// gathers where available.
+void colormap(surface<float> const& src, std::span<nargb8888 const> map,
+    surface<nargb8888>& dst, colormap_options const& opts = {});
+void colormap(surface<uint16_t> const& src, std::span<nargb8888 const> map,
+    surface<nargb8888>& dst, colormap_options const& opts = {});
+
+template <typename T>
+void colormap(surface<T> const& src, std::span<nargb8888 const> map,
+    surface<nargb8888>&& dst, colormap_options const& opts = {})
+{
+    colormap(src, map, dst, opts);
+}
+
+} // namespace gtx::pixel
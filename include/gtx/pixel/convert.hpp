@@ -0,0 +1,29 @@
+#pragma once
+
+#include <gtx/pixel/pixel.hpp>
+#include <gtx/surface.hpp>
+
+namespace gtx::pixel {
+
+// convert copies src into dst converting the pixel format, the common
+// top-left region of both surfaces is converted row by row so strides and
+// subsurfaces are handled. Channel conventions:
+//
+// - converting to a8 from an opaque format (xrgb8888, rgb565, l8) gives 255
+// - a8 converts to nargb8888 as white with alpha, and to opaque formats as
+//   grey (coverage), l8 converts to grey
+// - luminance is (77 r + 150 g + 29 b) >> 8
+// - converting nargb8888 to an opaque format drops alpha
+//
+// the kernels are vectorized (SSE4.1/AVX2, NEON) and selected at runtime,
+// all pairs of nargb8888, xrgb8888, rgb565, l8 and a8 are available
+template <typename Src, typename Dst>
+void convert(surface<Src> const& src, surface<Dst>& dst);
+
+template <typename Src, typename Dst>
+void convert(surface<Src> const& src, surface<Dst>&& dst)
+{
+    convert(src, dst);
+}
+
+} // namespace gtx::pixel
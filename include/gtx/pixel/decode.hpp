@@ -0,0 +1,48 @@
+#pragma once
+
+#include <gtx/pixel/pixel.hpp>
+#include <gtx/surface.hpp>
+
+#include <cstddef>
+#include <span>
+
+namespace gtx::pixel {
+
+enum class image_format {
+    unknown,
+    qoi,
+    pnm, // binary PGM (P5) and PPM (P6)
+    tga, // uncompressed and RLE true color and grey
+};
+
+struct image_info {
+    image_format format = image_format::unknown;
+    pixel::size size = {};
+    bool alpha = false; // the image has an alpha channel
+};
+
+// probe reads the header of an encoded image, TGA has no signature so it is
+// tried last and only plausible headers are accepted
+auto probe(std::span<std::byte const> data) -> image_info;
+
+// decode decodes an image straight into dst: rows are decoded one at a
+// time and each pixel is converted to T as it is decoded, there is no
+// intermediate image. The common top-left region of the image and dst is
+// written, so dst can be an atlas tile subsurface or a mapped staging
+// region (size it with probe).
+//
+// - available for nargb8888, xrgb8888, rgb565, l8 and a8 with the channel
+//   conventions of convert (see convert.hpp), nargb8888 is not premultiplied
+// - images without alpha decode with alpha 255
+// - returns false for unknown, unsupported (e.g. color mapped TGA) and
+//   truncated images, rows decoded before the error are left in dst
+template <typename T>
+auto decode(std::span<std::byte const> data, surface<T>& dst) -> bool;
+
+template <typename T>
+auto decode(std::span<std::byte const> data, surface<T>&& dst) -> bool
+{
+    return decode(data, dst);
+}
+
+} // namespace gtx::pixel
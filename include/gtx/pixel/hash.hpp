@@ -0,0 +1,25 @@
+#pragma once
+
+#include <gtx/surface.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gtx::pixel {
+
+// content_hash is a 64-bit hash of rows of row_bytes bytes, stride_bytes
+// apart, built like XXH3's long input loop (64-byte stripes into eight
+// 64-bit lanes, multiply-accumulated against a secret and scrambled every
+// 16 stripes). Only the bytes within the rows and their shape are hashed,
+// so a subsurface hashes like a tightly packed copy of it; the value is
+// the same with every instruction set but is not XXH3 compatible.
+auto content_hash(void const* data, std::size_t row_bytes, std::size_t rows,
+    std::size_t stride_bytes) -> uint64_t;
+
+template <typename T> auto content_hash(surface<T> const& s) -> uint64_t
+{
+    return content_hash(s.data(), s.width() * sizeof(T), s.height(),
+        s.stride() * sizeof(T));
+}
+
+} // namespace gtx::pixel
@@ -16,6 +16,13 @@ struct coord {
     unsigned y;
 };
 
+struct box {
+    unsigned x;
+    unsigned y;
+    unsigned w;
+    unsigned h;
+};
+
 struct nargb8888 {
     // assuming non-premultiplied values
     using value_type = uint32_t;
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <gtx/geom/vec.hpp>
+#include <gtx/geom/xform.hpp>
+#include <gtx/pixel/pixel.hpp>
+#include <gtx/surface.hpp>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace gtx {
+class scratch_arena;
+}
+
+namespace gtx::pixel {
+
+enum class fill_rule {
+    nonzero,
+    even_odd,
+};
+
+// path is a list of contours made of lines and quadratic or cubic Bézier
+// curves, open contours are closed when filled. Clear and refill a path to
+// reuse its storage.
+class path {
+public:
+    enum class verb : uint8_t {
+        move, // 1 point
+        line, // 1 point
+        quad, // control, end
+        cubic // control 1, control 2, end
+    };
+
+    void move_to(vec2<float> const& p)
+    {
+        verbs_.push_back(verb::move);
+        points_.push_back(p);
+        start_ = p;
+    }
+
+    // drawing without a current contour starts one at p
+    void line_to(vec2<float> const& p)
+    {
+        if (verbs_.empty())
+            return move_to(p);
+        verbs_.push_back(verb::line);
+        points_.push_back(p);
+    }
+
+    void quad_to(vec2<float> const& c, vec2<float> const& p)
+    {
+        if (verbs_.empty())
+            move_to(c);
+        verbs_.push_back(verb::quad);
+        points_.insert(points_.end(), {c, p});
+    }
+
+    void cubic_to(
+        vec2<float> const& c1, vec2<float> const& c2, vec2<float> const& p)
+    {
+        if (verbs_.empty())
+            move_to(c1);
+        verbs_.push_back(verb::cubic);
+        points_.insert(points_.end(), {c1, c2, p});
+    }
+
+    // close ends the contour with a line back to its first point
+    void close()
+    {
+        if (!verbs_.empty())
+            line_to(start_);
+    }
+
+    void clear()
+    {
+        verbs_.clear();
+        points_.clear();
+    }
+
+    void reserve(std::size_t verbs, std::size_t points)
+    {
+        verbs_.reserve(verbs);
+        points_.reserve(points);
+    }
+
+    auto empty() const { return verbs_.empty(); }
+    auto verbs() const { return std::span<verb const>{verbs_}; }
+    auto points() const { return std::span<vec2<float> const>{points_}; }
+
+private:
+    std::vector<verb> verbs_;
+    std::vector<vec2<float>> points_;
+    vec2<float> start_;
+};
+
+struct fill_options {
+    fill_rule rule = fill_rule::nonzero;
+    xform m;                        // maps the path to dst pixels
+    float tolerance = 0.025f;       // curve flattening error, in pixels
+    scratch_arena* arena = nullptr; // a thread local arena when null
+};
+
+// fill writes the antialiased coverage of p into dst (all of dst is
+// written, 0 outside the path), (0, 0) is the top-left corner of dst so
+// that glyphs and icons can be rasterized straight into an atlas tile
+// subsurface.
+//
+// Curves are flattened into lines whose signed areas are accumulated into
+// a float cell per pixel, a row prefix sum then resolves the cells into
+// coverage (vectorized for SSE4.1/AVX2, NEON and selected at runtime).
+// Coverage is exact except in pixels where edges cross each other, there
+// the area weighted winding is used. The cells come from the arena and are
+// released on return, there is no heap allocation per path once the arena
+// is warm. Pass the task's arena when rasterizing from executor tasks, e.g.
+// one tile per task with parallel_for_tiles.
+void fill(path const& p, surface<a8>& dst, fill_options const& opts = {});
+
+inline void fill(
+    path const& p, surface<a8>&& dst, fill_options const& opts = {})
+{
+    fill(p, dst, opts);
+}
+
+} // namespace gtx::pixel
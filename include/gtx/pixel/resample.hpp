@@ -0,0 +1,60 @@
+#pragma once
+
+#include <gtx/pixel/pixel.hpp>
+#include <gtx/surface.hpp>
+
+namespace gtx {
+class executor;
+}
+
+namespace gtx::pixel {
+
+enum class filter {
+    box,      // area average, nearest neighbour when upscaling
+    bilinear, // triangle, widened when downscaling
+    lanczos3,
+};
+
+struct resample_options {
+    pixel::filter filter = filter::bilinear;
+    bool srgb = false;        // filter color channels in linear light
+    executor* exec = nullptr; // default_executor() when null
+};
+
+// resample scales all of src into all of dst with a separable filter. The
+// work is split into row strips run on the executor and the filter loops
+// are vectorized (SSE4.1/AVX2, NEON) and selected at runtime.
+//
+// - available for nargb8888, xrgb8888, l8 and a8
+// - nargb8888 should be premultiplied (see alpha.hpp), otherwise the color
+//   of transparent texels bleeds into their neighbours
+// - in srgb mode, color channels are decoded to linear light through a
+//   lookup table before filtering and encoded back afterwards, alpha and a8
+//   are always linear
+template <typename T>
+void resample(surface<T> const& src, surface<T>& dst,
+    resample_options const& opts = {});
+
+template <typename T>
+void resample(surface<T> const& src, surface<T>&& dst,
+    resample_options const& opts = {})
+{
+    resample(src, dst, opts);
+}
+
+// halve is the fast path for power-of-two reductions: each dst pixel is
+// the rounded average of a 2x2 block of src, dst covers at most
+// (src.width() / 2) x (src.height() / 2), an odd last row or column of src
+// is ignored. Chain calls for larger powers of two.
+template <typename T>
+void halve(surface<T> const& src, surface<T>& dst, bool srgb = false,
+    executor* exec = nullptr);
+
+template <typename T>
+void halve(surface<T> const& src, surface<T>&& dst, bool srgb = false,
+    executor* exec = nullptr)
+{
+    halve(src, dst, srgb, exec);
+}
+
+} // namespace gtx::pixel
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <gtx/pixel/pixel.hpp>
+#include <gtx/surface.hpp>
+
+namespace gtx {
+class executor;
+}
+
+namespace gtx::pixel {
+
+struct sdf_options {
+    float radius = 8.0f;      // distance in pixels that maps to 0 and 255
+    executor* exec = nullptr; // default_executor() when null
+};
+
+// sdf converts coverage into a signed distance field, the common top-left
+// region of src and dst is converted:
+//
+//   dst = 255 * clamp(0.5 + d / (2 * radius), 0, 1)
+//
+// with d the distance in pixels to the edge, positive inside, so the edge
+// maps to 0.5. Partially covered pixels place the edge from their coverage
+// (at 0.5 - coverage pixels), the distances are exact Euclidean distances
+// from two separable transforms (Felzenszwalb-Huttenlocher) run on the
+// executor a line per task, the final encoding is vectorized (SSE4.1/AVX2,
+// NEON) and selected at runtime. Pixels outside src are not part of the
+// shape, pad the coverage by radius to keep the field from being clipped.
+void sdf(surface<a8> const& src, surface<a8>& dst,
+    sdf_options const& opts = {});
+
+inline void sdf(
+    surface<a8> const& src, surface<a8>&& dst, sdf_options const& opts = {})
+{
+    sdf(src, dst, opts);
+}
+
+} // namespace gtx::pixel
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <gtx/pixel/pixel.hpp>
+#include <gtx/surface.hpp>
+
+namespace gtx::pixel {
+
+// trim_bounds returns the smallest box holding every pixel with non-zero
+// alpha (or coverage for a8), an empty box when all pixels are transparent.
+// Rows in between the first and last visible ones are only scanned from
+// each side up to the columns found so far.
+auto trim_bounds(surface<nargb8888> const& s) -> box;
+auto trim_bounds(surface<a8> const& s) -> box;
+
+} // namespace gtx::pixel
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <gtx/pixel/pixel.hpp>
+#include <gtx/surface.hpp>
+
+namespace gtx {
+class executor;
+}
+
+namespace gtx::pixel {
+
+// uv88 is an interleaved chroma sample of NV12 frames
+struct uv88 {
+    uint8_t u;
+    uint8_t v;
+};
+
+enum class yuv_matrix {
+    bt601,
+    bt709,
+};
+
+// limited (video) range keeps luma within 16..235 and chroma within
+// 16..240, full range uses all 256 values
+enum class yuv_range {
+    limited,
+    full,
+};
+
+struct yuv_options {
+    yuv_matrix matrix = yuv_matrix::bt709;
+    yuv_range range = yuv_range::limited;
+    executor* exec = nullptr; // default_executor() when null
+};
+
+// yuv_to_nargb converts a 4:2:0 frame to opaque nargb8888 pixels with the
+// coefficients the video_batch shader uses, for the paths that draw
+// without it. I420 frames have separate u and v planes, NV12 frames one
+// plane of uv pairs, the chroma planes have half the luma size rounded up
+// and each chroma sample covers 2x2 pixels. The common top-left region of
+// y and dst is converted (within what the chroma planes cover), the rows
+// are split into strips run on the executor, the 16.16 fixed point
+// conversion is vectorized (SSE4.1/AVX2, NEON) and selected at runtime.
+void yuv_to_nargb(surface<uint8_t> const& y, surface<uint8_t> const& u,
+    surface<uint8_t> const& v, surface<nargb8888>& dst,
+    yuv_options const& opts = {});
+void yuv_to_nargb(surface<uint8_t> const& y, surface<uv88> const& uv,
+    surface<nargb8888>& dst, yuv_options const& opts = {});
+
+inline void yuv_to_nargb(surface<uint8_t> const& y, surface<uint8_t> const& u,
+    surface<uint8_t> const& v, surface<nargb8888>&& dst,
+    yuv_options const& opts = {})
+{
+    yuv_to_nargb(y, u, v, dst, opts);
+}
+
+inline void yuv_to_nargb(surface<uint8_t> const& y, surface<uv88> const& uv,
+    surface<nargb8888>&& dst, yuv_options const& opts = {})
+{
+    yuv_to_nargb(y, uv, dst, opts);
+}
+
+} // namespace gtx::pixel
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <gtx/shader/sprite-batch.hpp>
+#include <gtx/tx-glyphs.hpp>
+
+namespace gtx::shdr {
+
+// glyph_run draws shaped text: glyph ids with pen positions are resolved
+// through the glyph cache into sprite_batch instances, so each atlas page
+// in the text costs one instanced draw call
+struct glyph_run : sprite_batch {
+    glyph_run(texture::glyph_cache& cache)
+        : cache_{cache}
+    {
+    }
+
+    // add appends one run, glyphs[i] is drawn at pen position positions[i]
+    // with its bitmap scaled by scale (distance field glyphs stay sharp)
+    void add(std::span<uint32_t const> glyphs,
+        std::span<vec2<float> const> positions,
+        vec4<float> const& clr = {1.0f, 1.0f, 1.0f, 1.0f}, float scale = 1);
+
+private:
+    texture::glyph_cache& cache_;
+};
+
+} // namespace gtx::shdr
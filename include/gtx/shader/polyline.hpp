@@ -20,9 +20,10 @@ namespace gtx::shdr {
 struct polyline {
     struct vertex {
         vec2<float> pos;
-        float thk;
+        float thk = 0.0f;
         float dummy = 0.0f;
         vec4<float> clr;
+        vertex() = default; // for vlist::write::emplace
         vertex(vec2<float> const& pos, float thk, vec4<float> const& clr)
             : pos{pos}
             , thk{thk}
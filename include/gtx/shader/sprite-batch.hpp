@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstdint>
+#include <gtx/geom/mat.hpp>
+#include <gtx/geom/vec.hpp>
+#include <gtx/geom/xform.hpp>
+#include <gtx/tx-page.hpp>
+#include <memory>
+#include <span>
+#include <vector>
+
+#if defined(GTX_DIRECTX)
+#include <gtx/dx/dx.hpp>
+#elif defined(GTX_OPENGL)
+#include <gtx/gl/gl.hpp>
+#elif defined(GTX_VULKAN)
+#include <gtx/vk/vk.hpp>
+#else
+#error Undefined GTX implementation
+#endif
+
+namespace gtx::shdr {
+
+// sprite_batch draws textured quads from texture pages, submissions are
+// bucketed by page and streamed as instance data, each run of instances
+// that shares a page is drawn with a single instanced draw call (with
+// Vulkan bindless pages the whole batch is a single draw in submission order)
+struct sprite_batch {
+    // sampling selects how the page texels are read: color multiplies the
+    // texel by the instance color, sdf treats the alpha as a signed distance
+    // field (see pixel::sdf) and draws its antialiased inside in the color
+    enum class sampling : uint32_t {
+        color,
+        sdf,
+    };
+
+    struct instance {
+        vec2<float> pos; // maps to the top-left corner of the sprite box
+        vec2<float> ax;  // quad edge along the sprite's x axis
+        vec2<float> ay;  // quad edge along the sprite's y axis
+        texture::uv_rect uv;
+        vec4<float> clr;
+        uint32_t page; // bindless page index
+        sampling mode = sampling::color;
+    };
+
+    // run is a range of instances within the stream that share a page
+    struct run {
+        void* native_handle;
+        uint32_t first;
+        uint32_t count;
+    };
+
+    // order controls how submissions are bucketed: by_page groups all
+    // instances of a page into one run (painter's order is preserved only
+    // within a page), submission only merges consecutive same-page instances
+    enum class order {
+        by_page,
+        submission,
+    };
+
+    sprite_batch();
+    sprite_batch(sprite_batch const&) = delete;
+
+    void clear();
+    void reserve(std::size_t n);
+
+    void add(texture::sprite const& s, rect<float> const& dst,
+        vec4<float> const& clr = {1.0f, 1.0f, 1.0f, 1.0f},
+        sampling mode = sampling::color);
+
+    // add maps the sprite frame (0, 0, w, h) in texels through m
+    void add(texture::sprite const& s, xform const& m,
+        vec4<float> const& clr = {1.0f, 1.0f, 1.0f, 1.0f},
+        sampling mode = sampling::color);
+
+    auto size() const { return instances_.size(); }
+    auto empty() const { return instances_.empty(); }
+
+    void setup_mvp(mat4x4 const& m);
+    void render(order o = order::by_page);
+
+    // prepare buckets the submissions and returns the instance stream,
+    // it is called by render and exposed for custom renderers
+    auto prepare(order o) -> std::span<instance const>;
+    auto runs() const { return std::span<run const>{runs_}; }
+
+protected:
+    void push(texture::sprite const& s, vec2<float> const& pos,
+        vec2<float> const& ax, vec2<float> const& ay, vec4<float> const& clr,
+        sampling mode);
+
+    std::vector<instance> instances_;
+    std::vector<void*> handles_; // native page handle per instance
+    std::vector<instance> sorted_;
+    std::vector<run> runs_;
+
+#if defined(GTX_DIRECTX)
+    dx::vertex_shader vertex_shader;
+    dx::pixel_shader pixel_shader;
+    dx::input_layout layout;
+    dx::vertex_buffer<instance> ibuffer;
+    dx::constant_buffer<float[4][4]> mvp;
+    dx::sampler_state sampler;
+
+#elif defined(GTX_OPENGL)
+    gl::shader vertex_shader;
+    gl::shader fragment_shader;
+    gl::program program;
+    gl::uniform mvp;
+    gl::uniform tex;
+    gl::buffer<GL_ARRAY_BUFFER> instance_buffer;
+    gl::vertex_array vertex_array;
+
+#elif defined(GTX_VULKAN)
+public:
+    ~sprite_batch();
+
+protected:
+    // stream_segment is the instance buffer of one frame in flight, buffers
+    // outgrown during a frame are retired until the segment is reused
+    struct stream_segment {
+        uint64_t frame = 0;
+        std::unique_ptr<vk::buffer> buffer;
+        VkDeviceSize capacity = 0;
+        VkDeviceSize used = 0;
+        std::vector<std::unique_ptr<vk::buffer>> retired;
+    };
+    static constexpr std::size_t frames_in_flight = 3;
+    stream_segment segments_[frames_in_flight];
+    std::size_t segment_ = 0;
+    mat4x4 mvp_;
+    bool bindless_ = false;
+
+    VkPipelineLayout pipeline_layout_ = nullptr;
+    VkPipeline pipeline_ = nullptr;
+#endif
+};
+
+} // namespace gtx::shdr
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <gtx/geom/mat.hpp>
+#include <gtx/geom/vec.hpp>
+#include <gtx/geom/xform.hpp>
+#include <gtx/tx-video.hpp>
+#include <memory>
+#include <span>
+#include <vector>
+
+#if defined(GTX_DIRECTX)
+#include <gtx/dx/dx.hpp>
+#elif defined(GTX_OPENGL)
+#include <gtx/gl/gl.hpp>
+#elif defined(GTX_VULKAN)
+#include <gtx/vk/vk.hpp>
+#else
+#error Undefined GTX implementation
+#endif
+
+namespace gtx::shdr {
+
+// video_batch draws video pages: the fragment stage samples the y, u and v
+// planes and converts them to rgb with the page's matrix and range, the
+// same conversion as pixel::yuv_to_nargb. Consecutive quads of the same
+// page share an instanced draw call (with Vulkan bindless pages the whole
+// batch is a single draw), blending is as in sprite_batch.
+struct video_batch {
+    // mode bits of an instance
+    static constexpr uint32_t nv12 = 1;       // v is the g of the u plane
+    static constexpr uint32_t bt709 = 2;      // bt601 otherwise
+    static constexpr uint32_t full_range = 4; // limited range otherwise
+
+    struct instance {
+        vec2<float> pos; // maps to the top-left corner of the frame
+        vec2<float> ax;  // quad edge along the frame's x axis
+        vec2<float> ay;  // quad edge along the frame's y axis
+        texture::uv_rect uv;
+        vec4<float> clr;
+        uint32_t planes[3]; // bindless page indices of y, u and v
+        uint32_t mode;
+    };
+
+    // run is a range of instances within the stream that share a video
+    // page, planes are the native handles of its y, u and v pages
+    struct run {
+        void* planes[3];
+        uint32_t first;
+        uint32_t count;
+    };
+
+    video_batch();
+    video_batch(video_batch const&) = delete;
+
+    void clear();
+    void reserve(std::size_t n);
+
+    // add draws the frame into dst, or its box (in frame texels)
+    void add(texture::video_page const& v, rect<float> const& dst,
+        vec4<float> const& clr = {1.0f, 1.0f, 1.0f, 1.0f});
+    void add(texture::video_page const& v, texture::texel_box const& box,
+        rect<float> const& dst,
+        vec4<float> const& clr = {1.0f, 1.0f, 1.0f, 1.0f});
+
+    // add maps the frame (0, 0, w, h) in texels through m
+    void add(texture::video_page const& v, xform const& m,
+        vec4<float> const& clr = {1.0f, 1.0f, 1.0f, 1.0f});
+
+    auto size() const { return instances_.size(); }
+    auto empty() const { return instances_.empty(); }
+
+    void setup_mvp(mat4x4 const& m);
+    void render();
+
+    // prepare returns the instance stream (runs follow submission order),
+    // it is called by render and exposed for custom renderers
+    auto prepare() -> std::span<instance const>;
+    auto runs() const { return std::span<run const>{runs_}; }
+
+protected:
+    void push(texture::video_page const& v, texture::uv_rect const& uv,
+        vec2<float> const& pos, vec2<float> const& ax, vec2<float> const& ay,
+        vec4<float> const& clr);
+
+    std::vector<instance> instances_;
+    std::vector<run> runs_;
+
+#if defined(GTX_DIRECTX)
+    dx::vertex_shader vertex_shader;
+    dx::pixel_shader pixel_shader;
+    dx::input_layout layout;
+    dx::vertex_buffer<instance> ibuffer;
+    dx::constant_buffer<float[4][4]> mvp;
+    dx::sampler_state sampler;
+
+#elif defined(GTX_OPENGL)
+    gl::shader vertex_shader;
+    gl::shader fragment_shader;
+    gl::program program;
+    gl::uniform mvp;
+    gl::uniform tex_y;
+    gl::uniform tex_u;
+    gl::uniform tex_v;
+    gl::buffer<GL_ARRAY_BUFFER> instance_buffer;
+    gl::vertex_array vertex_array;
+
+#elif defined(GTX_VULKAN)
+public:
+    ~video_batch();
+
+protected:
+    // stream_segment is the instance buffer of one frame in flight, see
+    // sprite_batch
+    struct stream_segment {
+        uint64_t frame = 0;
+        std::unique_ptr<vk::buffer> buffer;
+        VkDeviceSize capacity = 0;
+        VkDeviceSize used = 0;
+        std::vector<std::unique_ptr<vk::buffer>> retired;
+    };
+    static constexpr std::size_t frames_in_flight = 3;
+    stream_segment segments_[frames_in_flight];
+    std::size_t segment_ = 0;
+    mat4x4 mvp_;
+    bool bindless_ = false;
+
+    VkPipelineLayout pipeline_layout_ = nullptr;
+    VkPipeline pipeline_ = nullptr;
+#endif
+};
+
+} // namespace gtx::shdr
@@ -1,11 +1,15 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #include <algorithm>
 #include <numeric>
 #include <optional>
+#include <span>
+#include <unordered_map>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -39,6 +43,9 @@ template <typename PageBase, typename Payload> struct atlas {
     using rowiter = typename rowvector::iterator;
     using pageiter = typename pagevector::iterator;
 
+    // a trimmed tile stores only part of its source image, ox and oy are
+    // the position of the stored texels within the source of size src_w by
+    // src_h (for untrimmed tiles 0, 0 and the tile size)
     struct tile {
         coord_t x;
         coord_t y;
@@ -46,6 +53,10 @@ template <typename PageBase, typename Payload> struct atlas {
         coord_t h;
         payload_t payload;
         pageref_t pageref;
+        offset_t ox;
+        offset_t oy;
+        coord_t src_w;
+        coord_t src_h;
     };
 
     struct cell {
@@ -70,14 +81,44 @@ template <typename PageBase, typename Payload> struct atlas {
         }
     };
 
+    // shared is an index of the images inserted with insert_shared by
+    // content hash, tile is the first tile holding the image, refs the
+    // number of tiles referring to its rect and source a copy of the image
+    // that a hash hit is compared with
+    struct shared_entry {
+        tileref_t tile;
+        coord_t w;
+        coord_t h;
+        uint32_t refs;
+        std::vector<std::byte> source;
+    };
+
+    struct shared_insert {
+        tileref_t ref;
+        bool upload; // the rect is new, its texels must be uploaded
+    };
+
     coord_t page_w;
     coord_t page_h;
+    coord_t align; // tile positions are multiples of align
+    uint32_t levels; // mip levels of the pages
     tilevector tiles;
     pagevector pages;
-
-    atlas(coord_t page_w, coord_t page_h)
+    std::unordered_map<uint64_t, shared_entry> shared;
+
+    // with align, the space reserved for a tile is rounded up to multiples
+    // of align, so that every tile starts on a multiple of it, 4 keeps the
+    // tiles of block compressed pages on whole blocks. Pages get levels mip
+    // levels, align is then at least 2^(levels - 1) so that the space of a
+    // tile pads it to whole texels of the coarsest level and the mips of
+    // neighbouring tiles do not mix.
+    atlas(coord_t page_w, coord_t page_h, coord_t align = 1,
+        uint32_t levels = 1)
         : page_w{page_w}
         , page_h{page_h}
+        , align{std::max(
+              {align, coord_t(1u << (std::clamp(levels, 1u, 16u) - 1))})}
+        , levels{std::max(levels, 1u)}
     {
         assert(page_w >= 8 && page_h >= 8);
     }
@@ -86,6 +127,8 @@ template <typename PageBase, typename Payload> struct atlas {
     {
         pages.clear();
         tiles.clear();
+        shared.clear();
+        last_.kind = last_insert::none;
     }
 
     auto insert_tile(coord_t tile_w, coord_t tile_h, payload_t&& payload)
@@ -93,6 +136,12 @@ template <typename PageBase, typename Payload> struct atlas {
     {
         tile_w = std::clamp(tile_w, coord_t{1}, page_w);
         tile_h = std::clamp(tile_h, coord_t{1}, page_h);
+        auto const size_w = tile_w;
+        auto const size_h = tile_h;
+        tile_w =
+            std::min(coord_t((tile_w + align - 1) / align * align), page_w);
+        tile_h =
+            std::min(coord_t((tile_h + align - 1) / align * align), page_h);
 
         auto best_page = pages.end();
         auto best_row = rowiter{};
@@ -129,6 +178,9 @@ template <typename PageBase, typename Payload> struct atlas {
                 }
         }
 
+        if (best_page != pages.end())
+            remember(best_page, best_row);
+
         if (best_page == pages.end()) {
             // find best matching end-of-row insertion point
             for (pit = pages.begin(); pit != pages.end(); ++pit)
@@ -151,6 +203,7 @@ template <typename PageBase, typename Payload> struct atlas {
                 }
 
             if (best_page != pages.end()) {
+                remember(best_page, best_row);
                 auto x = best_row->cells.back().x + best_row->cells.back().w;
                 best_cell = best_row->cells.emplace(best_row->cells.end());
                 best_cell->x = x;
@@ -173,6 +226,8 @@ template <typename PageBase, typename Payload> struct atlas {
                 auto y = last_row.y + last_row.h;
                 if (tile_h > page_h - y)
                     continue;
+                last_ = {last_insert::new_row, std::size_t(pit - pages.begin()),
+                    pit->rows.size() - 1, 0, last_row.sealed};
                 last_row.sealed = true;
                 best_page = pit;
                 break;
@@ -191,6 +246,9 @@ template <typename PageBase, typename Payload> struct atlas {
         }
 
         if (best_page == pages.end()) {
+            last_ = {last_insert::new_page, pages.size() - 1,
+                pages.empty() ? std::size_t(-1) : pages.size() - 1, 0,
+                !pages.empty() && pages.back().rows.back().sealed};
             if (!pages.empty())
                 pages.back().rows.back().sealed = true;
             best_page = new_page();
@@ -206,10 +264,14 @@ template <typename PageBase, typename Payload> struct atlas {
         auto& tile = tiles.emplace_back();
         tile.x = best_cell->x;
         tile.y = best_row->y + best_y;
-        tile.w = tile_w;
-        tile.h = tile_h;
+        tile.w = size_w;
+        tile.h = size_h;
         tile.payload = std::forward<payload_t>(payload);
         tile.pageref = static_cast<pageref_t>(best_page - pages.begin());
+        tile.ox = 0;
+        tile.oy = 0;
+        tile.src_w = size_w;
+        tile.src_h = size_h;
 
         auto y = best_y + tile_h;
         if (tile_w < best_cell->w) {
@@ -242,10 +304,124 @@ template <typename PageBase, typename Payload> struct atlas {
         return static_cast<tileref_t>(tiles.size());
     }
 
+    // insert_trimmed reserves space for the box x, y, w, h of a src_w by
+    // src_h image only (see pixel::trim_bounds) and records where it sits
+    // in the source, an empty box still takes a 1x1 tile
+    auto insert_trimmed(coord_t src_w, coord_t src_h, coord_t x, coord_t y,
+        coord_t w, coord_t h, payload_t&& payload) -> tileref_t
+    {
+        assert(x + w <= src_w && y + h <= src_h);
+        auto const ref = insert_tile(w, h, std::forward<payload_t>(payload));
+        auto& tile = tiles.back();
+        tile.ox = offset_t(x);
+        tile.oy = offset_t(y);
+        tile.src_w = src_w;
+        tile.src_h = src_h;
+        return ref;
+    }
+
+    // insert_shared inserts a tile for the image source with the given
+    // content hash (see pixel::content_hash), if the same image was inserted
+    // before the new tile refers to its rect and takes no space. A hash hit
+    // is compared with the image before sharing, images of another size or
+    // other pixels under a known hash are stored unshared.
+    auto insert_shared(coord_t tile_w, coord_t tile_h, uint64_t hash,
+        std::span<std::byte const> source, payload_t&& payload)
+        -> shared_insert
+    {
+        auto it = shared.find(hash);
+        if (it != shared.end() && it->second.w == tile_w &&
+            it->second.h == tile_h &&
+            it->second.source.size() == source.size() &&
+            (source.empty() ||
+                !std::memcmp(
+                    it->second.source.data(), source.data(), source.size()))) {
+            auto t = tiles[it->second.tile];
+            t.payload = std::forward<payload_t>(payload);
+            tiles.push_back(std::move(t));
+            last_.kind = last_insert::none;
+            ++it->second.refs;
+            return {static_cast<tileref_t>(tiles.size()), false};
+        }
+        auto const ref =
+            insert_tile(tile_w, tile_h, std::forward<payload_t>(payload));
+        if (it == shared.end())
+            shared.emplace(hash,
+                shared_entry{static_cast<tileref_t>(tiles.size() - 1), tile_w,
+                    tile_h, 1, {source.begin(), source.end()}});
+        return {ref, true};
+    }
+
+    // release_shared drops a reference to the image with the given hash and
+    // returns the references left. The atlas does not free space, a rect
+    // without references is kept and reused by the next identical image.
+    auto release_shared(uint64_t hash) -> uint32_t
+    {
+        auto it = shared.find(hash);
+        if (it == shared.end() || !it->second.refs)
+            return 0;
+        return --it->second.refs;
+    }
+
+    // erase_last removes the tile added last by insert_tile (or by an
+    // insert_shared or insert_trimmed that inserted one) and gives its
+    // space back, e.g. when its upload failed. It returns false when the
+    // last tile was not inserted that way.
+    auto erase_last() -> bool
+    {
+        auto& u = last_;
+        switch (u.kind) {
+        case last_insert::none:
+            return false;
+        case last_insert::in_row: {
+            auto& r = pages[u.page].rows[u.row];
+            r.h = u.h;
+            r.sealed = u.sealed;
+            r.cells = u.cells;
+            break;
+        }
+        case last_insert::new_row:
+            pages[u.page].rows.pop_back();
+            pages[u.page].rows[u.row].sealed = u.sealed;
+            break;
+        case last_insert::new_page:
+            pages.pop_back();
+            if (u.row != std::size_t(-1))
+                pages[u.page].rows.back().sealed = u.sealed;
+            break;
+        }
+        tiles.pop_back();
+        u.kind = last_insert::none;
+        return true;
+    }
+
 private:
+    // last_insert is what insert_tile changed, for erase_last: the row it
+    // took space from as it was before, or the row or page it added and
+    // the sealed flag of the row that was last before
+    struct last_insert {
+        enum { none, in_row, new_row, new_page } kind = none;
+        std::size_t page = 0;
+        std::size_t row = 0;
+        coord_t h = 0;
+        bool sealed = false;
+        cellvector cells = {};
+    };
+    last_insert last_;
+
+    void remember(pageiter pit, rowiter rit)
+    {
+        last_.kind = last_insert::in_row;
+        last_.page = std::size_t(pit - pages.begin());
+        last_.row = std::size_t(rit - pit->rows.begin());
+        last_.h = rit->h;
+        last_.sealed = rit->sealed;
+        last_.cells = rit->cells;
+    }
+
     auto new_page() -> pageiter
     {
-        return pages.emplace(pages.end(), page_base_t{page_w, page_h});
+        return pages.emplace(pages.end(), page_base_t{page_w, page_h, levels});
     }
 };
 
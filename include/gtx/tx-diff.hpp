@@ -0,0 +1,52 @@
+#pragma once
+
+#include <gtx/image.hpp>
+#include <gtx/surface.hpp>
+#include <gtx/tx-page.hpp>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace gtx::texture {
+
+// frame_diff tracks a surface that is redrawn on the CPU every frame and
+// uploaded to a page, so that only what changed is uploaded. It keeps a
+// copy of the previous frame and compares the new one against it in
+// tile x tile blocks (SIMD compares, one pass over the rows), the dirty
+// tiles are merged into rectangles: runs of dirty tiles along a row, and
+// runs of equal width and position in consecutive rows.
+class frame_diff {
+public:
+    // tile is rounded up to a multiple of 4, so regions stay on whole
+    // blocks of bc pages
+    explicit frame_diff(uint32_t tile = 32);
+
+    // diff compares cur against the previous frame and keeps cur as the
+    // new previous frame. The first frame, or one of another size, is dirty
+    // as a whole.
+    auto diff(surface<uint32_t> const& cur) -> std::span<texel_box const>;
+
+    // update diffs cur and uploads the dirty regions to p, with cur placed
+    // at x, y within the page. Returns false if an upload failed, the
+    // previous frame is then forgotten so the next update is a full one.
+    auto update(page& p, surface<uint32_t> const& cur, uint32_t x = 0,
+        uint32_t y = 0, bool premultiply = false) -> bool;
+
+    // reset forgets the previous frame
+    void reset() { prev_.reset(); }
+
+    auto regions() const -> std::span<texel_box const> { return regions_; }
+
+    // dirty_pixels is the area of the last regions
+    auto dirty_pixels() const -> std::size_t;
+
+private:
+    uint32_t tile_;
+    image<uint32_t> prev_;
+    std::vector<uint8_t> dirty_; // per tile
+    std::vector<uint32_t> open_; // per tile column, region index + 1
+    std::vector<texel_box> regions_;
+};
+
+} // namespace gtx::texture
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "pixel/hash.hpp"
+#include "pixel/sdf.hpp"
+#include "tx-atlas.hpp"
+#include "tx-page.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace gtx::texture {
+
+// glyph_bitmap is filled in by the rasterizer, the pixels are in the page
+// format and are copied into the atlas before the rasterizer is called again
+struct glyph_bitmap {
+    uint32_t const* data = nullptr;
+    uint32_t w = 0;
+    uint32_t h = 0;
+    std::size_t stride = 0; // in pixels
+    float left = 0;         // pen position to the bitmap's top-left corner
+    float top = 0;          // (y axis pointing down)
+};
+
+struct glyph {
+    sprite spr;
+    float left = 0;
+    float top = 0;
+    bool empty = true; // no ink (e.g. space) or too large, nothing to draw
+    bool sdf = false;  // the alpha is a distance field, draw with sdf sampling
+};
+
+// glyph_cache keeps rasterized glyphs in an atlas of texture pages, glyphs
+// are rasterized on first use through the rasterizer callback, a hit is a
+// single hash lookup and does not allocate. With a non-zero sdf_radius the
+// coverage of each glyph is stored as a signed distance field extending
+// sdf_radius pixels past the bitmap, a single tile then serves every scale
+struct glyph_cache {
+    using glyph_id = uint32_t;
+    using rasterizer = std::function<bool(glyph_id id, glyph_bitmap& bitmap)>;
+
+    // padding is the transparent border kept around each glyph so that
+    // bilinear sampling does not bleed into the neighbours
+    static constexpr uint32_t padding = 1;
+
+    glyph_cache(texel_size const& page_size, rasterizer rasterize,
+        float sdf_radius = 0)
+        : atlas_{uint16_t(page_size.w), uint16_t(page_size.h)}
+        , rasterize_{std::move(rasterize)}
+        , sdf_radius_{std::max(sdf_radius, 0.0f)}
+    {
+    }
+
+    glyph_cache(glyph_cache const&) = delete;
+
+    void clear()
+    {
+        glyphs_.clear();
+        atlas_.clear();
+    }
+
+    void reserve(std::size_t n) { glyphs_.reserve(n); }
+
+    // find returns the cached glyph, or rasterizes it on a miss. Glyphs
+    // without an outline or too large for a page are cached as empty, a
+    // failed rasterize or upload returns an empty glyph without caching it
+    // so that the next find tries again (e.g. after a device change in the
+    // middle of an upload).
+    auto find(glyph_id id) -> glyph const*
+    {
+        if (auto it = glyphs_.find(id); it != glyphs_.end()) {
+            if (it->second.empty || it->second.spr.valid())
+                return &it->second;
+            // pages were released (e.g. device change), start over
+            clear();
+        }
+        auto g = rasterize(id);
+        if (!g)
+            return &failed_;
+        return &(glyphs_[id] = *g);
+    }
+
+private:
+    atlas<page, glyph_id> atlas_;
+    rasterizer rasterize_;
+    float sdf_radius_;
+    std::unordered_map<glyph_id, glyph> glyphs_;
+    std::vector<uint32_t> scratch_;
+    std::vector<pixel::a8> coverage_;
+    std::vector<pixel::a8> field_;
+    glyph const failed_;
+
+    // rasterize returns nothing when the glyph could not be made and an
+    // empty glyph when it has no outline or does not fit a page
+    auto rasterize(glyph_id id) -> std::optional<glyph>
+    {
+        auto bm = glyph_bitmap{};
+        if (!rasterize_ || !rasterize_(id, bm))
+            return std::nullopt;
+        if (!bm.data || !bm.w || !bm.h)
+            return glyph{};
+
+        // the distance field needs room to fall off outside the ink
+        auto const margin = uint32_t(std::ceil(sdf_radius_));
+        auto const gw = bm.w + 2 * margin;
+        auto const gh = bm.h + 2 * margin;
+        auto const pw = gw + 2 * padding;
+        auto const ph = gh + 2 * padding;
+        if (pw > atlas_.page_w || ph > atlas_.page_h)
+            return glyph{};
+
+        scratch_.assign(std::size_t(pw) * ph, 0);
+        if (sdf_radius_ > 0) {
+            coverage_.assign(std::size_t(gw) * gh, pixel::a8{});
+            field_.resize(coverage_.size());
+            for (uint32_t y = 0; y < bm.h; ++y)
+                for (uint32_t x = 0; x < bm.w; ++x)
+                    coverage_[(y + margin) * gw + x + margin] =
+                        uint8_t(bm.data[y * bm.stride + x] >> 24);
+            pixel::sdf({coverage_.data(), gw, gh},
+                surface<pixel::a8>{field_.data(), gw, gh},
+                pixel::sdf_options{sdf_radius_});
+            for (uint32_t y = 0; y < gh; ++y)
+                for (uint32_t x = 0; x < gw; ++x)
+                    scratch_[(y + padding) * pw + x + padding] =
+                        uint32_t(field_[y * gw + x].value) << 24 | 0xffffff;
+        }
+        else {
+            for (uint32_t y = 0; y < bm.h; ++y)
+                std::copy_n(bm.data + y * bm.stride, bm.w,
+                    scratch_.data() + (y + padding) * pw + padding);
+        }
+
+        // identical glyphs (e.g. the same shape under several ids) share
+        // their tile, only the first one is uploaded
+        auto const hash =
+            pixel::content_hash(scratch_.data(), pw * 4, ph, pw * 4);
+        auto const ins = atlas_.insert_shared(uint16_t(pw), uint16_t(ph), hash,
+            std::as_bytes(std::span{scratch_}), glyph_id{id});
+        auto const& t = atlas_.tiles.back();
+        auto& p = atlas_.pages[t.pageref].base;
+        if (ins.upload && !p.update({t.x, t.y, pw, ph}, scratch_.data(), pw)) {
+            // the next identical image must upload again
+            auto it = atlas_.shared.find(hash);
+            if (it != atlas_.shared.end() &&
+                it->second.tile == atlas_.tiles.size() - 1)
+                atlas_.shared.erase(it);
+            atlas_.erase_last();
+            return std::nullopt;
+        }
+
+        auto g = glyph{};
+        g.spr = sprite{p, {t.x + padding, t.y + padding, gw, gh}};
+        g.left = bm.left - float(margin);
+        g.top = bm.top - float(margin);
+        g.empty = false;
+        g.sdf = sdf_radius_ > 0;
+        return g;
+    }
+};
+
+} // namespace gtx::texture
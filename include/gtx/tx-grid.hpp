@@ -32,12 +32,18 @@ private:
     friend struct grid;
 };
 
+// grid pages get mip_levels levels, cells are updated one at a time and
+// the mips of the updated region are rebuilt from the page texels. Cell
+// sizes that are multiples of 2^(mip_levels - 1) keep the coarser levels
+// of neighbouring cells apart as well.
 struct grid {
-    grid(texel_size const& cell_size, uint32_t ncols, uint32_t nrows)
+    grid(texel_size const& cell_size, uint32_t ncols, uint32_t nrows,
+        uint32_t mip_levels = 1)
         : _cellsz{cell_size}
         , _ncols{ncols}
         , _nrows{nrows}
         , _pagesz{cell_size.w * ncols, cell_size.h * nrows}
+        , _levels{mip_levels}
     {
     }
 
@@ -50,6 +56,7 @@ private:
     texel_size _pagesz;
     uint32_t _ncols;
     uint32_t _nrows;
+    uint32_t _levels;
     std::vector<uint64_t> slots;
     std::vector<page> pages;
     friend struct cell;
@@ -107,7 +114,7 @@ inline auto cell::locate(std::function<void(sprite const&)> update)
     if (i >= _grid->pages.size()) {
         // a new page is required
         auto& pg = _grid->pages.emplace_back();
-        pg.setup(_grid->_pagesz);
+        pg.setup(_grid->_pagesz, false, format::rgba8, _grid->_levels);
     }
 
     auto ret = sprite{_grid->pages[i], texel_box{
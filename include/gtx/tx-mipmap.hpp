@@ -0,0 +1,122 @@
+#pragma once
+
+#include <gtx/image.hpp>
+#include <gtx/pixel/pixel.hpp>
+#include <gtx/tx-page.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+namespace gtx::texture {
+
+// mip_levels returns the length of the full mip chain for a page size
+constexpr auto mip_levels(texel_size const& sz) -> uint32_t
+{
+    return uint32_t(std::bit_width(std::max(sz.w, sz.h)));
+}
+
+// mip_levels clamps a requested level count to the chain, 0 gives all
+constexpr auto mip_levels(texel_size const& sz, uint32_t requested)
+    -> uint32_t
+{
+    auto const n = mip_levels(sz);
+    return requested ? std::clamp(requested, 1u, std::max(n, 1u)) : n;
+}
+
+constexpr auto mip_size(texel_size const& sz, uint32_t level) -> texel_size
+{
+    return {std::max(sz.w >> level, 1u), std::max(sz.h >> level, 1u)};
+}
+
+// mip_box returns the texels of a level that a level 0 box covers, rounded
+// outward
+constexpr auto mip_box(texel_box const& b, uint32_t level) -> texel_box
+{
+    auto const round = (1u << level) - 1;
+    auto const x = b.x >> level;
+    auto const y = b.y >> level;
+    return {x, y, ((b.x + b.w + round) >> level) - x,
+        ((b.y + b.h + round) >> level) - y};
+}
+
+// mip_region grows a level 0 box to multiples of 2^(levels - 1), clipped
+// to a page of size sz: every texel of the coarser levels that the box
+// touches is then built from the region alone
+constexpr auto mip_region(
+    texel_box const& b, texel_size const& sz, uint32_t levels) -> texel_box
+{
+    if (levels <= 1)
+        return b;
+    auto const m = (1u << std::min(levels - 1, 31u)) - 1;
+    auto const x = b.x & ~m;
+    auto const y = b.y & ~m;
+    auto const r = std::min((b.x + b.w + m) & ~m, sz.w);
+    auto const btm = std::min((b.y + b.h + m) & ~m, sz.h);
+    return {x, y, r - x, btm - y};
+}
+
+// mip_chain builds the mip levels of one region of a page from the texels
+// of that region only. Each level is a box filtered reduction of the
+// previous one (the SIMD halving path when the sizes line up). Pages pass
+// a mip_region, whose coarse texels depend on no texel outside of it, see
+// mip_source.
+class mip_chain {
+public:
+    // generate builds levels 1 to levels - 1 for a box of a page whose level
+    // 0 texels are data (stride in pixels), nargb8888 texels should be
+    // premultiplied so transparent neighbours do not darken the edges
+    void generate(uint32_t const* data, std::size_t stride,
+        texel_box const& box, texel_size const& page_size, uint32_t levels);
+
+    auto levels() const -> uint32_t { return uint32_t(levels_.size() + 1); }
+
+    // box returns the texels to upload for a level, clipped to the level
+    // size of the page, the box is empty when it falls outside
+    auto box(uint32_t level) const -> texel_box
+    {
+        auto const b = mip_box(box_, level);
+        auto const sz = mip_size(page_, level);
+        auto const w = b.x < sz.w ? std::min(b.w, sz.w - b.x) : 0;
+        auto const h = b.y < sz.h ? std::min(b.h, sz.h - b.y) : 0;
+        return {b.x, b.y, w, h};
+    }
+
+    // level returns the texels of box(level), for level >= 1
+    auto level(uint32_t level) const -> surface<pixel::nargb8888>
+    {
+        auto const b = box(level);
+        return levels_[level - 1].view().subsurface(0, 0, b.w, b.h);
+    }
+
+private:
+    texel_box box_;
+    texel_size page_;
+    std::vector<image<pixel::nargb8888>> levels_;
+};
+
+// mip_source keeps a copy of the level 0 texels of a mipmapped page, the
+// backends keep none otherwise. update stores a box and rebuilds the mips
+// of its mip_region from the copy, so an update of any size refreshes the
+// coarse texels it shares with its neighbours from all of their texels.
+// Atlas tiles and grid cells aligned to 2^(levels - 1) keep their mips
+// apart, others mix with their neighbours at the coarser levels.
+class mip_source {
+public:
+    // setup sizes the copy for a page, only pages with mips keep one
+    void setup(texel_size const& sz, uint32_t levels);
+
+    auto levels() const -> uint32_t { return levels_; }
+
+    // update copies the box of level 0 texels data (stride in pixels,
+    // premultiplied for nargb8888) and builds the levels of its region
+    void update(texel_box const& box, uint32_t const* data,
+        std::size_t stride, mip_chain& chain);
+
+private:
+    texel_size sz_ = {0, 0};
+    uint32_t levels_ = 1;
+    std::vector<uint32_t> texels_;
+};
+
+} // namespace gtx::texture
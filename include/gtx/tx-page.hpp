@@ -27,6 +27,14 @@ struct uv {
     float v = 0;
 };
 
+// uv_rect is a normalized texture-space rectangle
+struct uv_rect {
+    float u0 = 0;
+    float v0 = 0;
+    float u1 = 0;
+    float v1 = 0;
+};
+
 // uv_mapping maps texel coord to uv coordinate
 struct uv_mapping {
     float scale_x_ = 1.0f;
@@ -57,13 +65,130 @@ struct uv_mapping {
     }
 };
 
+// format is the texel layout of a page in memory: rgba8 takes r, g, b, a
+// bytes, bgra8 takes b, g, r, a which is how pixel::nargb8888 and xrgb8888
+// are stored on little-endian machines, so their surfaces upload as-is.
+// The block compressed formats store 4x4 texel blocks, which of them can be
+// sampled depends on the device (see supports), page sizes should be
+// multiples of 4 (Direct3D requires it). The plane formats hold one or two
+// channels of video frames (see tx-video.hpp), they are sampled as r and rg
+// and uploaded with update_plane.
+enum class format {
+    rgba8,
+    bgra8,
+    bc1,        // 8 bytes per block, rgb with 1-bit alpha
+    bc3,        // 16 bytes per block, rgba
+    bc7,        // 16 bytes per block, rgba
+    etc2_rgb8,  // 8 bytes per block, rgb
+    etc2_rgba8, // 16 bytes per block, rgba
+    r8,         // 1 byte per texel, plane
+    rg8,        // 2 bytes per texel, plane
+};
+
+constexpr auto is_compressed(format f) -> bool
+{
+    return f >= format::bc1 && f <= format::etc2_rgba8;
+}
+
+constexpr auto is_plane(format f) -> bool
+{
+    return f == format::r8 || f == format::rg8;
+}
+
+// texel_bytes is the size of a texel of the uncompressed formats
+constexpr auto texel_bytes(format f) -> size_t
+{
+    return f == format::r8 ? 1 : f == format::rg8 ? 2 : 4;
+}
+
+constexpr auto block_bytes(format f) -> size_t
+{
+    return f == format::bc1 || f == format::etc2_rgb8 ? 8 : 16;
+}
+
+// supports tells whether pages of a format can be created on the current
+// device, the uncompressed formats are always supported
+auto supports(format fmt) -> bool;
+
 struct page_data;
 struct sprite;
 
+// page_handle refers to a page record in the registry, the handle goes stale
+// (fails validation) once its page is released and the slot is reused
+struct page_handle {
+    uint32_t index = uint32_t(-1);
+    uint32_t generation = 0;
+    constexpr auto operator==(page_handle const&) const -> bool = default;
+};
+
+// page_record keeps the per-page data that is needed for drawing, so that
+// sprites can be resolved with plain loads instead of weak_ptr locking
+struct page_record {
+    void* native_handle = nullptr;
+    uint32_t native_index = uint32_t(-1);
+    uint32_t generation = 1;
+    texel_size size = {0, 0};
+    std::weak_ptr<page_data> pd; // for the opt-in shared ownership path
+};
+
+// page_registry is a slot map of page records indexed by (index, generation),
+// records are inserted and erased by the backend along with its page data
+struct page_registry {
+    auto find(page_handle const& h) const -> page_record const*
+    {
+        if (h.index >= records_.size())
+            return nullptr;
+        auto& r = records_[h.index];
+        return r.generation == h.generation ? &r : nullptr;
+    }
+
+    auto insert(std::weak_ptr<page_data> pd, void* native_handle,
+        uint32_t native_index, texel_size const& size) -> page_handle
+    {
+        auto index = uint32_t(records_.size());
+        if (!free_.empty()) {
+            index = free_.back();
+            free_.pop_back();
+        }
+        else
+            records_.emplace_back();
+        auto& r = records_[index];
+        r.native_handle = native_handle;
+        r.native_index = native_index;
+        r.size = size;
+        r.pd = std::move(pd);
+        return {index, r.generation};
+    }
+
+    void erase(page_handle const& h)
+    {
+        if (h.index >= records_.size())
+            return;
+        auto& r = records_[h.index];
+        if (r.generation != h.generation)
+            return;
+        r.native_handle = nullptr;
+        r.native_index = uint32_t(-1);
+        r.size = {0, 0};
+        r.pd.reset();
+        ++r.generation;
+        free_.push_back(h.index);
+    }
+
+private:
+    std::vector<page_record> records_;
+    std::vector<uint32_t> free_;
+};
+
+inline page_registry registry;
+
 struct page {
     page() noexcept {}
     page(texel_size const& sz) { setup(sz); }
-    page(uint32_t w, uint32_t h) { setup({w, h}); }
+    page(uint32_t w, uint32_t h, uint32_t levels = 1)
+    {
+        setup({w, h}, false, format::rgba8, levels);
+    }
     page(page const&) = delete;
     page(page&&) = default;
 
@@ -79,19 +204,51 @@ struct page {
     void release() { pd_.reset(); }
     static void release_all();
 
-    void setup(texel_size const& sz, bool wrap = false);
+    // levels is the number of mip levels, 0 gives the full chain, with more
+    // than one level the page keeps a copy of its level 0 texels and update
+    // also rebuilds the mips of the updated box grown to 2^(levels - 1)
+    // (see mip_source in tx-mipmap.hpp). Plane pages always have one level.
+    void setup(texel_size const& sz, bool wrap = false,
+        format fmt = format::rgba8, uint32_t levels = 1);
+
+    // update uploads nargb8888 pixels, with premultiply the color channels
+    // are scaled by alpha while the data is copied for upload (the source
+    // is left untouched). On bc pages the pixels are encoded with
+    // pixel::encode_blocks first, the box must then start on a 4x4 block and
+    // end on one or at the page edge, mip levels whose box is not aligned
+    // that way are left as they are. Plane pages take update_plane instead.
     auto update(texel_box const& box, uint32_t const* data,
-        size_t data_stride_bytes) -> bool;
+        size_t data_stride_bytes, bool premultiply = false) -> bool;
 
-    auto update(surface<uint32_t> const& surf) -> bool
+    // update_blocks uploads encoded blocks to one level of a compressed
+    // page, box is in texels of that level and aligned as above, the block
+    // rows are tightly packed
+    auto update_blocks(
+        texel_box const& box, void const* blocks, uint32_t level = 0) -> bool;
+
+    // update_plane uploads texels of a plane page as they are, 1 (r8) or 2
+    // (rg8) bytes per texel, data_stride is in texels
+    auto update_plane(
+        texel_box const& box, void const* texels, size_t data_stride) -> bool;
+
+    auto update(surface<uint32_t> const& surf, bool premultiply = false)
+        -> bool
     {
         return update(
             texel_box{0, 0, uint32_t(surf.width()), uint32_t(surf.height())},
-            surf.data(), surf.stride());
+            surf.data(), surf.stride(), premultiply);
     }
 
     auto native_handle() const -> void*;
     auto get_size() const -> texel_size;
+    auto get_format() const -> format;
+    auto get_levels() const -> uint32_t;
+
+    // native_index returns the page slot within the backend's bindless
+    // descriptor array, or uint32_t(-1) when bindless mode is not active
+    auto native_index() const -> uint32_t;
+
+    auto handle() const -> page_handle;
 
     auto as_sprite() const -> sprite;
 
@@ -105,27 +262,35 @@ private:
     }
 };
 
+// sprite is a lightweight reference to a box within a page, it caches the
+// page handle and its uv mapping so that the accessors used while drawing
+// do not touch the page's reference counts. A trimmed sprite holds only
+// part of its source image: its frame has the source size and locates the
+// box within the source (see atlas::insert_trimmed).
 struct sprite {
-    sprite()
-        : pd_{}
-        , box_{0, 0, 0, 0}
-    {
-    }
-    sprite(page const& p, texture::texel_box const& b)
-        : pd_{p.pd_}
-        , box_{b}
-    {
-    }
+    sprite() noexcept {}
+    sprite(page const& p, texture::texel_box const& b);
+    sprite(page const& p, texture::texel_box const& b,
+        texture::texel_box const& frame);
+
+    auto valid() const -> bool { return registry.find(handle_) != nullptr; }
+    auto handle() const -> page_handle { return handle_; }
 
     auto native_handle() const -> void*;
+    auto native_index() const -> uint32_t;
     auto get_page() const -> texture::page;
     auto get_box() const -> texture::texel_box const&;
     auto get_size() const -> texture::texel_size;
-    auto uv_mapping() const -> texture::uv_mapping;
+    auto get_frame() const -> texture::texel_box;
+    auto trimmed() const -> bool { return frame_.w != 0; }
+    auto uv_mapping() const -> texture::uv_mapping const&;
+    auto uv_rect() const -> texture::uv_rect;
 
 private:
-    std::weak_ptr<page_data> pd_;
-    texture::texel_box box_; // texel units
+    page_handle handle_;
+    texture::texel_box box_ = {0, 0, 0, 0}; // texel units
+    texture::texel_box frame_ = {0, 0, 0, 0}; // offset and source size
+    texture::uv_mapping uv_;
 };
 
 inline auto page::as_sprite() const -> sprite
@@ -134,9 +299,38 @@ inline auto page::as_sprite() const -> sprite
     return sprite{*this, {0, 0, sz.w, sz.h}};
 }
 
+inline sprite::sprite(page const& p, texture::texel_box const& b)
+    : handle_{p.handle()}
+    , box_{b}
+{
+    if (auto r = registry.find(handle_))
+        uv_ = texture::uv_mapping{r->size, float(b.x), float(b.y)};
+}
+
+inline sprite::sprite(page const& p, texture::texel_box const& b,
+    texture::texel_box const& frame)
+    : sprite{p, b}
+{
+    frame_ = frame;
+}
+
+inline auto sprite::native_handle() const -> void*
+{
+    auto r = registry.find(handle_);
+    return r ? r->native_handle : nullptr;
+}
+
+inline auto sprite::native_index() const -> uint32_t
+{
+    auto r = registry.find(handle_);
+    return r ? r->native_index : uint32_t(-1);
+}
+
+// get_page is the opt-in path back to the page's shared ownership
 inline auto sprite::get_page() const -> texture::page
 {
-    return texture::page{pd_};
+    auto r = registry.find(handle_);
+    return r ? texture::page{r->pd} : texture::page{};
 }
 
 inline auto sprite::get_box() const -> texture::texel_box const&
@@ -149,10 +343,23 @@ inline auto sprite::get_size() const -> texture::texel_size
     return {box_.w, box_.h};
 }
 
-inline auto sprite::uv_mapping() const -> texture::uv_mapping
+// get_frame is the offset of the box within the source image and the
+// source size, (0, 0, w, h) for untrimmed sprites
+inline auto sprite::get_frame() const -> texture::texel_box
+{
+    return trimmed() ? frame_ : texture::texel_box{0, 0, box_.w, box_.h};
+}
+
+inline auto sprite::uv_mapping() const -> texture::uv_mapping const&
+{
+    return uv_;
+}
+
+inline auto sprite::uv_rect() const -> texture::uv_rect
 {
-    return texture::uv_mapping{
-        get_page().get_size(), float(box_.x), float(box_.y)};
+    return {uv_.offset_x_, uv_.offset_y_,
+        uv_.offset_x_ + uv_.scale_x_ * box_.w,
+        uv_.offset_y_ + uv_.scale_y_ * box_.h};
 }
 
 } // namespace gtx::texture
\ No newline at end of file
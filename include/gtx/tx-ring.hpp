@@ -0,0 +1,164 @@
+#pragma once
+
+#include <gtx/surface.hpp>
+#include <gtx/tx-page.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace gtx::texture {
+
+// ring_axis is the direction a ring_texture scrolls in: rows appends
+// page-wide rows (newest at the bottom), columns page-high columns (newest
+// on the right)
+enum class ring_axis {
+    rows,
+    columns,
+};
+
+// ring_texture uses a repeat-wrapped page as a circular scrolling image,
+// e.g. for waterfalls and spectrograms. Lines are written at a moving
+// cursor, so streaming one costs a single upload of that line however long
+// the history is, and drawing starts the texture at the cursor: with the
+// repeat sampler the oldest line comes first and the newest last. Lines are
+// nargb8888 like page::update, compressed formats are not supported since
+// lines are not block aligned.
+class ring_texture {
+public:
+    ring_texture() noexcept {}
+
+    ring_texture(texel_size const& sz, ring_axis axis = ring_axis::rows,
+        format fmt = format::rgba8)
+    {
+        setup(sz, axis, fmt);
+    }
+
+    // setup creates the page and clears it to transparent, which is the
+    // only full upload. Returns false for compressed formats or an upload
+    // failure.
+    auto setup(texel_size const& sz, ring_axis axis = ring_axis::rows,
+        format fmt = format::rgba8) -> bool
+    {
+        cursor_ = 0;
+        filled_ = 0;
+        axis_ = axis;
+        if (is_compressed(fmt) || !sz.w || !sz.h)
+            return false;
+        page_.setup(sz, true, fmt);
+        auto const zero = std::vector<uint32_t>(std::size_t(sz.w) * sz.h);
+        return page_.update({0, 0, sz.w, sz.h}, zero.data(), sz.w);
+    }
+
+    // append writes one line of line_size() pixels at the cursor
+    auto append(uint32_t const* line, bool premultiply = false) -> bool
+    {
+        auto const n = line_size();
+        return append(axis_ == ring_axis::rows
+                          ? surface<uint32_t const>{line, n, 1}
+                          : surface<uint32_t const>{line, 1, n},
+            premultiply);
+    }
+
+    // append writes the rows (or columns) of lines in order, the page is
+    // updated at most twice where they wrap around. Only the last
+    // history() lines are kept when more are given, lines shorter than
+    // line_size() leave the rest of theirs as it was.
+    auto append(surface<uint32_t const> const& lines, bool premultiply = false)
+        -> bool
+    {
+        auto const rows = axis_ == ring_axis::rows;
+        auto const len = uint32_t(rows ? lines.width() : lines.height());
+        auto count = uint32_t(rows ? lines.height() : lines.width());
+        if (!page_ || !len || !count || len > line_size())
+            return false;
+
+        auto const hist = history();
+        auto const skip = count > hist ? count - hist : 0;
+        count -= skip;
+        auto const* data = lines.data() +
+                           (rows ? skip * lines.stride() : std::size_t(skip));
+        while (count) {
+            auto const n = std::min(count, hist - cursor_);
+            auto const box = rows ? texel_box{0, cursor_, len, n}
+                                  : texel_box{cursor_, 0, n, len};
+            if (!page_.update(box, data, lines.stride(), premultiply))
+                return false;
+            data += rows ? n * lines.stride() : std::size_t(n);
+            count -= n;
+            cursor_ = (cursor_ + n) % hist;
+            filled_ = std::min(filled_ + n, hist);
+        }
+        return true;
+    }
+
+    auto append(surface<uint32_t> const& lines, bool premultiply = false)
+        -> bool
+    {
+        return append(surface<uint32_t const>{lines.data(), lines.width(),
+                          lines.height(), lines.stride()},
+            premultiply);
+    }
+
+    // clear forgets the history, the page keeps its old lines until they
+    // are overwritten
+    void clear()
+    {
+        cursor_ = 0;
+        filled_ = 0;
+    }
+
+    auto get_page() -> page& { return page_; }
+    auto get_page() const -> page const& { return page_; }
+    auto axis() const -> ring_axis { return axis_; }
+
+    // line_size is the length of a line, history the number of lines kept
+    auto line_size() const -> uint32_t
+    {
+        auto const sz = page_.get_size();
+        return axis_ == ring_axis::rows ? sz.w : sz.h;
+    }
+    auto history() const -> uint32_t
+    {
+        auto const sz = page_.get_size();
+        return axis_ == ring_axis::rows ? sz.h : sz.w;
+    }
+
+    // cursor is where the next line goes, which is also the oldest line
+    // once filled() reaches history()
+    auto cursor() const -> uint32_t { return cursor_; }
+    auto filled() const -> uint32_t { return filled_; }
+
+    // uv_offset is the cursor in uv units along the axis, sample at
+    // uv_offset() + t for t in [0, 1) to get the lines oldest first
+    auto uv_offset() const -> float
+    {
+        auto const h = history();
+        return h ? float(cursor_) / float(h) : 0.0f;
+    }
+
+    auto uv_rect() const -> texture::uv_rect
+    {
+        auto const o = uv_offset();
+        return axis_ == ring_axis::rows ? texture::uv_rect{0, o, 1, o + 1}
+                                        : texture::uv_rect{o, 0, o + 1, 1};
+    }
+
+    // as_sprite covers the whole history starting at the cursor, its box
+    // runs past the page edge so that sprite_batch samples it wrapped
+    auto as_sprite() const -> sprite
+    {
+        auto const sz = page_.get_size();
+        return axis_ == ring_axis::rows
+                   ? sprite{page_, {0, cursor_, sz.w, sz.h}}
+                   : sprite{page_, {cursor_, 0, sz.w, sz.h}};
+    }
+
+private:
+    page page_;
+    ring_axis axis_ = ring_axis::rows;
+    uint32_t cursor_ = 0;
+    uint32_t filled_ = 0;
+};
+
+} // namespace gtx::texture
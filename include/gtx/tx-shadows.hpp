@@ -0,0 +1,148 @@
+#pragma once
+
+#include "pixel/blur.hpp"
+#include "pixel/raster.hpp"
+#include "tx-atlas.hpp"
+#include "tx-page.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace gtx::texture {
+
+struct shadow {
+    sprite spr;
+    float inset = 0;   // the shape starts inset texels into the sprite
+    bool empty = true; // too large for a page, nothing to draw
+};
+
+// shadow_cache keeps blurred masks of rounded rectangles (drop shadows and
+// glows) in an atlas of texture pages, keyed by shape size and blur radius
+// (see pixel::blur_options). A shadow is rendered and blurred once on first
+// use, draw its sprite over the shape's rect grown by inset on every side
+// and tinted with the shadow color.
+struct shadow_cache {
+    struct key {
+        uint32_t w;
+        uint32_t h;
+        float radius;
+        auto operator==(key const&) const -> bool = default;
+    };
+
+    struct key_hash {
+        auto operator()(key const& k) const -> std::size_t
+        {
+            return std::hash<uint64_t>{}(uint64_t(k.w) << 32 | k.h) ^
+                   std::hash<float>{}(k.radius) * 31;
+        }
+    };
+
+    // padding is the transparent border kept around each shadow so that
+    // bilinear sampling does not bleed into the neighbours
+    static constexpr uint32_t padding = 1;
+
+    // corner is the corner radius of the shapes, in texels
+    shadow_cache(texel_size const& page_size, float corner = 0)
+        : atlas_{uint16_t(page_size.w), uint16_t(page_size.h)}
+        , corner_{std::max(corner, 0.0f)}
+    {
+    }
+
+    shadow_cache(shadow_cache const&) = delete;
+
+    void clear()
+    {
+        shadows_.clear();
+        atlas_.clear();
+    }
+
+    // find returns the cached shadow, or renders it on a miss. A failed
+    // upload returns an empty shadow without caching it so that the next
+    // find tries again.
+    auto find(uint32_t w, uint32_t h, float radius) -> shadow const*
+    {
+        auto const k = key{w, h, radius};
+        if (auto it = shadows_.find(k); it != shadows_.end()) {
+            if (it->second.empty || it->second.spr.valid())
+                return &it->second;
+            // pages were released (e.g. device change), start over
+            clear();
+        }
+        auto s = render(k);
+        if (!s)
+            return &failed_;
+        return &(shadows_[k] = *s);
+    }
+
+private:
+    atlas<page, key> atlas_;
+    float corner_;
+    std::unordered_map<key, shadow, key_hash> shadows_;
+    std::vector<pixel::a8> mask_;
+    std::vector<uint32_t> scratch_;
+    shadow const failed_;
+
+    // render returns nothing when the upload failed and an empty shadow
+    // when the shape is empty or too large for a page
+    auto render(key const& k) -> std::optional<shadow>
+    {
+        // a gaussian reaches about 3 sigma = 1.5 radius past the shape
+        auto const inset = uint32_t(std::ceil(1.5f * std::max(k.radius, 0.0f)));
+        auto const mw = k.w + 2 * inset;
+        auto const mh = k.h + 2 * inset;
+        auto const pw = mw + 2 * padding;
+        auto const ph = mh + 2 * padding;
+        if (!k.w || !k.h || pw > atlas_.page_w || ph > atlas_.page_h)
+            return shadow{};
+
+        auto const x0 = float(inset);
+        auto const y0 = float(inset);
+        auto const x1 = x0 + float(k.w);
+        auto const y1 = y0 + float(k.h);
+        auto const c = std::min({corner_, k.w / 2.0f, k.h / 2.0f});
+        auto const t = c * 0.4477f; // cubic quarter circle, 1 - 0.5523
+        auto p = pixel::path{};
+        p.move_to({x0 + c, y0});
+        p.line_to({x1 - c, y0});
+        p.cubic_to({x1 - t, y0}, {x1, y0 + t}, {x1, y0 + c});
+        p.line_to({x1, y1 - c});
+        p.cubic_to({x1, y1 - t}, {x1 - t, y1}, {x1 - c, y1});
+        p.line_to({x0 + c, y1});
+        p.cubic_to({x0 + t, y1}, {x0, y1 - t}, {x0, y1 - c});
+        p.line_to({x0, y0 + c});
+        p.cubic_to({x0, y0 + t}, {x0 + t, y0}, {x0 + c, y0});
+        p.close();
+
+        mask_.resize(std::size_t(mw) * mh);
+        auto mask = surface<pixel::a8>{mask_.data(), mw, mh};
+        pixel::fill(p, mask);
+        pixel::blur(mask, mask, pixel::blur_options{k.radius});
+
+        scratch_.assign(std::size_t(pw) * ph, 0);
+        for (uint32_t y = 0; y < mh; ++y)
+            for (uint32_t x = 0; x < mw; ++x)
+                scratch_[(y + padding) * pw + x + padding] =
+                    uint32_t(mask_[y * mw + x].value) << 24 | 0xffffff;
+
+        atlas_.insert_tile(uint16_t(pw), uint16_t(ph), key{k});
+        auto const& tile = atlas_.tiles.back();
+        auto& pg = atlas_.pages[tile.pageref].base;
+        if (!pg.update({tile.x, tile.y, pw, ph}, scratch_.data(), pw)) {
+            atlas_.erase_last();
+            return std::nullopt;
+        }
+
+        auto s = shadow{};
+        s.spr = sprite{pg, {tile.x + padding, tile.y + padding, mw, mh}};
+        s.inset = float(inset);
+        s.empty = false;
+        return s;
+    }
+};
+
+} // namespace gtx::texture
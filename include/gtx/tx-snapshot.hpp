@@ -0,0 +1,358 @@
+#pragma once
+
+#include <gtx/tx-atlas.hpp>
+#include <gtx/tx-page.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace gtx::texture {
+
+// A snapshot stores an atlas (its tiles, rows, cells, payloads and the
+// index of shared images) along with the level 0 texels of its pages, so
+// that a warm start is a file mapping plus one upload per page. The file
+// is a header followed by tables and texel sections, each starting on a
+// multiple of snapshot_alignment, the sources of the shared images are
+// packed after the payloads. Offsets are from the start of the file,
+// values are little-endian and the texels of a page are tightly packed rows
+// in the page format (4 bytes per texel, or rows of 4x4 blocks).
+constexpr uint32_t snapshot_version = 4;
+constexpr std::size_t snapshot_alignment = 64;
+
+struct snapshot_header {
+    char magic[8]; // "gtxatlas"
+    uint32_t version;
+    uint32_t header_bytes;
+    uint16_t page_w;
+    uint16_t page_h;
+    uint16_t align;
+    uint16_t payload_bytes;
+    uint32_t format;
+    uint32_t pages;
+    uint32_t rows;
+    uint32_t cells;
+    uint32_t tiles;
+    uint32_t shared;
+    uint64_t pages_offset;
+    uint64_t rows_offset;
+    uint64_t cells_offset;
+    uint64_t tiles_offset;
+    uint64_t shared_offset;
+    uint64_t payloads_offset;
+    uint64_t file_bytes;
+};
+
+struct snapshot_page {
+    uint64_t texels_offset;
+    uint64_t texels_bytes;
+    uint32_t first_row;
+    uint32_t row_count;
+};
+
+struct snapshot_row {
+    uint16_t y;
+    uint16_t h;
+    uint32_t first_cell;
+    uint32_t cell_count;
+    uint32_t sealed;
+};
+
+struct snapshot_cell {
+    uint16_t x;
+    uint16_t w;
+    uint16_t h;
+    uint16_t reserved;
+};
+
+struct snapshot_tile {
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+    int16_t ox;
+    int16_t oy;
+    uint16_t src_w;
+    uint16_t src_h;
+    uint16_t pageref;
+    uint16_t reserved;
+};
+
+// snapshot_shared is an entry of atlas::shared, sorted by hash, its source
+// is source_bytes bytes at source_offset
+struct snapshot_shared {
+    uint64_t hash;
+    uint32_t tile;
+    uint16_t w;
+    uint16_t h;
+    uint32_t refs;
+    uint32_t source_bytes;
+    uint64_t source_offset;
+};
+
+// page_bytes is the size of the level 0 texels of a page
+constexpr auto page_bytes(format fmt, texel_size const& sz) -> std::size_t
+{
+    if (is_compressed(fmt))
+        return std::size_t(sz.w + 3) / 4 * ((sz.h + 3) / 4) * block_bytes(fmt);
+    return std::size_t(sz.w) * sz.h * 4;
+}
+
+// mapped_file is a read-only mapping of a whole file
+class mapped_file {
+public:
+    mapped_file() = default;
+    explicit mapped_file(char const* path) { open(path); }
+    mapped_file(mapped_file const&) = delete;
+    ~mapped_file() { close(); }
+
+    auto open(char const* path) -> bool;
+    void close();
+
+    auto data() const -> std::span<std::byte const> { return {data_, size_}; }
+    explicit operator bool() const { return data_ != nullptr; }
+
+private:
+    std::byte const* data_ = nullptr;
+    std::size_t size_ = 0;
+#if defined(_WIN32)
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+struct snapshot_expect {
+    texel_size page_size;
+    uint32_t align;
+    format fmt;
+    std::size_t payload_bytes;
+};
+
+// check_snapshot validates a snapshot against the atlas it is loaded into:
+// magic, version, page size, alignment, format and payload size, that
+// every table, source and texel section lies within the data and every
+// reference within its table, and that rows and cells lie within their
+// page and row without overlapping. It returns the header, or null if
+// anything is off.
+auto check_snapshot(std::span<std::byte const> data, snapshot_expect const& e)
+    -> snapshot_header const*;
+
+namespace detail {
+
+inline auto snapshot_align(uint64_t n) -> uint64_t
+{
+    return (n + snapshot_alignment - 1) & ~uint64_t(snapshot_alignment - 1);
+}
+
+template <typename T>
+auto snapshot_table(std::span<std::byte const> data, uint64_t offset)
+    -> T const*
+{
+    return reinterpret_cast<T const*>(data.data() + offset);
+}
+
+} // namespace detail
+
+// save_snapshot writes a of page format fmt to path, pages have no CPU
+// copy so texels[i] are the level 0 texels of page i as described above
+// (e.g. the staging surface the page was filled from)
+template <typename Payload>
+auto save_snapshot(char const* path, atlas<page, Payload> const& a, format fmt,
+    std::span<std::span<std::byte const> const> texels) -> bool
+{
+    static_assert(std::is_trivially_copyable_v<Payload>,
+        "snapshot payloads are stored as raw bytes");
+    using detail::snapshot_align;
+
+    auto const sz = texel_size{a.page_w, a.page_h};
+    if (texels.size() != a.pages.size())
+        return false;
+    for (auto const& t : texels)
+        if (t.size() != page_bytes(fmt, sz))
+            return false;
+
+    auto pages = std::vector<snapshot_page>{};
+    auto rows = std::vector<snapshot_row>{};
+    auto cells = std::vector<snapshot_cell>{};
+    for (auto const& p : a.pages) {
+        pages.push_back({0, page_bytes(fmt, sz), uint32_t(rows.size()),
+            uint32_t(p.rows.size())});
+        for (auto const& r : p.rows) {
+            rows.push_back({r.y, r.h, uint32_t(cells.size()),
+                uint32_t(r.cells.size()), r.sealed});
+            for (auto const& c : r.cells)
+                cells.push_back({c.x, c.w, c.h, 0});
+        }
+    }
+    auto tiles = std::vector<snapshot_tile>{};
+    for (auto const& t : a.tiles)
+        tiles.push_back(
+            {t.x, t.y, t.w, t.h, t.ox, t.oy, t.src_w, t.src_h, t.pageref, 0});
+    auto shared = std::vector<snapshot_shared>{};
+    for (auto const& [hash, e] : a.shared)
+        shared.push_back(
+            {hash, e.tile, e.w, e.h, e.refs, uint32_t(e.source.size()), 0});
+    std::sort(shared.begin(), shared.end(),
+        [](auto const& l, auto const& r) { return l.hash < r.hash; });
+
+    auto h = snapshot_header{};
+    std::memcpy(h.magic, "gtxatlas", 8);
+    h.version = snapshot_version;
+    h.header_bytes = sizeof(snapshot_header);
+    h.page_w = a.page_w;
+    h.page_h = a.page_h;
+    h.align = a.align;
+    h.payload_bytes = uint16_t(sizeof(Payload));
+    h.format = uint32_t(fmt);
+    h.pages = uint32_t(pages.size());
+    h.rows = uint32_t(rows.size());
+    h.cells = uint32_t(cells.size());
+    h.tiles = uint32_t(tiles.size());
+    h.shared = uint32_t(shared.size());
+    h.pages_offset = snapshot_align(sizeof(h));
+    h.rows_offset = snapshot_align(
+        h.pages_offset + pages.size() * sizeof(snapshot_page));
+    h.cells_offset =
+        snapshot_align(h.rows_offset + rows.size() * sizeof(snapshot_row));
+    h.tiles_offset =
+        snapshot_align(h.cells_offset + cells.size() * sizeof(snapshot_cell));
+    h.shared_offset =
+        snapshot_align(h.tiles_offset + tiles.size() * sizeof(snapshot_tile));
+    h.payloads_offset = snapshot_align(
+        h.shared_offset + shared.size() * sizeof(snapshot_shared));
+    auto end = h.payloads_offset + tiles.size() * sizeof(Payload);
+    for (auto& s : shared) {
+        s.source_offset = end;
+        end += s.source_bytes;
+    }
+    end = snapshot_align(end);
+    for (auto& p : pages) {
+        p.texels_offset = end;
+        end = snapshot_align(end + p.texels_bytes);
+    }
+    h.file_bytes = end;
+
+    auto out = std::ofstream{path, std::ios::binary | std::ios::trunc};
+    auto at = uint64_t(0);
+    auto const write = [&](uint64_t offset, void const* data, std::size_t n) {
+        static char const zeros[snapshot_alignment] = {};
+        out.write(zeros, std::streamsize(offset - at));
+        out.write(static_cast<char const*>(data), std::streamsize(n));
+        at = offset + n;
+    };
+    write(0, &h, sizeof(h));
+    write(h.pages_offset, pages.data(), pages.size() * sizeof(snapshot_page));
+    write(h.rows_offset, rows.data(), rows.size() * sizeof(snapshot_row));
+    write(h.cells_offset, cells.data(), cells.size() * sizeof(snapshot_cell));
+    write(h.tiles_offset, tiles.data(), tiles.size() * sizeof(snapshot_tile));
+    write(h.shared_offset, shared.data(),
+        shared.size() * sizeof(snapshot_shared));
+    for (std::size_t i = 0; i < a.tiles.size(); ++i)
+        write(h.payloads_offset + i * sizeof(Payload), &a.tiles[i].payload,
+            sizeof(Payload));
+    for (auto const& s : shared)
+        write(s.source_offset, a.shared.at(s.hash).source.data(),
+            s.source_bytes);
+    for (std::size_t i = 0; i < pages.size(); ++i)
+        write(pages[i].texels_offset, texels[i].data(), texels[i].size());
+    write(h.file_bytes, nullptr, 0);
+    return bool(out.flush());
+}
+
+// load_snapshot replaces the contents of a with a validated snapshot
+// (see check_snapshot), its pages are created in format fmt and uploaded
+// straight from data. On failure a is left empty.
+template <typename Payload>
+auto load_snapshot(std::span<std::byte const> data, atlas<page, Payload>& a,
+    format fmt) -> bool
+{
+    static_assert(std::is_trivially_copyable_v<Payload>,
+        "snapshot payloads are stored as raw bytes");
+    using detail::snapshot_table;
+    using atlas_t = atlas<page, Payload>;
+
+    a.clear();
+    auto const sz = texel_size{a.page_w, a.page_h};
+    auto const h = check_snapshot(data, {sz, a.align, fmt, sizeof(Payload)});
+    if (!h)
+        return false;
+
+    auto const pages = snapshot_table<snapshot_page>(data, h->pages_offset);
+    auto const rows = snapshot_table<snapshot_row>(data, h->rows_offset);
+    auto const cells = snapshot_table<snapshot_cell>(data, h->cells_offset);
+    auto const tiles = snapshot_table<snapshot_tile>(data, h->tiles_offset);
+    auto const shared =
+        snapshot_table<snapshot_shared>(data, h->shared_offset);
+
+    a.pages.reserve(h->pages);
+    for (uint32_t i = 0; i < h->pages; ++i) {
+        auto const& sp = pages[i];
+        auto p = page{};
+        p.setup(sz, false, fmt, a.levels);
+        auto const texels = data.data() + sp.texels_offset;
+        auto const uploaded = is_compressed(fmt)
+            ? p.update_blocks({0, 0, sz.w, sz.h}, texels)
+            : p.update({0, 0, sz.w, sz.h},
+                  reinterpret_cast<uint32_t const*>(texels), sz.w);
+        if (!uploaded) {
+            a.clear();
+            return false;
+        }
+
+        auto& ap = a.pages.emplace_back(std::move(p));
+        ap.rows.reserve(sp.row_count);
+        auto const last_row = rows + sp.first_row + sp.row_count;
+        for (auto r = rows + sp.first_row; r != last_row; ++r) {
+            auto& ar = ap.rows.emplace_back();
+            ar.y = r->y;
+            ar.h = r->h;
+            ar.sealed = r->sealed != 0;
+            ar.cells.reserve(r->cell_count);
+            for (auto c = cells + r->first_cell;
+                 c != cells + r->first_cell + r->cell_count; ++c)
+                ar.cells.push_back({c->x, c->w, c->h});
+        }
+    }
+
+    a.tiles.resize(h->tiles);
+    for (uint32_t i = 0; i < h->tiles; ++i) {
+        auto& t = a.tiles[i];
+        t.x = tiles[i].x;
+        t.y = tiles[i].y;
+        t.w = tiles[i].w;
+        t.h = tiles[i].h;
+        t.ox = tiles[i].ox;
+        t.oy = tiles[i].oy;
+        t.src_w = tiles[i].src_w;
+        t.src_h = tiles[i].src_h;
+        t.pageref = typename atlas_t::pageref_t(tiles[i].pageref);
+        std::memcpy(&t.payload,
+            data.data() + h->payloads_offset + i * sizeof(Payload),
+            sizeof(Payload));
+    }
+
+    a.shared.reserve(h->shared);
+    for (uint32_t i = 0; i < h->shared; ++i) {
+        auto const source = data.subspan(
+            shared[i].source_offset, shared[i].source_bytes);
+        a.shared.emplace(shared[i].hash,
+            typename atlas_t::shared_entry{shared[i].tile, shared[i].w,
+                shared[i].h, shared[i].refs, {source.begin(), source.end()}});
+    }
+    return true;
+}
+
+template <typename Payload>
+auto load_snapshot(char const* path, atlas<page, Payload>& a, format fmt)
+    -> bool
+{
+    auto const file = mapped_file{path};
+    return file && load_snapshot(file.data(), a, fmt);
+}
+
+} // namespace gtx::texture
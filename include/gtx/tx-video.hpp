@@ -0,0 +1,122 @@
+#pragma once
+
+#include <gtx/pixel/yuv.hpp>
+#include <gtx/surface.hpp>
+#include <gtx/tx-page.hpp>
+
+#include <cstdint>
+
+namespace gtx::texture {
+
+enum class yuv_layout {
+    i420, // r8 luma, r8 u and r8 v at half size
+    nv12, // r8 luma, rg8 uv pairs at half size
+};
+
+// video_page keeps a 4:2:0 video frame as its planes, so that a frame
+// uploads as decoded (1.5 bytes per pixel instead of 4 for rgba) and is
+// converted to rgb while drawing (see shdr::video_batch). The chroma
+// planes have half the frame size rounded up, the matrix and range tell
+// the shader how to convert, pixel::yuv_to_nargb does the same on the CPU.
+class video_page {
+public:
+    video_page() noexcept {}
+
+    video_page(texel_size const& sz, yuv_layout layout,
+        pixel::yuv_matrix matrix = pixel::yuv_matrix::bt709,
+        pixel::yuv_range range = pixel::yuv_range::limited)
+    {
+        setup(sz, layout, matrix, range);
+    }
+
+    // setup creates the plane pages, unless they already have that size
+    // and layout
+    auto setup(texel_size const& sz, yuv_layout layout,
+        pixel::yuv_matrix matrix = pixel::yuv_matrix::bt709,
+        pixel::yuv_range range = pixel::yuv_range::limited) -> bool
+    {
+        layout_ = layout;
+        matrix_ = matrix;
+        range_ = range;
+        if (!sz.w || !sz.h)
+            return false;
+        auto const c = chroma_size(sz);
+        planes_[0].setup(sz, false, format::r8);
+        if (layout == yuv_layout::i420) {
+            planes_[1].setup(c, false, format::r8);
+            planes_[2].setup(c, false, format::r8);
+        }
+        else {
+            planes_[1].setup(c, false, format::rg8);
+            planes_[2].release();
+        }
+        return valid();
+    }
+
+    // update uploads an i420 frame, the planes must cover the frame
+    auto update(surface<uint8_t> const& y, surface<uint8_t> const& u,
+        surface<uint8_t> const& v) -> bool
+    {
+        auto const sz = get_size();
+        auto const c = chroma_size(sz);
+        return layout_ == yuv_layout::i420 && valid() && covers(y, sz) &&
+               covers(u, c) && covers(v, c) && upload(planes_[0], y, sz) &&
+               upload(planes_[1], u, c) && upload(planes_[2], v, c);
+    }
+
+    // update uploads an nv12 frame, the planes must cover the frame
+    auto update(surface<uint8_t> const& y, surface<pixel::uv88> const& uv)
+        -> bool
+    {
+        auto const sz = get_size();
+        auto const c = chroma_size(sz);
+        return layout_ == yuv_layout::nv12 && valid() && covers(y, sz) &&
+               covers(uv, c) && upload(planes_[0], y, sz) &&
+               upload(planes_[1], uv, c);
+    }
+
+    auto valid() const -> bool
+    {
+        return planes_[0] && planes_[1] &&
+               (layout_ == yuv_layout::nv12 || planes_[2]);
+    }
+
+    void release()
+    {
+        for (auto& p : planes_)
+            p.release();
+    }
+
+    // plane 0 is the luma, 1 the u (or uv) and 2 the v plane
+    auto plane(unsigned i) const -> page const& { return planes_[i]; }
+    auto get_size() const -> texel_size { return planes_[0].get_size(); }
+    auto layout() const -> yuv_layout { return layout_; }
+    auto matrix() const -> pixel::yuv_matrix { return matrix_; }
+    auto range() const -> pixel::yuv_range { return range_; }
+
+    static constexpr auto chroma_size(texel_size const& sz) -> texel_size
+    {
+        return {(sz.w + 1) / 2, (sz.h + 1) / 2};
+    }
+
+private:
+    page planes_[3];
+    yuv_layout layout_ = yuv_layout::i420;
+    pixel::yuv_matrix matrix_ = pixel::yuv_matrix::bt709;
+    pixel::yuv_range range_ = pixel::yuv_range::limited;
+
+    template <typename T>
+    static auto covers(surface<T> const& s, texel_size const& sz) -> bool
+    {
+        return s.data() && s.width() >= sz.w && s.height() >= sz.h;
+    }
+
+    template <typename T>
+    static auto upload(page& p, surface<T> const& s, texel_size const& sz)
+        -> bool
+    {
+        return p.update_plane({0, 0, sz.w, sz.h}, s.data(), s.stride());
+    }
+};
+
+} // namespace gtx::texture
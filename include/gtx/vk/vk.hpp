@@ -21,6 +21,32 @@ private:
     VkSampler vk_sampler_ = nullptr;
 };
 
+struct memory_block;
+
+// allocation is a sub-range of a device memory block owned by the
+// suballocator, host-visible blocks are persistently mapped
+struct allocation {
+    VkDeviceMemory memory = nullptr;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    void* mapped = nullptr;
+
+    explicit operator bool() const { return memory != nullptr; }
+
+private:
+    memory_block* block_ = nullptr;
+    friend auto allocate(VkMemoryRequirements const& requirements,
+        VkMemoryPropertyFlags properties, bool linear) -> allocation;
+    friend void release(allocation& a);
+};
+
+// allocate returns an aligned sub-range from a block of matching memory type,
+// linear resources (buffers) and optimal images are kept in separate blocks
+// to stay clear of bufferImageGranularity
+auto allocate(VkMemoryRequirements const& requirements,
+    VkMemoryPropertyFlags properties, bool linear) -> allocation;
+void release(allocation& a);
+
 struct buffer {
     buffer(VkDeviceSize size, VkBufferUsageFlags usage,
         VkMemoryPropertyFlags properties);
@@ -29,16 +55,20 @@ struct buffer {
     ~buffer();
 
     operator VkBuffer() { return vk_buffer_; }
-    operator VkDeviceMemory() { return vk_memory_; }
+    operator VkDeviceMemory() { return mem_.memory; }
+
+    auto offset() const -> VkDeviceSize { return mem_.offset; }
+    auto mapped() const -> void* { return mem_.mapped; }
 
 private:
     VkBuffer vk_buffer_ = nullptr;
-    VkDeviceMemory vk_memory_ = nullptr;
+    allocation mem_;
 };
 
 struct image_info {
     image_info(uint32_t width, uint32_t height, VkFormat format,
-        VkImageUsageFlags usage, VkMemoryPropertyFlags properties);
+        VkImageUsageFlags usage, VkMemoryPropertyFlags properties,
+        uint32_t mip_levels = 1);
     image_info(image_info&&);
     image_info(image_info const&) = delete;
     ~image_info();
@@ -49,7 +79,7 @@ struct image_info {
 private:
     VkImage vk_image_ = nullptr;
     VkImageView vk_view_ = nullptr;
-    VkDeviceMemory vk_memory_ = nullptr;
+    allocation mem_;
 };
 
 struct descriptor_set_layout {
@@ -78,6 +108,27 @@ private:
     VkDescriptorSet vk_descriptor_set_ = nullptr;
 };
 
+// bindless mode keeps every page in a single descriptor array allocated with
+// update-after-bind, page::native_index() is the element within that array:
+//
+//     layout(set = 0, binding = 0) uniform sampler2D pages[];
+//
+// enable_bindless must be called after set_device and before any pages are
+// created, page::native_handle() then returns the shared descriptor set.
+// The device must support and enable descriptorBindingPartiallyBound,
+// runtimeDescriptorArray, shaderSampledImageArrayNonUniformIndexing,
+// descriptorBindingSampledImageUpdateAfterBind and
+// descriptorBindingUpdateUnusedWhilePending; without them enable_bindless
+// returns false and pages keep a descriptor set each.
+auto enable_bindless(uint32_t capacity = 4096) -> bool;
+auto bindless_enabled() -> bool;
+auto bindless_set_layout() -> VkDescriptorSetLayout;
+auto bindless_set() -> VkDescriptorSet;
+
+// frame_serial counts set_frame calls, per-frame streaming buffers are
+// recycled when the serial moves on
+auto frame_serial() -> uint64_t;
+
 struct shader {
 #ifdef GTX_VULKAN_SHADERC
     shader(shaderc_shader_kind kind, char const* name, std::string_view code);
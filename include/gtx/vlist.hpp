@@ -1,7 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <functional>
 #include <span>
+#include <type_traits>
 #include <vector>
 
 namespace gtx {
@@ -11,6 +13,18 @@ struct index_range {
     size_t last;
 };
 
+namespace detail {
+
+// nullable callbacks are checked before insert calls them, lambdas and
+// other function objects are always called
+template <typename F>
+constexpr bool nullable_callback =
+    std::is_pointer_v<F> || std::is_member_pointer_v<F>;
+template <typename R, typename... Args>
+constexpr bool nullable_callback<std::function<R(Args...)>> = true;
+
+} // namespace detail
+
 template <typename Vertex> struct vlist {
     struct write;
 
@@ -27,11 +41,30 @@ template <typename Vertex> struct vlist {
         {
             _target._vertices.push_back(std::move(v));
         }
-       /* void operator()(std::span<vertex_type const> vv) const
+
+        // bulk write, a single copy of the whole span
+        void operator()(std::span<vertex_type const> vv) const
         {
             _target._vertices.insert(
                 _target._vertices.end(), vv.begin(), vv.end());
-        }*/
+        }
+
+        // reserve makes room for n more vertices of this segment, growing
+        // geometrically so that a hint per segment stays amortized
+        void reserve(size_t n) const { _target.grow(n); }
+
+        // emplace appends n default constructed vertices and returns where
+        // they start, to be filled in place. The pointer is valid until the
+        // next write to the list.
+        auto emplace(size_t n) const -> vertex_type*
+            requires std::is_default_constructible_v<vertex_type>
+        {
+            auto& vv = _target._vertices;
+            auto const first = vv.size();
+            _target.grow(n);
+            vv.resize(first + n);
+            return vv.data() + first;
+        }
 
     private:
         vlist& _target;
@@ -42,20 +75,39 @@ template <typename Vertex> struct vlist {
         friend struct vlist;
     };
 
-    auto insert(std::function<void(write const&)> callback) -> segment_id
+    // insert adds the vertices written by callback as a new segment, it
+    // takes any callable so that lambdas are called without type erasure
+    template <typename F>
+        requires std::is_invocable_v<F&, write const&>
+    auto insert(F&& callback) -> segment_id
     {
-        if (!callback)
-            return segment_id(-1);
+        if constexpr (detail::nullable_callback<std::remove_cvref_t<F>>)
+            if (!callback)
+                return segment_id(-1);
         auto const first = _vertices.size();
-        auto ctx = write{this};
+        auto const ctx = write{this};
         callback(ctx);
         auto const last = _vertices.size();
         if (last <= first)
             return segment_id(-1);
         _dirty_flag = true;
         _segments.push_back(index_range{first, last});
-        return segment_id(_segments.size()-1);
-    };
+        return segment_id(_segments.size() - 1);
+    }
+
+    // insert adds the vertices as a new segment
+    auto insert(std::span<vertex_type const> vv) -> segment_id
+    {
+        return insert([vv](write const& w) { w(vv); });
+    }
+
+    // reserve is a capacity hint for the total number of vertices and
+    // segments, e.g. before building large polylines
+    void reserve(size_t vertices, size_t segments = 0)
+    {
+        _vertices.reserve(vertices);
+        _segments.reserve(segments);
+    }
 
     auto vertices() const { return std::span<vertex_type const>{_vertices}; }
     auto segments() const { return std::span<index_range const>{_segments}; }
@@ -72,6 +124,13 @@ protected:
     std::vector<vertex_type> _vertices;
     std::vector<index_range> _segments;
     bool _dirty_flag = false;
+
+    void grow(size_t n)
+    {
+        auto const need = _vertices.size() + n;
+        if (need > _vertices.capacity())
+            _vertices.reserve(std::max(need, 2 * _vertices.capacity()));
+    }
 };
 
-} // namespace gtx
\ No newline at end of file
+} // namespace gtx
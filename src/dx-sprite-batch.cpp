@@ -0,0 +1,90 @@
+#include "hlsl-sprite-batch.hpp"
+#include <gtx/shader/sprite-batch.hpp>
+
+#include <cstdio>
+
+namespace gtx::shdr {
+
+static void sh_error(dx::shader_error_info const& info)
+{
+    std::printf("shader compile (%s, %s): 0x%08X\n%s", info.entry_point,
+        info.target, info.hr, info.error_msg);
+    exit(-1);
+}
+
+inline static const dx::shader_source source = {
+    "sprite_batch", SPRITE_BATCH_SHADER_HLSL};
+
+inline static dx::shader_code vs_code = {
+    source, dx::macro("VERTEX_SHADER"), "vertex_shader", "vs_5_0", sh_error};
+inline static dx::shader_code ps_code = {
+    source, dx::macro("PIXEL_SHADER"), "pixel_shader", "ps_5_0", sh_error};
+
+sprite_batch::sprite_batch()
+    : vertex_shader{vs_code}
+    , pixel_shader{ps_code}
+    , layout{vs_code, // match instance
+          {
+              {"POS", 0, DXGI_FORMAT_R32G32_FLOAT, 0, offsetof(instance, pos),
+                  D3D11_INPUT_PER_INSTANCE_DATA, 1},
+              {"AXX", 0, DXGI_FORMAT_R32G32_FLOAT, 0, offsetof(instance, ax),
+                  D3D11_INPUT_PER_INSTANCE_DATA, 1},
+              {"AXY", 0, DXGI_FORMAT_R32G32_FLOAT, 0, offsetof(instance, ay),
+                  D3D11_INPUT_PER_INSTANCE_DATA, 1},
+              {"UV", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0,
+                  offsetof(instance, uv), D3D11_INPUT_PER_INSTANCE_DATA, 1},
+              {"CLR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0,
+                  offsetof(instance, clr), D3D11_INPUT_PER_INSTANCE_DATA, 1},
+              {"SAMPLING", 0, DXGI_FORMAT_R32_UINT, 0,
+                  offsetof(instance, mode), D3D11_INPUT_PER_INSTANCE_DATA,
+                  1},
+          }}
+    , ibuffer{}
+    , mvp{}
+    , sampler{D3D11_TEXTURE_ADDRESS_BORDER}
+{
+}
+
+void sprite_batch::setup_mvp(mat4x4 const& m) { mvp.update(m.elts); }
+
+void sprite_batch::render(order o)
+{
+    auto stream = prepare(o);
+    if (stream.empty())
+        return;
+
+    auto ctx = get_device().context;
+    if (!ctx)
+        throw dx::error("missing device");
+
+    auto restore_when_done = gtx::dx::save<   //
+        gtx::dx::state::vertex_shader,        //
+        gtx::dx::state::geometry_shader,      //
+        gtx::dx::state::pixel_shader,         //
+        gtx::dx::state::vs_constant_buffer_0, //
+        gtx::dx::state::vertex_buffer_0,      //
+        gtx::dx::state::input_layout,         //
+        gtx::dx::state::primitive_topology,   //
+        gtx::dx::state::ps_shader_resource_0, //
+        gtx::dx::state::ps_sampler_0          //
+        >{};
+
+    ibuffer.write(stream.data(), stream.size());
+
+    vertex_shader.bind();
+    dx::geometry_shader::unbind();
+    pixel_shader.bind();
+    layout.bind();
+    ibuffer.bind(0);
+    mvp.bind_vs(0);
+    sampler.bind_ps(0);
+
+    ctx->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+    for (auto const& r : runs_) {
+        auto srv = static_cast<ID3D11ShaderResourceView*>(r.native_handle);
+        ctx->PSSetShaderResources(0, 1, &srv);
+        ctx->DrawInstanced(4, r.count, 0, r.first);
+    }
+}
+
+} // namespace gtx::shdr
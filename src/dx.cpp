@@ -1,28 +1,37 @@
 #include <gtx/device.hpp>
 #include <gtx/dx/dx.hpp>
+#include <gtx/pixel/alpha.hpp>
+#include <gtx/tx-mipmap.hpp>
 #include <gtx/tx-page.hpp>
 
+#include "tx-blocks.hpp"
+
 #include <cstring>
 #include <d3d11.h>
 #include <d3dcompiler.h>
 
 namespace gtx {
 
-auto new_page(texture::texel_size const& sz,
-    bool wrap) -> std::shared_ptr<texture::page_data>;
+auto new_page(texture::texel_size const& sz, bool wrap, texture::format fmt,
+    uint32_t levels) -> std::shared_ptr<texture::page_data>;
 
 struct texture::page_data {
     page_data(page_data const&) = delete;
 
-    page_data(ID3D11ShaderResourceView* srv, texel_size const& sz, bool wrap)
+    page_data(ID3D11ShaderResourceView* srv, texel_size const& sz, bool wrap,
+        format fmt, uint32_t levels)
         : srv{srv}
         , sz{sz}
         , wrap{wrap}
+        , fmt{fmt}
+        , levels{levels}
     {
+        mips.setup(sz, levels);
     }
 
     ~page_data()
     {
+        registry.erase(handle);
         if (srv) {
             srv->Release();
             srv = nullptr;
@@ -33,11 +42,16 @@ private:
     ID3D11ShaderResourceView* srv = nullptr;
     texel_size sz = {0, 0};
     bool wrap = false;
+    format fmt = format::rgba8;
+    uint32_t levels = 1;
+    texture::mip_source mips;
+    page_handle handle;
 
     friend struct page;
     friend struct sprite;
-    friend auto new_page(texture::texel_size const& sz,
-        bool wrap) -> std::shared_ptr<texture::page_data>;
+    friend auto new_page(texture::texel_size const& sz, bool wrap,
+        texture::format fmt, uint32_t levels)
+        -> std::shared_ptr<texture::page_data>;
 };
 
 auto device_info::operator=(device_info const& rhs) -> device_info&
@@ -74,20 +88,58 @@ void set_device(device_info const& rhs) { d = rhs; }
 void set_frame(frame_info const&) {}
 auto get_device() -> device_info const& { return d; }
 
-auto new_page(texture::texel_size const& sz,
-    bool wrap) -> std::shared_ptr<texture::page_data>
+// dxgi_format returns DXGI_FORMAT_UNKNOWN for the etc2 formats
+static auto dxgi_format(texture::format fmt) -> DXGI_FORMAT
+{
+    switch (fmt) {
+    case texture::format::rgba8:
+        return DXGI_FORMAT_R8G8B8A8_UNORM;
+    case texture::format::bgra8:
+        return DXGI_FORMAT_B8G8R8A8_UNORM;
+    case texture::format::bc1:
+        return DXGI_FORMAT_BC1_UNORM;
+    case texture::format::bc3:
+        return DXGI_FORMAT_BC3_UNORM;
+    case texture::format::bc7:
+        return DXGI_FORMAT_BC7_UNORM;
+    case texture::format::r8:
+        return DXGI_FORMAT_R8_UNORM;
+    case texture::format::rg8:
+        return DXGI_FORMAT_R8G8_UNORM;
+    default:
+        return DXGI_FORMAT_UNKNOWN;
+    }
+}
+
+auto texture::supports(texture::format fmt) -> bool
+{
+    if (!is_compressed(fmt))
+        return true;
+    auto const f = dxgi_format(fmt);
+    auto support = UINT(0);
+    return f != DXGI_FORMAT_UNKNOWN && d.device &&
+           SUCCEEDED(d.device->CheckFormatSupport(f, &support)) &&
+           (support & D3D11_FORMAT_SUPPORT_TEXTURE2D);
+}
+
+auto new_page(texture::texel_size const& sz, bool wrap, texture::format fmt,
+    uint32_t levels) -> std::shared_ptr<texture::page_data>
 {
     if (!sz.w || !sz.h || !d.device)
         return {};
 
+    auto const dxgi = dxgi_format(fmt);
+    if (dxgi == DXGI_FORMAT_UNKNOWN)
+        return {};
+
     ID3D11ShaderResourceView* srv = nullptr;
     {
         auto desc = D3D11_TEXTURE2D_DESC{0};
         desc.Width = sz.w;
         desc.Height = sz.h;
-        desc.MipLevels = 1;
+        desc.MipLevels = levels;
         desc.ArraySize = 1;
-        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.Format = dxgi;
         desc.SampleDesc.Count = 1;
         desc.Usage = D3D11_USAGE_DEFAULT;
         desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
@@ -96,7 +148,7 @@ auto new_page(texture::texel_size const& sz,
         if (ID3D11Texture2D * pTexture;
             SUCCEEDED(d.device->CreateTexture2D(&desc, nullptr, &pTexture))) {
             auto srvDesc = D3D11_SHADER_RESOURCE_VIEW_DESC{};
-            srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+            srvDesc.Format = dxgi;
             srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
             srvDesc.Texture2D.MipLevels = desc.MipLevels;
             srvDesc.Texture2D.MostDetailedMip = 0;
@@ -108,13 +160,25 @@ auto new_page(texture::texel_size const& sz,
     if (!srv)
         return {};
 
-    auto p = std::make_shared<texture::page_data>(srv, sz, wrap);
+    auto p = std::make_shared<texture::page_data>(srv, sz, wrap, fmt, levels);
+    p->handle =
+        texture::registry.insert(p, (void*)intptr_t(srv), uint32_t(-1), sz);
     pages.push_back(p);
     return p;
 }
 
-auto texture::page::update(
-    texel_box const& box, uint32_t const* data, std::size_t data_stride) -> bool
+static void upload_blocks(ID3D11Resource* res, texture::format fmt,
+    uint32_t levels, uint32_t level, texture::texel_box const& b,
+    void const* blocks)
+{
+    auto const lbox = D3D11_BOX{b.x, b.y, 0, b.x + b.w, b.y + b.h, 1};
+    auto const [row_bytes, rows] = texture::detail::block_rows(fmt, b);
+    d.context->UpdateSubresource(res, D3D11CalcSubresource(level, 0, levels),
+        &lbox, blocks, UINT(row_bytes), UINT(row_bytes * rows));
+}
+
+auto texture::page::update(texel_box const& box, uint32_t const* data,
+    std::size_t data_stride, bool premultiply) -> bool
 {
     if (!d.context)
         return false;
@@ -126,9 +190,32 @@ auto texture::page::update(
         auto& pd = *pp;
         if (box.x + box.w > pd.sz.w || box.y + box.h > pd.sz.h)
             return false;
-        if (!pd.srv)
+        if (!pd.srv || is_plane(pd.fmt))
             return false;
 
+        if (is_compressed(pd.fmt)) {
+            ID3D11Resource* res;
+            pd.srv->GetResource(&res);
+            if (!res)
+                return false;
+            auto const ok = detail::encode_levels(pd.fmt, pd.sz, pd.mips,
+                box, data, data_stride, premultiply,
+                [&](uint32_t level, texel_box const& b, void const* blocks) {
+                    upload_blocks(res, pd.fmt, pd.levels, level, b, blocks);
+                });
+            res->Release();
+            return ok;
+        }
+
+        static std::vector<uint32_t> staging;
+        if (premultiply) {
+            staging.resize(size_t(box.w) * box.h);
+            pixel::premultiply(
+                data, data_stride, staging.data(), box.w, box.w, box.h);
+            data = staging.data();
+            data_stride = box.w;
+        }
+
         auto d3d_box =
             D3D11_BOX{box.x, box.y, 0, box.x + box.w, box.y + box.h, 1};
 
@@ -137,6 +224,23 @@ auto texture::page::update(
         if (res) {
             d.context->UpdateSubresource(res, 0, &d3d_box, data,
                 UINT(data_stride * sizeof(uint32_t)), 0);
+
+            if (pd.levels > 1) {
+                static texture::mip_chain chain;
+                pd.mips.update(box, data, data_stride, chain);
+                for (uint32_t i = 1; i < pd.levels; ++i) {
+                    auto const b = chain.box(i);
+                    if (!b.w || !b.h)
+                        continue;
+                    auto const level = chain.level(i);
+                    auto const lbox =
+                        D3D11_BOX{b.x, b.y, 0, b.x + b.w, b.y + b.h, 1};
+                    d.context->UpdateSubresource(res,
+                        D3D11CalcSubresource(i, 0, pd.levels), &lbox,
+                        level.data(), UINT(level.stride() * sizeof(uint32_t)),
+                        0);
+                }
+            }
             res->Release();
         }
         return true;
@@ -144,6 +248,55 @@ auto texture::page::update(
     return false;
 }
 
+auto texture::page::update_blocks(
+    texel_box const& box, void const* blocks, uint32_t level) -> bool
+{
+    if (!d.context || !blocks)
+        return false;
+
+    if (auto pp = pd_.lock()) {
+        auto& pd = *pp;
+        if (!pd.srv || !is_compressed(pd.fmt) || level >= pd.levels ||
+            !detail::block_aligned(box, mip_size(pd.sz, level)))
+            return false;
+
+        ID3D11Resource* res;
+        pd.srv->GetResource(&res);
+        if (!res)
+            return false;
+        upload_blocks(res, pd.fmt, pd.levels, level, box, blocks);
+        res->Release();
+        return true;
+    }
+    return false;
+}
+
+auto texture::page::update_plane(
+    texel_box const& box, void const* texels, std::size_t data_stride) -> bool
+{
+    if (!d.context || !texels || data_stride < size_t(box.w))
+        return false;
+
+    if (auto pp = pd_.lock()) {
+        auto& pd = *pp;
+        if (!pd.srv || !is_plane(pd.fmt) || box.x + box.w > pd.sz.w ||
+            box.y + box.h > pd.sz.h)
+            return false;
+
+        ID3D11Resource* res;
+        pd.srv->GetResource(&res);
+        if (!res)
+            return false;
+        auto const d3d_box =
+            D3D11_BOX{box.x, box.y, 0, box.x + box.w, box.y + box.h, 1};
+        d.context->UpdateSubresource(res, 0, &d3d_box, texels,
+            UINT(data_stride * texel_bytes(pd.fmt)), 0);
+        res->Release();
+        return true;
+    }
+    return false;
+}
+
 auto texture::page::native_handle() const -> void*
 {
     if (auto pp = pd_.lock())
@@ -151,6 +304,18 @@ auto texture::page::native_handle() const -> void*
     return nullptr;
 }
 
+auto texture::page::native_index() const -> uint32_t
+{
+    return uint32_t(-1); // no bindless mode
+}
+
+auto texture::page::handle() const -> page_handle
+{
+    if (auto pp = pd_.lock())
+        return pp->handle;
+    return {};
+}
+
 auto texture::page::get_size() const -> texel_size
 {
     if (auto pp = pd_.lock())
@@ -158,24 +323,34 @@ auto texture::page::get_size() const -> texel_size
     return {0, 0};
 }
 
-void texture::page::setup(texel_size const& sz, bool wrap)
+auto texture::page::get_format() const -> format
+{
+    if (auto pp = pd_.lock())
+        return pp->fmt;
+    return format::rgba8;
+}
+
+auto texture::page::get_levels() const -> uint32_t
+{
+    if (auto pp = pd_.lock())
+        return pp->levels;
+    return 0;
+}
+
+void texture::page::setup(
+    texel_size const& sz, bool wrap, format fmt, uint32_t levels)
 {
+    levels = is_plane(fmt) ? 1 : mip_levels(sz, levels);
     if (auto pp = pd_.lock()) {
-        if (pp->sz == sz && pp->wrap == wrap)
+        if (pp->sz == sz && pp->wrap == wrap && pp->fmt == fmt &&
+            pp->levels == levels)
             return;
     }
-    pd_ = new_page(sz, wrap);
+    pd_ = new_page(sz, wrap, fmt, levels);
 }
 
 void texture::page::release_all() { pages.clear(); }
 
-auto texture::sprite::native_handle() const -> void*
-{
-    if (auto pp = pd_.lock())
-        return (void*)intptr_t(pp->srv);
-    return nullptr;
-}
-
 dx::shader_code::shader_code(shader_source const& source,
     D3D_SHADER_MACRO const* macros, char const* entry_point, char const* target)
 {
@@ -275,4 +450,27 @@ void dx::input_layout::bind()
         d.context->IASetInputLayout(Get());
 }
 
+dx::sampler_state::sampler_state(D3D11_TEXTURE_ADDRESS_MODE address_mode)
+{
+    if (!d.device)
+        throw error("missing device");
+    auto desc = D3D11_SAMPLER_DESC{};
+    desc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    desc.AddressU = address_mode;
+    desc.AddressV = address_mode;
+    desc.AddressW = address_mode;
+    desc.MaxAnisotropy = 1;
+    desc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
+    desc.MinLOD = 0;
+    desc.MaxLOD = D3D11_FLOAT32_MAX;
+    check_hr(d.device->CreateSamplerState(&desc, GetAddressOf()));
+}
+
+void dx::sampler_state::bind_ps(unsigned slot)
+{
+    auto* ptr = Get();
+    if (d.context)
+        d.context->PSSetSamplers(slot, 1, &ptr);
+}
+
 } // namespace gtx
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include <gtx/executor.hpp>
+#include <gtx/image.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+namespace gtx {
+
+namespace {
+
+constexpr std::size_t min_block_size = std::size_t(64) << 10;
+
+// set while a thread runs tasks, nested parallel_for calls run inline
+thread_local bool in_task = false;
+
+} // namespace
+
+scratch_arena::~scratch_arena()
+{
+    for (auto& b : blocks_)
+        default_buffer_pool().release(b.data, b.size);
+}
+
+auto scratch_arena::allocate(std::size_t bytes, std::size_t align) -> void*
+{
+    for (; current_ < blocks_.size(); ++current_, offset_ = 0) {
+        auto const offset = (offset_ + align - 1) & ~(align - 1);
+        if (offset + bytes <= blocks_[current_].size) {
+            offset_ = offset + bytes;
+            return static_cast<std::byte*>(blocks_[current_].data) + offset;
+        }
+    }
+
+    auto size = std::max(bytes, min_block_size);
+    if (!blocks_.empty())
+        size = std::max(size, blocks_.back().size * 2);
+    size = buffer_pool::capacity(size);
+    blocks_.push_back({default_buffer_pool().acquire(size), size});
+    current_ = blocks_.size() - 1;
+    offset_ = bytes;
+    return blocks_.back().data;
+}
+
+struct executor::impl {
+    struct range {
+        std::mutex mutex;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    unsigned participants;
+    std::vector<std::thread> threads;
+    std::unique_ptr<range[]> ranges;
+    std::unique_ptr<scratch_arena[]> arenas;
+
+    std::mutex run_mutex; // one parallel_for at a time
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::uint64_t generation = 0;
+    unsigned busy = 0;
+    bool stop = false;
+
+    // the current job
+    task_fn fn = nullptr;
+    void* ctx = nullptr;
+    bool deterministic = false;
+    std::atomic<bool> failed = false;
+    std::exception_ptr error;
+
+    explicit impl(unsigned n)
+        : participants{n}
+        , ranges{new range[n]}
+        , arenas{new scratch_arena[n]}
+    {
+    }
+
+    auto pop(unsigned k, std::size_t& i) -> bool
+    {
+        auto& r = ranges[k];
+        auto lock = std::lock_guard{r.mutex};
+        if (r.begin == r.end)
+            return false;
+        i = r.begin++;
+        return true;
+    }
+
+    // steal moves the back half of the next non-empty range into k
+    auto steal(unsigned k) -> bool
+    {
+        for (unsigned j = 1; j < participants; ++j) {
+            auto& victim = ranges[(k + j) % participants];
+            auto begin = std::size_t(0);
+            auto end = std::size_t(0);
+            {
+                auto lock = std::lock_guard{victim.mutex};
+                auto const left = victim.end - victim.begin;
+                if (!left)
+                    continue;
+                end = victim.end;
+                begin = end - (left + 1) / 2;
+                victim.end = begin;
+            }
+            auto& own = ranges[k];
+            auto lock = std::lock_guard{own.mutex};
+            own.begin = begin;
+            own.end = end;
+            return true;
+        }
+        return false;
+    }
+
+    void execute(unsigned k, std::size_t i)
+    {
+        if (failed.load(std::memory_order_relaxed))
+            return;
+        auto& arena = arenas[k];
+        try {
+            fn(ctx, i, arena);
+        }
+        catch (...) {
+            auto lock = std::lock_guard{mutex};
+            if (!error)
+                error = std::current_exception();
+            failed = true;
+        }
+        arena.reset();
+    }
+
+    void work(unsigned k)
+    {
+        in_task = true;
+        auto i = std::size_t(0);
+        do {
+            while (pop(k, i))
+                execute(k, i);
+        } while (!deterministic && steal(k));
+        in_task = false;
+    }
+
+    void worker(unsigned k)
+    {
+        auto seen = std::uint64_t(0);
+        for (;;) {
+            {
+                auto lock = std::unique_lock{mutex};
+                wake.wait(lock, [&] { return stop || generation != seen; });
+                if (stop)
+                    return;
+                seen = generation;
+            }
+            work(k);
+            auto lock = std::lock_guard{mutex};
+            if (!--busy)
+                done.notify_one();
+        }
+    }
+};
+
+executor::executor(unsigned threads)
+{
+    auto const n =
+        threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    default_buffer_pool(); // constructed first so that it outlives the arenas
+    impl_ = std::make_unique<impl>(n);
+    impl_->threads.reserve(n - 1);
+    for (unsigned k = 1; k < n; ++k) {
+        try {
+            impl_->threads.emplace_back([this, k] { impl_->worker(k); });
+        }
+        catch (std::system_error const&) {
+            // carry on with the threads that could be started
+            impl_->participants = k;
+            break;
+        }
+    }
+}
+
+executor::~executor()
+{
+    {
+        auto lock = std::lock_guard{impl_->mutex};
+        impl_->stop = true;
+    }
+    impl_->wake.notify_all();
+    for (auto& t : impl_->threads)
+        t.join();
+}
+
+auto executor::concurrency() const -> unsigned { return impl_->participants; }
+
+void executor::run(std::size_t n, task_fn fn, void* ctx, bool deterministic)
+{
+    if (!n)
+        return;
+
+    if (in_task || impl_->participants == 1 || n == 1) {
+        // nested or trivial: run inline on a thread local arena, rewinding
+        // to the entry mark keeps the allocations of enclosing tasks
+        thread_local scratch_arena arena;
+        auto const m = arena.mark();
+        auto const nested = in_task;
+        in_task = true;
+        try {
+            for (std::size_t i = 0; i < n; ++i) {
+                fn(ctx, i, arena);
+                arena.rewind(m);
+            }
+        }
+        catch (...) {
+            arena.rewind(m);
+            in_task = nested;
+            throw;
+        }
+        in_task = nested;
+        return;
+    }
+
+    auto& s = *impl_;
+    auto run_lock = std::lock_guard{s.run_mutex};
+    for (unsigned k = 0; k < s.participants; ++k) {
+        auto lock = std::lock_guard{s.ranges[k].mutex};
+        s.ranges[k].begin = n * k / s.participants;
+        s.ranges[k].end = n * (k + 1) / s.participants;
+    }
+    {
+        auto lock = std::lock_guard{s.mutex};
+        s.fn = fn;
+        s.ctx = ctx;
+        s.deterministic = deterministic;
+        s.failed = false;
+        s.error = nullptr;
+        s.busy = s.participants - 1;
+        ++s.generation;
+    }
+    s.wake.notify_all();
+
+    s.work(0);
+
+    auto error = std::exception_ptr{};
+    {
+        auto lock = std::unique_lock{s.mutex};
+        s.done.wait(lock, [&] { return !s.busy; });
+        error = std::exchange(s.error, nullptr);
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+auto default_executor() -> executor&
+{
+    static executor ex;
+    return ex;
+}
+
+} // namespace gtx
@@ -0,0 +1,71 @@
+#include <gtx/shader/sprite-batch.hpp>
+
+#ifdef GTX_GLSL_320ES
+#include "glsl320es-sprite-batch.hpp"
+#else
+#include "glsl330-sprite-batch.hpp"
+#endif
+
+namespace gtx::shdr {
+
+using instance = sprite_batch::instance;
+
+static gl::vertex_attrib const attribs[] = {
+    {"in_pos", 2, gl::comp::f32_unorm, sizeof(instance),
+        offsetof(instance, pos), 1},
+    {"in_ax", 2, gl::comp::f32_unorm, sizeof(instance), offsetof(instance, ax),
+        1},
+    {"in_ay", 2, gl::comp::f32_unorm, sizeof(instance), offsetof(instance, ay),
+        1},
+    {"in_uv", 4, gl::comp::f32_unorm, sizeof(instance), offsetof(instance, uv),
+        1},
+    {"in_clr", 4, gl::comp::f32_norm, sizeof(instance),
+        offsetof(instance, clr), 1},
+    {"in_sampling", 1, gl::comp::u32, sizeof(instance),
+        offsetof(instance, mode), 1},
+};
+
+sprite_batch::sprite_batch()
+    : vertex_shader{GL_VERTEX_SHADER, SPRITE_BATCH_VERTEX_SHADER_GLSL}
+    , fragment_shader{GL_FRAGMENT_SHADER, SPRITE_BATCH_FRAGMENT_SHADER_GLSL}
+    , program{{vertex_shader, fragment_shader}}
+    , mvp{program, "mvp"}
+    , tex{program, "tex"}
+    , instance_buffer{}
+    , vertex_array{instance_buffer, program, attribs}
+{
+    auto restore_when_done = gl::save<gl::state::program>{};
+    program.use();
+    tex = 0;
+}
+
+void sprite_batch::setup_mvp(mat4x4 const& m)
+{
+    auto restore_when_done = gl::save<gl::state::program>{};
+    program.use();
+    mvp = m.elts;
+}
+
+void sprite_batch::render(order o)
+{
+    auto stream = prepare(o);
+    if (stream.empty())
+        return;
+
+    auto restore_when_done = gtx::gl::save<gtx::gl::state::array_buffer,
+        gtx::gl::state::vertex_array, gtx::gl::state::program,
+        gtx::gl::state::texture_2d>{};
+
+    program.use();
+    instance_buffer.data(stream.size_bytes(), stream.data(), GL_STREAM_DRAW);
+
+    for (auto const& r : runs_) {
+        // GL 3.3 and ES 3.2 have no base instance, rebase the attributes
+        vertex_array.setup(
+            instance_buffer, program, attribs, r.first * sizeof(instance));
+        glBindTexture(GL_TEXTURE_2D, GLuint(intptr_t(r.native_handle)));
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GLsizei(r.count));
+    }
+}
+
+} // namespace gtx::shdr
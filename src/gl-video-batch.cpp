@@ -0,0 +1,80 @@
+#include <gtx/shader/video-batch.hpp>
+
+#ifdef GTX_GLSL_320ES
+#include "glsl320es-video-batch.hpp"
+#else
+#include "glsl330-video-batch.hpp"
+#endif
+
+namespace gtx::shdr {
+
+using instance = video_batch::instance;
+
+static gl::vertex_attrib const attribs[] = {
+    {"in_pos", 2, gl::comp::f32_unorm, sizeof(instance),
+        offsetof(instance, pos), 1},
+    {"in_ax", 2, gl::comp::f32_unorm, sizeof(instance), offsetof(instance, ax),
+        1},
+    {"in_ay", 2, gl::comp::f32_unorm, sizeof(instance), offsetof(instance, ay),
+        1},
+    {"in_uv", 4, gl::comp::f32_unorm, sizeof(instance), offsetof(instance, uv),
+        1},
+    {"in_clr", 4, gl::comp::f32_norm, sizeof(instance),
+        offsetof(instance, clr), 1},
+    {"in_mode", 1, gl::comp::u32, sizeof(instance), offsetof(instance, mode),
+        1},
+};
+
+video_batch::video_batch()
+    : vertex_shader{GL_VERTEX_SHADER, VIDEO_BATCH_VERTEX_SHADER_GLSL}
+    , fragment_shader{GL_FRAGMENT_SHADER, VIDEO_BATCH_FRAGMENT_SHADER_GLSL}
+    , program{{vertex_shader, fragment_shader}}
+    , mvp{program, "mvp"}
+    , tex_y{program, "tex_y"}
+    , tex_u{program, "tex_u"}
+    , tex_v{program, "tex_v"}
+    , instance_buffer{}
+    , vertex_array{instance_buffer, program, attribs}
+{
+    auto restore_when_done = gl::save<gl::state::program>{};
+    program.use();
+    tex_y = 0;
+    tex_u = 1;
+    tex_v = 2;
+}
+
+void video_batch::setup_mvp(mat4x4 const& m)
+{
+    auto restore_when_done = gl::save<gl::state::program>{};
+    program.use();
+    mvp = m.elts;
+}
+
+void video_batch::render()
+{
+    auto stream = prepare();
+    if (stream.empty())
+        return;
+
+    auto restore_when_done = gtx::gl::save<gtx::gl::state::array_buffer,
+        gtx::gl::state::vertex_array, gtx::gl::state::program,
+        gtx::gl::state::texture_2d_1, gtx::gl::state::texture_2d_2,
+        gtx::gl::state::texture_2d>{};
+
+    program.use();
+    instance_buffer.data(stream.size_bytes(), stream.data(), GL_STREAM_DRAW);
+
+    for (auto const& r : runs_) {
+        // GL 3.3 and ES 3.2 have no base instance, rebase the attributes
+        vertex_array.setup(
+            instance_buffer, program, attribs, r.first * sizeof(instance));
+        // nv12 runs have the uv plane on units 1 and 2, unit 0 stays active
+        for (int i = 2; i >= 0; --i) {
+            glActiveTexture(GLenum(GL_TEXTURE0 + i));
+            glBindTexture(GL_TEXTURE_2D, GLuint(intptr_t(r.planes[i])));
+        }
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GLsizei(r.count));
+    }
+}
+
+} // namespace gtx::shdr
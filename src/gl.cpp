@@ -1,14 +1,38 @@
 #include <gtx/device.hpp>
+#include <gtx/pixel/alpha.hpp>
+#include <gtx/tx-mipmap.hpp>
 #include <gtx/tx-page.hpp>
 
+#include "tx-blocks.hpp"
+
 #include <glad/glad.h>
 
+#include <algorithm>
+
+// block compressed formats, not every glad profile carries the extensions
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+
 namespace gtx {
 
 struct texture::page_data {
     page_data(const page_data&) = delete;
     ~page_data()
     {
+        registry.erase(handle);
         if (name)
             glDeleteTextures(1, &name);
     }
@@ -16,11 +40,19 @@ struct texture::page_data {
     GLuint name = 0;
     texel_size sz = {0, 0};
     bool wrap = false;
-    page_data(GLuint name, const texel_size& sz, bool wrap)
+    format fmt = format::rgba8;
+    uint32_t levels = 1;
+    texture::mip_source mips;
+    page_handle handle;
+    page_data(GLuint name, const texel_size& sz, bool wrap, format fmt,
+        uint32_t levels)
         : name{name}
         , sz{sz}
         , wrap{wrap}
+        , fmt{fmt}
+        , levels{levels}
     {
+        mips.setup(sz, levels);
     }
     friend struct texture::page;
     friend struct texture::sprite;
@@ -38,8 +70,58 @@ void set_frame(frame_info const&)
     // noop for OpenGL
 }
 
-auto new_page(const texture::texel_size& sz,
-    bool wrap) -> std::shared_ptr<texture::page_data>
+// upload_format returns the client pixel layout for glTexSubImage2D, ES has
+// no GL_BGRA upload so bgra8 pages swap r and b when sampled instead
+static auto upload_format(texture::format fmt) -> GLenum
+{
+    if (fmt == texture::format::r8)
+        return GL_RED;
+    if (fmt == texture::format::rg8)
+        return GL_RG;
+#ifdef GTX_GLSL_320ES
+    return GL_RGBA;
+#else
+    return fmt == texture::format::bgra8 ? GL_BGRA : GL_RGBA;
+#endif
+}
+
+static auto internal_format(texture::format fmt) -> GLenum
+{
+    switch (fmt) {
+    case texture::format::bc1:
+        return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+    case texture::format::bc3:
+        return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case texture::format::bc7:
+        return GL_COMPRESSED_RGBA_BPTC_UNORM;
+    case texture::format::etc2_rgb8:
+        return GL_COMPRESSED_RGB8_ETC2;
+    case texture::format::etc2_rgba8:
+        return GL_COMPRESSED_RGBA8_ETC2_EAC;
+    case texture::format::r8:
+        return GL_R8;
+    case texture::format::rg8:
+        return GL_RG8;
+    default:
+        return GL_RGBA;
+    }
+}
+
+auto texture::supports(texture::format fmt) -> bool
+{
+    if (!is_compressed(fmt))
+        return true;
+    auto n = GLint(0);
+    glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &n);
+    auto formats = std::vector<GLint>(size_t(std::max(n, 0)));
+    if (!formats.empty())
+        glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+    return std::find(formats.begin(), formats.end(),
+               GLint(internal_format(fmt))) != formats.end();
+}
+
+auto new_page(const texture::texel_size& sz, bool wrap, texture::format fmt,
+    uint32_t levels) -> std::shared_ptr<texture::page_data>
 {
     if (!sz.w || !sz.h)
         return {};
@@ -61,42 +143,147 @@ auto new_page(const texture::texel_size& sz,
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
     }
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+        levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, GLsizei(sz.w), GLsizei(sz.h), 0,
-        GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, GLint(levels - 1));
+#ifdef GTX_GLSL_320ES
+    if (fmt == texture::format::bgra8) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+    }
+#endif
+    for (uint32_t i = 0; i < levels; ++i) {
+        auto const lsz = texture::mip_size(sz, i);
+        if (texture::is_compressed(fmt)) {
+            auto const [row_bytes, rows] =
+                texture::detail::block_rows(fmt, {0, 0, lsz.w, lsz.h});
+            glCompressedTexImage2D(GL_TEXTURE_2D, GLint(i),
+                internal_format(fmt), GLsizei(lsz.w), GLsizei(lsz.h), 0,
+                GLsizei(row_bytes * rows), nullptr);
+        }
+        else
+            glTexImage2D(GL_TEXTURE_2D, GLint(i), GLint(internal_format(fmt)),
+                GLsizei(lsz.w), GLsizei(lsz.h), 0, upload_format(fmt),
+                GL_UNSIGNED_BYTE, nullptr);
+    }
 
     if (glGetError()) {
         glDeleteTextures(1, &gln);
         return {};
     }
 
-    auto p = std::make_shared<texture::page_data>(gln, sz, wrap);
+    auto p = std::make_shared<texture::page_data>(gln, sz, wrap, fmt, levels);
+    p->handle =
+        texture::registry.insert(p, (void*)intptr_t(gln), uint32_t(-1), sz);
     pages.push_back(p);
     return p;
 }
 
+static void upload_blocks(texture::page_data const& pd, uint32_t level,
+    texture::texel_box const& b, void const* blocks)
+{
+    auto const [row_bytes, rows] = texture::detail::block_rows(pd.fmt, b);
+    glBindTexture(GL_TEXTURE_2D, pd.name);
+    glCompressedTexSubImage2D(GL_TEXTURE_2D, GLint(level), b.x, b.y, b.w, b.h,
+        internal_format(pd.fmt), GLsizei(row_bytes * rows), blocks);
+}
+
 auto texture::page::update(texture::texel_box const& box, const uint32_t* data,
-    size_t data_stride) -> bool
+    size_t data_stride, bool premultiply) -> bool
 {
     if (!data || data_stride < size_t(box.w))
         return false;
 
     if (auto pp = pd_.lock()) {
         auto& pd = *pp;
-        if (box.x + box.w > pd.sz.w || box.y + box.h > pd.sz.h)
+        if (box.x + box.w > pd.sz.w || box.y + box.h > pd.sz.h ||
+            is_plane(pd.fmt))
             return false;
 
+        if (is_compressed(pd.fmt))
+            return detail::encode_levels(pd.fmt, pd.sz, pd.mips, box, data,
+                data_stride, premultiply,
+                [&](uint32_t level, texel_box const& b, void const* blocks) {
+                    upload_blocks(pd, level, b, blocks);
+                });
+
+        static std::vector<uint32_t> staging;
+        if (premultiply) {
+            staging.resize(size_t(box.w) * box.h);
+            pixel::premultiply(
+                data, data_stride, staging.data(), box.w, box.w, box.h);
+            data = staging.data();
+            data_stride = box.w;
+        }
+
         glPixelStorei(GL_UNPACK_ROW_LENGTH, int(data_stride));
         glBindTexture(GL_TEXTURE_2D, pd.name);
-        glTexSubImage2D(GL_TEXTURE_2D, 0, box.x, box.y, box.w, box.h, GL_RGBA,
-            GL_UNSIGNED_BYTE, data);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, box.x, box.y, box.w, box.h,
+            upload_format(pd.fmt), GL_UNSIGNED_BYTE, data);
+
+        if (pd.levels > 1) {
+            static texture::mip_chain chain;
+            pd.mips.update(box, data, data_stride, chain);
+            for (uint32_t i = 1; i < pd.levels; ++i) {
+                auto const b = chain.box(i);
+                if (!b.w || !b.h)
+                    continue;
+                auto const level = chain.level(i);
+                glPixelStorei(GL_UNPACK_ROW_LENGTH, int(level.stride()));
+                glTexSubImage2D(GL_TEXTURE_2D, GLint(i), b.x, b.y, b.w, b.h,
+                    upload_format(pd.fmt), GL_UNSIGNED_BYTE, level.data());
+            }
+        }
         glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
         return true;
     }
     return false;
 }
 
+auto texture::page::update_blocks(
+    texture::texel_box const& box, void const* blocks, uint32_t level) -> bool
+{
+    if (!blocks)
+        return false;
+
+    if (auto pp = pd_.lock()) {
+        auto& pd = *pp;
+        if (!is_compressed(pd.fmt) || level >= pd.levels ||
+            !detail::block_aligned(box, mip_size(pd.sz, level)))
+            return false;
+        upload_blocks(pd, level, box, blocks);
+        return true;
+    }
+    return false;
+}
+
+auto texture::page::update_plane(
+    texture::texel_box const& box, void const* texels, size_t data_stride)
+    -> bool
+{
+    if (!texels || data_stride < size_t(box.w))
+        return false;
+
+    if (auto pp = pd_.lock()) {
+        auto& pd = *pp;
+        if (!is_plane(pd.fmt) || box.x + box.w > pd.sz.w ||
+            box.y + box.h > pd.sz.h)
+            return false;
+
+        // plane rows are not 4-byte aligned
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, int(data_stride));
+        glBindTexture(GL_TEXTURE_2D, pd.name);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, box.x, box.y, box.w, box.h,
+            upload_format(pd.fmt), GL_UNSIGNED_BYTE, texels);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        return true;
+    }
+    return false;
+}
+
 auto texture::page::native_handle() const -> void*
 {
     if (auto pp = pd_.lock())
@@ -104,6 +291,18 @@ auto texture::page::native_handle() const -> void*
     return nullptr;
 }
 
+auto texture::page::native_index() const -> uint32_t
+{
+    return uint32_t(-1); // no bindless mode
+}
+
+auto texture::page::handle() const -> texture::page_handle
+{
+    if (auto pp = pd_.lock())
+        return pp->handle;
+    return {};
+}
+
 auto texture::page::get_size() const -> texture::texel_size
 {
     if (auto pp = pd_.lock())
@@ -111,22 +310,32 @@ auto texture::page::get_size() const -> texture::texel_size
     return {0, 0};
 }
 
-void texture::page::setup(texture::texel_size const& sz, bool wrap)
+auto texture::page::get_format() const -> texture::format
 {
+    if (auto pp = pd_.lock())
+        return pp->fmt;
+    return format::rgba8;
+}
+
+auto texture::page::get_levels() const -> uint32_t
+{
+    if (auto pp = pd_.lock())
+        return pp->levels;
+    return 0;
+}
+
+void texture::page::setup(texture::texel_size const& sz, bool wrap,
+    texture::format fmt, uint32_t levels)
+{
+    levels = is_plane(fmt) ? 1 : mip_levels(sz, levels);
     if (auto pp = pd_.lock()) {
-        if (pp->sz == sz && pp->wrap == wrap)
+        if (pp->sz == sz && pp->wrap == wrap && pp->fmt == fmt &&
+            pp->levels == levels)
             return;
     }
-    pd_ = new_page(sz, wrap);
+    pd_ = new_page(sz, wrap, fmt, levels);
 }
 
 void texture::page::release_all() { pages.clear(); }
 
-auto texture::sprite::native_handle() const -> void*
-{
-    if (auto pp = pd_.lock())
-        return (void*)intptr_t(pp->name);
-    return nullptr;
-}
-
 } // namespace gtx
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+namespace gtx {
+
+constexpr char const* SPRITE_BATCH_VERTEX_SHADER_GLSL = R"(
+#version 320 es
+
+uniform mat4 mvp;
+
+// per-instance inputs
+in vec2 in_pos;
+in vec2 in_ax;
+in vec2 in_ay;
+in vec4 in_uv;
+in vec4 in_clr;
+in uint in_sampling;
+
+out vec2 frag_uv;
+out vec4 frag_clr;
+flat out uint frag_sampling;
+
+void main() {
+    // triangle strip corners: (0, 0), (1, 0), (0, 1), (1, 1)
+    vec2 t = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+    gl_Position = mvp * vec4(in_pos + t.x * in_ax + t.y * in_ay, 0.0, 1.0);
+    frag_uv = mix(in_uv.xy, in_uv.zw, t);
+    frag_clr = in_clr;
+    frag_sampling = in_sampling;
+}
+)";
+
+constexpr char const* SPRITE_BATCH_FRAGMENT_SHADER_GLSL = R"(
+#version 320 es
+
+precision mediump float;
+
+uniform sampler2D tex;
+
+in vec2 frag_uv;
+in vec4 frag_clr;
+flat in uint frag_sampling;
+out vec4 out_clr;
+
+void main() {
+    vec4 texel = texture(tex, frag_uv);
+    // sdf sampling: alpha is a distance field with the edge at 0.5, the
+    // edge is antialiased over one pixel
+    float d = texel.a;
+    float w = max(0.5 * length(vec2(dFdx(d), dFdy(d))), 1e-4);
+    vec4 sdf = vec4(1.0, 1.0, 1.0, smoothstep(0.5 - w, 0.5 + w, d));
+    out_clr = (frag_sampling == 1u ? sdf : texel) * frag_clr;
+}
+)";
+
+} // namespace gtx
@@ -0,0 +1,66 @@
+#pragma once
+
+namespace gtx {
+
+constexpr char const* VIDEO_BATCH_VERTEX_SHADER_GLSL = R"(
+#version 320 es
+
+uniform mat4 mvp;
+
+// per-instance inputs
+in vec2 in_pos;
+in vec2 in_ax;
+in vec2 in_ay;
+in vec4 in_uv;
+in vec4 in_clr;
+in uint in_mode;
+
+out vec2 frag_uv;
+out vec4 frag_clr;
+flat out uint frag_mode;
+
+void main() {
+    // triangle strip corners: (0, 0), (1, 0), (0, 1), (1, 1)
+    vec2 t = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+    gl_Position = mvp * vec4(in_pos + t.x * in_ax + t.y * in_ay, 0.0, 1.0);
+    frag_uv = mix(in_uv.xy, in_uv.zw, t);
+    frag_clr = in_clr;
+    frag_mode = in_mode;
+}
+)";
+
+constexpr char const* VIDEO_BATCH_FRAGMENT_SHADER_GLSL = R"(
+#version 320 es
+
+precision mediump float;
+
+uniform sampler2D tex_y;
+uniform sampler2D tex_u;
+uniform sampler2D tex_v;
+
+in vec2 frag_uv;
+in vec4 frag_clr;
+flat in uint frag_mode;
+out vec4 out_clr;
+
+void main() {
+    // mode bits: 1 nv12 (v is the g of the u plane), 2 bt709, 4 full range
+    float y = texture(tex_y, frag_uv).r;
+    vec2 c = texture(tex_u, frag_uv).rg;
+    float vr = texture(tex_v, frag_uv).r;
+    float v = (frag_mode & 1u) != 0u ? c.g : vr;
+    bool full = (frag_mode & 4u) != 0u;
+    vec2 k = (frag_mode & 2u) != 0u ? vec2(0.2126, 0.0722)
+                                    : vec2(0.299, 0.114);
+    float l = (y - (full ? 0.0 : 16.0 / 255.0)) * (full ? 1.0 : 255.0 / 219.0);
+    float cs = full ? 1.0 : 255.0 / 224.0;
+    float cb = (c.r - 128.0 / 255.0) * cs;
+    float cr = (v - 128.0 / 255.0) * cs;
+    float r = l + 2.0 * (1.0 - k.x) * cr;
+    float b = l + 2.0 * (1.0 - k.y) * cb;
+    float g = (l - k.x * r - k.y * b) / (1.0 - k.x - k.y);
+    out_clr = vec4(clamp(vec3(r, g, b), 0.0, 1.0), 1.0) * frag_clr;
+}
+)";
+
+} // namespace gtx
@@ -0,0 +1,23 @@
+#include <gtx/shader/glyph-run.hpp>
+
+namespace gtx::shdr {
+
+void glyph_run::add(std::span<uint32_t const> glyphs,
+    std::span<vec2<float> const> positions, vec4<float> const& clr,
+    float scale)
+{
+    auto const n = std::min(glyphs.size(), positions.size());
+    for (std::size_t i = 0; i < n; ++i) {
+        auto g = cache_.find(glyphs[i]);
+        if (g->empty)
+            continue;
+        auto const& box = g->spr.get_box();
+        auto const pos = vec2<float>{positions[i].x + g->left * scale,
+            positions[i].y + g->top * scale};
+        push(g->spr, pos, {float(box.w) * scale, 0.0f},
+            {0.0f, float(box.h) * scale}, clr,
+            g->sdf ? sampling::sdf : sampling::color);
+    }
+}
+
+} // namespace gtx::shdr
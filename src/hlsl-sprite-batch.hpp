@@ -0,0 +1,59 @@
+#pragma once
+
+namespace gtx {
+
+constexpr char const* SPRITE_BATCH_SHADER_HLSL = R"(
+cbuffer constants : register(b0)
+{
+    matrix mvp;
+};
+
+Texture2D tex : register(t0);
+SamplerState smp : register(s0);
+
+struct pixel {
+    float4 pos : SV_Position;
+    float2 uv : TEXCOORD;
+    float4 clr : RGBA_NORM;
+    nointerpolation uint sampling : SAMPLING;
+};
+
+#ifdef VERTEX_SHADER
+struct instance {
+    float2 pos : POS;
+    float2 ax : AXX;
+    float2 ay : AXY;
+    float4 uv : UV;
+    float4 clr : CLR;
+    uint sampling : SAMPLING;
+};
+
+pixel vertex_shader(instance i, uint id : SV_VertexID)
+{
+    // triangle strip corners: (0, 0), (1, 0), (0, 1), (1, 1)
+    float2 t = float2(id & 1, id >> 1);
+    pixel p;
+    p.pos = mul(mvp, float4(i.pos + t.x * i.ax + t.y * i.ay, 0, 1));
+    p.uv = lerp(i.uv.xy, i.uv.zw, t);
+    p.clr = i.clr;
+    p.sampling = i.sampling;
+    return p;
+}
+#endif
+
+#if defined(PIXEL_SHADER)
+float4 pixel_shader(pixel p) : SV_Target
+{
+    float4 texel = tex.Sample(smp, p.uv);
+    // sdf sampling: alpha is a distance field with the edge at 0.5, the
+    // edge is antialiased over one pixel
+    float d = texel.a;
+    float w = max(0.5 * length(float2(ddx(d), ddy(d))), 1e-4);
+    float4 sdf = float4(1, 1, 1, smoothstep(0.5 - w, 0.5 + w, d));
+    return (p.sampling == 1 ? sdf : texel) * p.clr;
+}
+#endif
+
+)";
+
+} // namespace gtx
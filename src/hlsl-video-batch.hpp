@@ -0,0 +1,70 @@
+#pragma once
+
+namespace gtx {
+
+constexpr char const* VIDEO_BATCH_SHADER_HLSL = R"(
+cbuffer constants : register(b0)
+{
+    matrix mvp;
+};
+
+Texture2D tex_y : register(t0);
+Texture2D tex_u : register(t1);
+Texture2D tex_v : register(t2);
+SamplerState smp : register(s0);
+
+struct pixel {
+    float4 pos : SV_Position;
+    float2 uv : TEXCOORD;
+    float4 clr : RGBA_NORM;
+    nointerpolation uint mode : MODE;
+};
+
+#ifdef VERTEX_SHADER
+struct instance {
+    float2 pos : POS;
+    float2 ax : AXX;
+    float2 ay : AXY;
+    float4 uv : UV;
+    float4 clr : CLR;
+    uint mode : MODE;
+};
+
+pixel vertex_shader(instance i, uint id : SV_VertexID)
+{
+    // triangle strip corners: (0, 0), (1, 0), (0, 1), (1, 1)
+    float2 t = float2(id & 1, id >> 1);
+    pixel p;
+    p.pos = mul(mvp, float4(i.pos + t.x * i.ax + t.y * i.ay, 0, 1));
+    p.uv = lerp(i.uv.xy, i.uv.zw, t);
+    p.clr = i.clr;
+    p.mode = i.mode;
+    return p;
+}
+#endif
+
+#if defined(PIXEL_SHADER)
+float4 pixel_shader(pixel p) : SV_Target
+{
+    // mode bits: 1 nv12 (v is the g of the u plane), 2 bt709, 4 full range
+    float y = tex_y.Sample(smp, p.uv).r;
+    float2 c = tex_u.Sample(smp, p.uv).rg;
+    float vr = tex_v.Sample(smp, p.uv).r;
+    float v = (p.mode & 1) != 0 ? c.g : vr;
+    bool full = (p.mode & 4) != 0;
+    float2 k = (p.mode & 2) != 0 ? float2(0.2126, 0.0722)
+                                 : float2(0.299, 0.114);
+    float l = (y - (full ? 0.0 : 16.0 / 255.0)) * (full ? 1.0 : 255.0 / 219.0);
+    float cs = full ? 1.0 : 255.0 / 224.0;
+    float cb = (c.r - 128.0 / 255.0) * cs;
+    float cr = (v - 128.0 / 255.0) * cs;
+    float r = l + 2.0 * (1.0 - k.x) * cr;
+    float b = l + 2.0 * (1.0 - k.y) * cb;
+    float g = (l - k.x * r - k.y * b) / (1.0 - k.x - k.y);
+    return float4(saturate(float3(r, g, b)), 1) * p.clr;
+}
+#endif
+
+)";
+
+} // namespace gtx
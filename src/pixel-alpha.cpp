@@ -0,0 +1,277 @@
+#include "simd.hpp"
+#include "strips.hpp"
+#include <gtx/pixel/alpha.hpp>
+
+#include <algorithm>
+
+namespace gtx::pixel {
+
+namespace {
+
+using row_fn = void (*)(uint32_t const* src, uint32_t* dst, std::size_t n);
+
+// div255 is exact for x in 0..65025: round(x / 255)
+constexpr auto div255(uint32_t x) -> uint32_t
+{
+    return (x + ((x + 128) >> 8) + 128) >> 8;
+}
+
+constexpr auto unpremul(uint32_t c, uint32_t a) -> uint32_t
+{
+    // the float formulation matches the vectorized kernels bit for bit
+    return uint32_t(std::min(float(c * 255) / float(a) + 0.5f, 255.0f));
+}
+
+void scalar_premultiply(uint32_t const* s, uint32_t* d, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        auto const v = s[i];
+        auto const a = v >> 24;
+        d[i] = (v & 0xff000000) | div255(((v >> 16) & 0xff) * a) << 16 |
+               div255(((v >> 8) & 0xff) * a) << 8 | div255((v & 0xff) * a);
+    }
+}
+
+void scalar_unpremultiply(uint32_t const* s, uint32_t* d, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        auto const v = s[i];
+        auto const a = v >> 24;
+        if (!a) {
+            d[i] = 0;
+            continue;
+        }
+        d[i] = (v & 0xff000000) | unpremul((v >> 16) & 0xff, a) << 16 |
+               unpremul((v >> 8) & 0xff, a) << 8 | unpremul(v & 0xff, a);
+    }
+}
+
+#if defined(GTX_SIMD_X86)
+
+// premultiply works on 16-bit lanes: c * a + 128, then (t * 257) >> 16
+// which is the exact rounded division by 255 for 16-bit t
+
+GTX_TARGET("sse4.1")
+inline auto sse41_premul_lanes(__m128i c) -> __m128i
+{
+    auto const a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, 0xff), 0xff);
+    auto const t = _mm_add_epi16(_mm_mullo_epi16(c, a), _mm_set1_epi16(128));
+    return _mm_mulhi_epu16(t, _mm_set1_epi16(257));
+}
+
+GTX_TARGET("sse4.1")
+void sse41_premultiply(uint32_t const* s, uint32_t* d, std::size_t n)
+{
+    auto const zero = _mm_setzero_si128();
+    auto const alpha = _mm_set1_epi32(int(0xff000000));
+    auto i = std::size_t(0);
+    for (; i + 4 <= n; i += 4) {
+        auto v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i));
+        auto lo = sse41_premul_lanes(_mm_unpacklo_epi8(v, zero));
+        auto hi = sse41_premul_lanes(_mm_unpackhi_epi8(v, zero));
+        auto p = _mm_blendv_epi8(_mm_packus_epi16(lo, hi), v, alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), p);
+    }
+    scalar_premultiply(s + i, d + i, n - i);
+}
+
+template <int Shift>
+GTX_TARGET("sse4.1")
+inline auto sse41_unpremul_channel(__m128i v, __m128 a) -> __m128i
+{
+    auto const c =
+        _mm_and_si128(_mm_srli_epi32(v, Shift), _mm_set1_epi32(255));
+    auto const q = _mm_div_ps(
+        _mm_cvtepi32_ps(_mm_mullo_epi32(c, _mm_set1_epi32(255))), a);
+    auto const r =
+        _mm_min_ps(_mm_add_ps(q, _mm_set1_ps(0.5f)), _mm_set1_ps(255.0f));
+    return _mm_slli_epi32(_mm_cvttps_epi32(r), Shift);
+}
+
+GTX_TARGET("sse4.1")
+void sse41_unpremultiply(uint32_t const* s, uint32_t* d, std::size_t n)
+{
+    auto i = std::size_t(0);
+    for (; i + 4 <= n; i += 4) {
+        auto v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i));
+        auto ai = _mm_srli_epi32(v, 24);
+        auto a = _mm_cvtepi32_ps(ai);
+        auto p = _mm_or_si128(
+            _mm_or_si128(_mm_and_si128(v, _mm_set1_epi32(int(0xff000000))),
+                sse41_unpremul_channel<16>(v, a)),
+            _mm_or_si128(sse41_unpremul_channel<8>(v, a),
+                sse41_unpremul_channel<0>(v, a)));
+        // fully transparent pixels are cleared
+        auto opaque = _mm_cmpgt_epi32(ai, _mm_setzero_si128());
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(d + i), _mm_and_si128(p, opaque));
+    }
+    scalar_unpremultiply(s + i, d + i, n - i);
+}
+
+GTX_TARGET("avx2")
+inline auto avx2_premul_lanes(__m256i c) -> __m256i
+{
+    auto const a =
+        _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(c, 0xff), 0xff);
+    auto const t =
+        _mm256_add_epi16(_mm256_mullo_epi16(c, a), _mm256_set1_epi16(128));
+    return _mm256_mulhi_epu16(t, _mm256_set1_epi16(257));
+}
+
+GTX_TARGET("avx2")
+void avx2_premultiply(uint32_t const* s, uint32_t* d, std::size_t n)
+{
+    auto const zero = _mm256_setzero_si256();
+    auto const alpha = _mm256_set1_epi32(int(0xff000000));
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        // unpack and pack both work within 128-bit lanes, so the pixel
+        // order is preserved without a permute
+        auto v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(s + i));
+        auto lo = avx2_premul_lanes(_mm256_unpacklo_epi8(v, zero));
+        auto hi = avx2_premul_lanes(_mm256_unpackhi_epi8(v, zero));
+        auto p = _mm256_blendv_epi8(_mm256_packus_epi16(lo, hi), v, alpha);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), p);
+    }
+    scalar_premultiply(s + i, d + i, n - i);
+}
+
+template <int Shift>
+GTX_TARGET("avx2")
+inline auto avx2_unpremul_channel(__m256i v, __m256 a) -> __m256i
+{
+    auto const c =
+        _mm256_and_si256(_mm256_srli_epi32(v, Shift), _mm256_set1_epi32(255));
+    auto const q = _mm256_div_ps(
+        _mm256_cvtepi32_ps(_mm256_mullo_epi32(c, _mm256_set1_epi32(255))), a);
+    auto const r = _mm256_min_ps(
+        _mm256_add_ps(q, _mm256_set1_ps(0.5f)), _mm256_set1_ps(255.0f));
+    return _mm256_slli_epi32(_mm256_cvttps_epi32(r), Shift);
+}
+
+GTX_TARGET("avx2")
+void avx2_unpremultiply(uint32_t const* s, uint32_t* d, std::size_t n)
+{
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(s + i));
+        auto ai = _mm256_srli_epi32(v, 24);
+        auto a = _mm256_cvtepi32_ps(ai);
+        auto p = _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_and_si256(v, _mm256_set1_epi32(int(0xff000000))),
+                avx2_unpremul_channel<16>(v, a)),
+            _mm256_or_si256(avx2_unpremul_channel<8>(v, a),
+                avx2_unpremul_channel<0>(v, a)));
+        auto opaque = _mm256_cmpgt_epi32(ai, _mm256_setzero_si256());
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(d + i), _mm256_and_si256(p, opaque));
+    }
+    scalar_unpremultiply(s + i, d + i, n - i);
+}
+
+#elif defined(GTX_SIMD_NEON)
+
+// vraddhn(t, vrshr(t, 8)) is the exact rounded division by 255
+inline auto neon_premul_channel(uint8x8_t c, uint8x8_t a) -> uint8x8_t
+{
+    auto const t = vmull_u8(c, a);
+    return vraddhn_u16(t, vrshrq_n_u16(t, 8));
+}
+
+void neon_premultiply(uint32_t const* s, uint32_t* d, std::size_t n)
+{
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto bgra = vld4_u8(reinterpret_cast<uint8_t const*>(s + i));
+        bgra.val[0] = neon_premul_channel(bgra.val[0], bgra.val[3]);
+        bgra.val[1] = neon_premul_channel(bgra.val[1], bgra.val[3]);
+        bgra.val[2] = neon_premul_channel(bgra.val[2], bgra.val[3]);
+        vst4_u8(reinterpret_cast<uint8_t*>(d + i), bgra);
+    }
+    scalar_premultiply(s + i, d + i, n - i);
+}
+
+#endif
+
+auto select_premultiply() -> row_fn
+{
+    switch (simd::active()) {
+#if defined(GTX_SIMD_X86)
+    case simd::isa::avx2:
+        return avx2_premultiply;
+    case simd::isa::sse41:
+        return sse41_premultiply;
+#elif defined(GTX_SIMD_NEON)
+    case simd::isa::neon:
+        return neon_premultiply;
+#endif
+    default:
+        return scalar_premultiply;
+    }
+}
+
+// unpremultiply has no NEON variant, 32-bit ARM has no vector division
+auto select_unpremultiply() -> row_fn
+{
+    switch (simd::active()) {
+#if defined(GTX_SIMD_X86)
+    case simd::isa::avx2:
+        return avx2_unpremultiply;
+    case simd::isa::sse41:
+        return sse41_unpremultiply;
+#endif
+    default:
+        return scalar_unpremultiply;
+    }
+}
+
+void apply(row_fn row, uint32_t const* src, std::size_t src_stride,
+    uint32_t* dst, std::size_t dst_stride, std::size_t w, std::size_t h)
+{
+    if (!w || !h || !src || !dst)
+        return;
+
+    detail::for_each_strip(surface<uint32_t>{dst, w, h, dst_stride},
+        detail::strip_pixels, nullptr,
+        [&](std::size_t y0, std::size_t y1, scratch_arena&) {
+            for (auto y = y0; y < y1; ++y)
+                row(src + y * src_stride, dst + y * dst_stride, w);
+        });
+}
+
+void apply(row_fn row, surface<nargb8888> const& src, surface<nargb8888>& dst)
+{
+    apply(row, reinterpret_cast<uint32_t const*>(src.data()), src.stride(),
+        reinterpret_cast<uint32_t*>(dst.data()), dst.stride(),
+        std::min(src.width(), dst.width()),
+        std::min(src.height(), dst.height()));
+}
+
+} // namespace
+
+void premultiply(surface<nargb8888>& s) { premultiply(s, s); }
+
+void premultiply(surface<nargb8888> const& src, surface<nargb8888>& dst)
+{
+    static auto const row = select_premultiply();
+    apply(row, src, dst);
+}
+
+void premultiply(uint32_t const* src, std::size_t src_stride, uint32_t* dst,
+    std::size_t dst_stride, std::size_t w, std::size_t h)
+{
+    static auto const row = select_premultiply();
+    apply(row, src, src_stride, dst, dst_stride, w, h);
+}
+
+void unpremultiply(surface<nargb8888>& s) { unpremultiply(s, s); }
+
+void unpremultiply(surface<nargb8888> const& src, surface<nargb8888>& dst)
+{
+    static auto const row = select_unpremultiply();
+    apply(row, src, dst);
+}
+
+} // namespace gtx::pixel
@@ -0,0 +1,558 @@
+#include "simd.hpp"
+#include "strips.hpp"
+#include <gtx/pixel/block.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace gtx::pixel {
+
+namespace {
+
+// block holds the 16 texels of a 4x4 block as r, g, b, a channel rows in
+// 0..255, channels are addressed from a first channel so that color (3),
+// rgba (4) and alpha (1) fits share the code
+struct block {
+    float c[4][16];
+};
+
+using rows = float const (*)[16];
+
+struct endpoints {
+    float e0[4];
+    float e1[4];
+};
+
+// projection maps a texel to its nearest level along e0 -> e1:
+// k = clamp(dot(x - e0, d) * s + 0.5, 0, levels)
+struct projection {
+    float e0[4];
+    float d[4];
+    float s;
+};
+
+using project_fn = void (*)(
+    rows px, projection const& p, std::size_t n, float levels, uint8_t* k);
+
+void scalar_project(
+    rows px, projection const& p, std::size_t n, float levels, uint8_t* k)
+{
+    for (std::size_t i = 0; i < 16; ++i) {
+        auto t = 0.0f;
+        for (std::size_t c = 0; c < n; ++c)
+            t += (px[c][i] - p.e0[c]) * p.d[c];
+        t = t * p.s + 0.5f;
+        k[i] = uint8_t(std::min(std::max(t, 0.0f), levels));
+    }
+}
+
+#if defined(GTX_SIMD_X86)
+
+GTX_TARGET("sse4.1")
+void sse41_project(
+    rows px, projection const& p, std::size_t n, float levels, uint8_t* k)
+{
+    __m128i q[4];
+    for (std::size_t j = 0; j < 4; ++j) {
+        auto t = _mm_setzero_ps();
+        for (std::size_t c = 0; c < n; ++c)
+            t = _mm_add_ps(t,
+                _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(px[c] + 4 * j),
+                               _mm_set1_ps(p.e0[c])),
+                    _mm_set1_ps(p.d[c])));
+        t = _mm_add_ps(_mm_mul_ps(t, _mm_set1_ps(p.s)), _mm_set1_ps(0.5f));
+        t = _mm_min_ps(_mm_max_ps(t, _mm_setzero_ps()), _mm_set1_ps(levels));
+        q[j] = _mm_cvttps_epi32(t);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(k),
+        _mm_packus_epi16(
+            _mm_packus_epi32(q[0], q[1]), _mm_packus_epi32(q[2], q[3])));
+}
+
+GTX_TARGET("avx2")
+void avx2_project(
+    rows px, projection const& p, std::size_t n, float levels, uint8_t* k)
+{
+    __m256i q[2];
+    for (std::size_t j = 0; j < 2; ++j) {
+        auto t = _mm256_setzero_ps();
+        for (std::size_t c = 0; c < n; ++c)
+            t = _mm256_add_ps(t,
+                _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(px[c] + 8 * j),
+                                  _mm256_set1_ps(p.e0[c])),
+                    _mm256_set1_ps(p.d[c])));
+        t = _mm256_add_ps(
+            _mm256_mul_ps(t, _mm256_set1_ps(p.s)), _mm256_set1_ps(0.5f));
+        t = _mm256_min_ps(
+            _mm256_max_ps(t, _mm256_setzero_ps()), _mm256_set1_ps(levels));
+        q[j] = _mm256_cvttps_epi32(t);
+    }
+    auto const lo = _mm_packus_epi32(
+        _mm256_castsi256_si128(q[0]), _mm256_extracti128_si256(q[0], 1));
+    auto const hi = _mm_packus_epi32(
+        _mm256_castsi256_si128(q[1]), _mm256_extracti128_si256(q[1], 1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(k), _mm_packus_epi16(lo, hi));
+}
+
+#elif defined(GTX_SIMD_NEON)
+
+void neon_project(
+    rows px, projection const& p, std::size_t n, float levels, uint8_t* k)
+{
+    uint16x4_t q[4];
+    for (std::size_t j = 0; j < 4; ++j) {
+        auto t = vdupq_n_f32(0.0f);
+        for (std::size_t c = 0; c < n; ++c)
+            t = vaddq_f32(t,
+                vmulq_f32(vsubq_f32(vld1q_f32(px[c] + 4 * j),
+                              vdupq_n_f32(p.e0[c])),
+                    vdupq_n_f32(p.d[c])));
+        t = vaddq_f32(vmulq_f32(t, vdupq_n_f32(p.s)), vdupq_n_f32(0.5f));
+        t = vminq_f32(vmaxq_f32(t, vdupq_n_f32(0.0f)), vdupq_n_f32(levels));
+        q[j] = vmovn_u32(vcvtq_u32_f32(t));
+    }
+    vst1q_u8(k, vcombine_u8(vmovn_u16(vcombine_u16(q[0], q[1])),
+                    vmovn_u16(vcombine_u16(q[2], q[3]))));
+}
+
+#endif
+
+auto select_project() -> project_fn
+{
+    switch (simd::active()) {
+#if defined(GTX_SIMD_X86)
+    case simd::isa::avx2:
+        return avx2_project;
+    case simd::isa::sse41:
+        return sse41_project;
+#elif defined(GTX_SIMD_NEON)
+    case simd::isa::neon:
+        return neon_project;
+#endif
+    default:
+        return scalar_project;
+    }
+}
+
+void project(rows px, endpoints const& e, std::size_t n, int levels,
+    uint8_t* k)
+{
+    static auto const fn = select_project();
+    auto p = projection{};
+    auto dd = 0.0f;
+    for (std::size_t c = 0; c < n; ++c) {
+        p.e0[c] = e.e0[c];
+        p.d[c] = e.e1[c] - e.e0[c];
+        dd += p.d[c] * p.d[c];
+    }
+    p.s = dd > 0 ? float(levels) / dd : 0.0f;
+    fn(px, p, n, float(levels), k);
+}
+
+// fit_axis places the endpoints at the extremes of the texels projected on
+// the principal axis of the weighted texels (power iteration on the
+// covariance matrix)
+void fit_axis(rows px, std::size_t n, float const* w, endpoints& e)
+{
+    float mean[4] = {};
+    auto sw = 0.0f;
+    for (std::size_t i = 0; i < 16; ++i) {
+        sw += w[i];
+        for (std::size_t c = 0; c < n; ++c)
+            mean[c] += w[i] * px[c][i];
+    }
+    if (sw <= 0) {
+        std::fill_n(e.e0, 4, 0.0f);
+        std::fill_n(e.e1, 4, 0.0f);
+        return;
+    }
+    for (std::size_t c = 0; c < n; ++c)
+        mean[c] /= sw;
+
+    float cov[4][4] = {};
+    for (std::size_t i = 0; i < 16; ++i)
+        for (std::size_t a = 0; a < n; ++a)
+            for (std::size_t b = a; b < n; ++b)
+                cov[a][b] +=
+                    w[i] * (px[a][i] - mean[a]) * (px[b][i] - mean[b]);
+    for (std::size_t a = 0; a < n; ++a)
+        for (std::size_t b = 0; b < a; ++b)
+            cov[a][b] = cov[b][a];
+
+    // start from the row of the largest variance, it is not orthogonal to
+    // the principal axis unless the covariance is zero
+    auto j = std::size_t(0);
+    for (std::size_t c = 1; c < n; ++c)
+        if (cov[c][c] > cov[j][j])
+            j = c;
+    float v[4] = {};
+    std::copy_n(cov[j], n, v);
+    for (int it = 0; it < 8; ++it) {
+        float u[4] = {};
+        auto len = 0.0f;
+        for (std::size_t a = 0; a < n; ++a) {
+            for (std::size_t b = 0; b < n; ++b)
+                u[a] += cov[a][b] * v[b];
+            len = std::max(len, std::abs(u[a]));
+        }
+        if (len <= 0)
+            break;
+        for (std::size_t a = 0; a < n; ++a)
+            v[a] = u[a] / len;
+    }
+    auto vv = 0.0f;
+    for (std::size_t c = 0; c < n; ++c)
+        vv += v[c] * v[c];
+
+    auto tmin = 0.0f;
+    auto tmax = 0.0f;
+    if (vv > 0) {
+        tmin = 1e30f;
+        tmax = -1e30f;
+        for (std::size_t i = 0; i < 16; ++i) {
+            if (w[i] <= 0)
+                continue;
+            auto t = 0.0f;
+            for (std::size_t c = 0; c < n; ++c)
+                t += (px[c][i] - mean[c]) * v[c];
+            tmin = std::min(tmin, t / vv);
+            tmax = std::max(tmax, t / vv);
+        }
+    }
+    for (std::size_t c = 0; c < n; ++c) {
+        e.e0[c] = std::clamp(mean[c] + v[c] * tmin, 0.0f, 255.0f);
+        e.e1[c] = std::clamp(mean[c] + v[c] * tmax, 0.0f, 255.0f);
+    }
+}
+
+// fit_least_squares moves the endpoints to minimize the error for fixed
+// indices, alpha[k] is the position of level k between e0 and e1
+auto fit_least_squares(rows px, std::size_t n, float const* w,
+    float const* alpha, uint8_t const* k, endpoints& e) -> bool
+{
+    auto aa = 0.0f;
+    auto ab = 0.0f;
+    auto bb = 0.0f;
+    float x0[4] = {};
+    float x1[4] = {};
+    for (std::size_t i = 0; i < 16; ++i) {
+        auto const b = alpha[k[i]];
+        auto const a = 1.0f - b;
+        aa += w[i] * a * a;
+        ab += w[i] * a * b;
+        bb += w[i] * b * b;
+        for (std::size_t c = 0; c < n; ++c) {
+            x0[c] += w[i] * a * px[c][i];
+            x1[c] += w[i] * b * px[c][i];
+        }
+    }
+    auto const det = aa * bb - ab * ab;
+    if (std::abs(det) < 1e-6f)
+        return false;
+    for (std::size_t c = 0; c < n; ++c) {
+        e.e0[c] = std::clamp((bb * x0[c] - ab * x1[c]) / det, 0.0f, 255.0f);
+        e.e1[c] = std::clamp((aa * x1[c] - ab * x0[c]) / det, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+auto error(rows px, std::size_t n, float const* w, float const* alpha,
+    uint8_t const* k, endpoints const& e) -> float
+{
+    auto err = 0.0f;
+    for (std::size_t i = 0; i < 16; ++i) {
+        auto const b = alpha[k[i]];
+        for (std::size_t c = 0; c < n; ++c) {
+            auto const d =
+                px[c][i] - ((1.0f - b) * e.e0[c] + b * e.e1[c]);
+            err += w[i] * d * d;
+        }
+    }
+    return err;
+}
+
+// fit finds quantized endpoints and indices for the texels: the principal
+// axis fit, then one least squares refinement which is kept if it lowers
+// the error. quantize snaps endpoints to representable values in place.
+template <typename Quantize>
+void fit(rows px, std::size_t n, float const* w, float const* alpha,
+    int levels, Quantize const& quantize, endpoints& e, uint8_t* k)
+{
+    fit_axis(px, n, w, e);
+    quantize(e);
+    project(px, e, n, levels, k);
+
+    auto r = e;
+    if (!fit_least_squares(px, n, w, alpha, k, r))
+        return;
+    quantize(r);
+    uint8_t rk[16];
+    project(px, r, n, levels, rk);
+    if (error(px, n, w, alpha, rk, r) < error(px, n, w, alpha, k, e)) {
+        e = r;
+        std::copy_n(rk, 16, k);
+    }
+}
+
+constexpr float alpha3[] = {0.0f, 0.5f, 1.0f};
+constexpr float alpha4[] = {0.0f, 1.0f / 3, 2.0f / 3, 1.0f};
+constexpr float alpha8[] = {
+    0.0f, 1.0f / 7, 2.0f / 7, 3.0f / 7, 4.0f / 7, 5.0f / 7, 6.0f / 7, 1.0f};
+
+constexpr float ones[16] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
+
+auto pack565(float const* c) -> uint16_t
+{
+    return uint16_t(int(c[0] * 31 / 255 + 0.5f) << 11 |
+                    int(c[1] * 63 / 255 + 0.5f) << 5 |
+                    int(c[2] * 31 / 255 + 0.5f));
+}
+
+void quantize565(endpoints& e)
+{
+    for (auto v : {e.e0, e.e1}) {
+        auto const q = pack565(v);
+        auto const r = q >> 11;
+        auto const g = (q >> 5) & 63;
+        auto const b = q & 31;
+        v[0] = float(r << 3 | r >> 2);
+        v[1] = float(g << 2 | g >> 4);
+        v[2] = float(b << 3 | b >> 2);
+    }
+}
+
+void put16(uint8_t* out, uint16_t v)
+{
+    out[0] = uint8_t(v);
+    out[1] = uint8_t(v >> 8);
+}
+
+// encode_color writes a bc1 color block, with alpha_mode texels with alpha
+// below 128 are made transparent (3-color mode)
+void encode_color(block const& b, bool alpha_mode, uint8_t* out)
+{
+    float w[16];
+    auto transparent = false;
+    for (std::size_t i = 0; i < 16; ++i) {
+        w[i] = !alpha_mode || b.c[3][i] >= 128 ? 1.0f : 0.0f;
+        transparent |= w[i] == 0;
+    }
+
+    auto const levels = transparent ? 2 : 3;
+    auto e = endpoints{};
+    uint8_t k[16];
+    fit(b.c, 3, w, transparent ? alpha3 : alpha4, levels, quantize565, e, k);
+
+    auto c0 = pack565(e.e0);
+    auto c1 = pack565(e.e1);
+    uint8_t map[4];
+    if (!transparent) {
+        // 4-color mode needs c0 > c1
+        if (c0 < c1) {
+            std::swap(c0, c1);
+            for (auto& v : k)
+                v = uint8_t(3 - v);
+        }
+        if (c0 == c1)
+            std::fill_n(k, 16, uint8_t(0));
+        map[0] = 0, map[1] = 2, map[2] = 3, map[3] = 1;
+    }
+    else {
+        // 3-color mode needs c0 <= c1, index 3 is transparent black
+        if (c0 > c1) {
+            std::swap(c0, c1);
+            for (auto& v : k)
+                v = uint8_t(2 - v);
+        }
+        map[0] = 0, map[1] = 2, map[2] = 1, map[3] = 3;
+        for (std::size_t i = 0; i < 16; ++i)
+            if (w[i] == 0)
+                k[i] = 3;
+    }
+
+    put16(out, c0);
+    put16(out + 2, c1);
+    auto bits = uint32_t(0);
+    for (std::size_t i = 0; i < 16; ++i)
+        bits |= uint32_t(map[k[i]]) << (2 * i);
+    std::memcpy(out + 4, &bits, 4);
+    if constexpr (std::endian::native == std::endian::big)
+        std::reverse(out + 4, out + 8);
+}
+
+void quantize8(endpoints& e)
+{
+    e.e0[0] = std::round(e.e0[0]);
+    e.e1[0] = std::round(e.e1[0]);
+}
+
+// encode_alpha writes a bc4 block for the alpha channel in 8-value mode
+void encode_alpha(block const& b, uint8_t* out)
+{
+    auto e = endpoints{};
+    uint8_t k[16];
+    fit(b.c + 3, 1, ones, alpha8, 7, quantize8, e, k);
+
+    auto a0 = uint8_t(e.e0[0]);
+    auto a1 = uint8_t(e.e1[0]);
+    if (a0 < a1) {
+        std::swap(a0, a1);
+        for (auto& v : k)
+            v = uint8_t(7 - v);
+    }
+    if (a0 == a1)
+        std::fill_n(k, 16, uint8_t(0));
+
+    out[0] = a0;
+    out[1] = a1;
+    auto bits = uint64_t(0);
+    for (std::size_t i = 0; i < 16; ++i) {
+        auto const idx = k[i] == 0 ? 0u : k[i] == 7 ? 1u : k[i] + 1u;
+        bits |= uint64_t(idx) << (3 * i);
+    }
+    for (std::size_t i = 0; i < 6; ++i)
+        out[2 + i] = uint8_t(bits >> (8 * i));
+}
+
+// bc7 mode 6: one subset, 7-bit rgba endpoints with a shared low bit per
+// endpoint, 4-bit indices
+constexpr int bc7_weights[16] = {
+    0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+constexpr auto bc7_alpha = [] {
+    auto a = std::array<float, 16>{};
+    for (std::size_t i = 0; i < 16; ++i)
+        a[i] = float(bc7_weights[i]) / 64;
+    return a;
+}();
+
+void quantize_bc7(endpoints& e)
+{
+    for (auto v : {e.e0, e.e1}) {
+        float best[4] = {};
+        auto best_err = 1e30f;
+        for (int p = 0; p < 2; ++p) {
+            float q[4];
+            auto err = 0.0f;
+            for (std::size_t c = 0; c < 4; ++c) {
+                auto const i = std::clamp(int((v[c] - p) / 2 + 0.5f), 0, 127);
+                q[c] = float(i << 1 | p);
+                err += (q[c] - v[c]) * (q[c] - v[c]);
+            }
+            if (err < best_err) {
+                best_err = err;
+                std::copy_n(q, 4, best);
+            }
+        }
+        std::copy_n(best, 4, v);
+    }
+}
+
+struct bit_writer {
+    uint8_t* out;
+    std::size_t pos = 0;
+
+    void put(uint32_t v, std::size_t bits)
+    {
+        for (std::size_t i = 0; i < bits; ++i, ++pos)
+            out[pos >> 3] |= uint8_t(((v >> i) & 1) << (pos & 7));
+    }
+};
+
+void encode_bc7(block const& b, uint8_t* out)
+{
+    auto e = endpoints{};
+    uint8_t k[16];
+    fit(b.c, 4, ones, bc7_alpha.data(), 15, quantize_bc7, e, k);
+
+    // the anchor index (texel 0) is stored without its high bit
+    if (k[0] >= 8) {
+        std::swap(e.e0, e.e1);
+        for (auto& v : k)
+            v = uint8_t(15 - v);
+    }
+
+    std::fill_n(out, 16, uint8_t(0));
+    auto w = bit_writer{out};
+    w.put(1 << 6, 7);
+    for (std::size_t c = 0; c < 4; ++c) {
+        w.put(uint32_t(e.e0[c]) >> 1, 7);
+        w.put(uint32_t(e.e1[c]) >> 1, 7);
+    }
+    w.put(uint32_t(e.e0[0]) & 1, 1);
+    w.put(uint32_t(e.e1[0]) & 1, 1);
+    w.put(k[0], 3);
+    for (std::size_t i = 1; i < 16; ++i)
+        w.put(k[i], 4);
+}
+
+void load(surface<nargb8888> const& s, std::size_t x0, std::size_t y0,
+    block& b)
+{
+    for (std::size_t y = 0; y < 4; ++y) {
+        auto const row =
+            s.data() + std::min(y0 + y, s.height() - 1) * s.stride();
+        for (std::size_t x = 0; x < 4; ++x) {
+            auto const p = row[std::min(x0 + x, s.width() - 1)];
+            b.c[0][4 * y + x] = p.r;
+            b.c[1][4 * y + x] = p.g;
+            b.c[2][4 * y + x] = p.b;
+            b.c[3][4 * y + x] = p.a;
+        }
+    }
+}
+
+void encode(block const& b, block_format f, uint8_t* out)
+{
+    switch (f) {
+    case block_format::bc1:
+        encode_color(b, true, out);
+        break;
+    case block_format::bc3:
+        encode_alpha(b, out);
+        encode_color(b, false, out + 8);
+        break;
+    case block_format::bc7:
+        encode_bc7(b, out);
+        break;
+    }
+}
+
+} // namespace
+
+void encode_blocks(surface<nargb8888> const& src, block_format f, void* dst,
+    std::size_t row_bytes, executor* exec)
+{
+    if (src.empty() || !dst)
+        return;
+
+    auto const bw = (src.width() + 3) / 4;
+    if (!row_bytes)
+        row_bytes = bw * block_bytes(f);
+
+    // strips of whole block rows
+    auto const rows = std::max<std::size_t>(
+        detail::strip_pixels / src.width() / 4 * 4, 4);
+    parallel_for_tiles(
+        src, {unsigned(src.width()), unsigned(rows)},
+        [&](surface<nargb8888> const& strip, pixel::coord origin,
+            scratch_arena&) {
+            auto b = block{};
+            for (std::size_t y = 0; y < strip.height(); y += 4) {
+                auto out = static_cast<uint8_t*>(dst) +
+                           (origin.y + y) / 4 * row_bytes;
+                for (std::size_t x = 0; x < strip.width(); x += 4) {
+                    load(strip, x, y, b);
+                    encode(b, f, out);
+                    out += block_bytes(f);
+                }
+            }
+        },
+        {false, exec});
+}
+
+} // namespace gtx::pixel
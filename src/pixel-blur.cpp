@@ -0,0 +1,423 @@
+#include "simd.hpp"
+#include <gtx/executor.hpp>
+#include <gtx/image.hpp>
+#include <gtx/pixel/blur.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace gtx::pixel {
+
+namespace {
+
+template <typename T> constexpr std::size_t channels = 4;
+template <> constexpr std::size_t channels<l8> = 1;
+template <> constexpr std::size_t channels<a8> = 1;
+
+// floats per column band of the passes and columns per transpose task
+constexpr std::size_t band_floats = 512;
+constexpr std::size_t transpose_columns = 32;
+
+// madd_fn adds w * in to out, slide_fn moves a box window (acc += add -
+// sub) and writes acc * s to out, pack_fn rounds and clamps to bytes
+using madd_fn = void (*)(float* out, float const* in, float w, std::size_t n);
+using slide_fn = void (*)(float* acc, float const* add, float const* sub,
+    float* out, float s, std::size_t n);
+using pack_fn = void (*)(float const* in, uint8_t* out, std::size_t n);
+
+void scalar_madd(float* out, float const* in, float w, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        out[i] += w * in[i];
+}
+
+void scalar_slide(float* acc, float const* add, float const* sub, float* out,
+    float s, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        acc[i] += add[i] - sub[i];
+        out[i] = acc[i] * s;
+    }
+}
+
+inline void pack_tail(
+    float const* in, uint8_t* out, std::size_t i, std::size_t n)
+{
+    for (; i < n; ++i)
+        out[i] = uint8_t(std::clamp(std::nearbyint(in[i]), 0.0f, 255.0f));
+}
+
+void scalar_pack(float const* in, uint8_t* out, std::size_t n)
+{
+    pack_tail(in, out, 0, n);
+}
+
+#if defined(GTX_SIMD_X86)
+
+GTX_TARGET("sse4.1")
+void sse41_madd(float* out, float const* in, float w, std::size_t n)
+{
+    auto const vw = _mm_set1_ps(w);
+    auto i = std::size_t(0);
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i),
+                                   _mm_mul_ps(vw, _mm_loadu_ps(in + i))));
+    scalar_madd(out + i, in + i, w, n - i);
+}
+
+GTX_TARGET("sse4.1")
+void sse41_slide(float* acc, float const* add, float const* sub, float* out,
+    float s, std::size_t n)
+{
+    auto const vs = _mm_set1_ps(s);
+    auto i = std::size_t(0);
+    for (; i + 4 <= n; i += 4) {
+        auto const d =
+            _mm_sub_ps(_mm_loadu_ps(add + i), _mm_loadu_ps(sub + i));
+        auto const a = _mm_add_ps(_mm_loadu_ps(acc + i), d);
+        _mm_storeu_ps(acc + i, a);
+        _mm_storeu_ps(out + i, _mm_mul_ps(a, vs));
+    }
+    scalar_slide(acc + i, add + i, sub + i, out + i, s, n - i);
+}
+
+GTX_TARGET("sse4.1")
+void sse41_pack(float const* in, uint8_t* out, std::size_t n)
+{
+    auto i = std::size_t(0);
+    for (; i + 16 <= n; i += 16) {
+        auto const a = _mm_cvtps_epi32(_mm_loadu_ps(in + i));
+        auto const b = _mm_cvtps_epi32(_mm_loadu_ps(in + i + 4));
+        auto const c = _mm_cvtps_epi32(_mm_loadu_ps(in + i + 8));
+        auto const d = _mm_cvtps_epi32(_mm_loadu_ps(in + i + 12));
+        auto const p =
+            _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), p);
+    }
+    pack_tail(in, out, i, n);
+}
+
+GTX_TARGET("avx2")
+void avx2_madd(float* out, float const* in, float w, std::size_t n)
+{
+    auto const vw = _mm256_set1_ps(w);
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(out + i,
+            _mm256_add_ps(_mm256_loadu_ps(out + i),
+                _mm256_mul_ps(vw, _mm256_loadu_ps(in + i))));
+    scalar_madd(out + i, in + i, w, n - i);
+}
+
+GTX_TARGET("avx2")
+void avx2_slide(float* acc, float const* add, float const* sub, float* out,
+    float s, std::size_t n)
+{
+    auto const vs = _mm256_set1_ps(s);
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto const d =
+            _mm256_sub_ps(_mm256_loadu_ps(add + i), _mm256_loadu_ps(sub + i));
+        auto const a = _mm256_add_ps(_mm256_loadu_ps(acc + i), d);
+        _mm256_storeu_ps(acc + i, a);
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(a, vs));
+    }
+    scalar_slide(acc + i, add + i, sub + i, out + i, s, n - i);
+}
+
+// the lane-wise packs interleave the 128-bit halves, the permute puts the
+// four groups back in order
+GTX_TARGET("avx2")
+void avx2_pack(float const* in, uint8_t* out, std::size_t n)
+{
+    auto i = std::size_t(0);
+    for (; i + 32 <= n; i += 32) {
+        auto const a = _mm256_cvtps_epi32(_mm256_loadu_ps(in + i));
+        auto const b = _mm256_cvtps_epi32(_mm256_loadu_ps(in + i + 8));
+        auto const c = _mm256_cvtps_epi32(_mm256_loadu_ps(in + i + 16));
+        auto const d = _mm256_cvtps_epi32(_mm256_loadu_ps(in + i + 24));
+        auto const p = _mm256_packus_epi16(
+            _mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+            _mm256_permutevar8x32_epi32(
+                p, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)));
+    }
+    pack_tail(in, out, i, n);
+}
+
+#elif defined(GTX_SIMD_NEON)
+
+void neon_madd(float* out, float const* in, float w, std::size_t n)
+{
+    auto i = std::size_t(0);
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32(
+            out + i, vmlaq_n_f32(vld1q_f32(out + i), vld1q_f32(in + i), w));
+    scalar_madd(out + i, in + i, w, n - i);
+}
+
+void neon_slide(float* acc, float const* add, float const* sub, float* out,
+    float s, std::size_t n)
+{
+    auto i = std::size_t(0);
+    for (; i + 4 <= n; i += 4) {
+        auto const d = vsubq_f32(vld1q_f32(add + i), vld1q_f32(sub + i));
+        auto const a = vaddq_f32(vld1q_f32(acc + i), d);
+        vst1q_f32(acc + i, a);
+        vst1q_f32(out + i, vmulq_n_f32(a, s));
+    }
+    scalar_slide(acc + i, add + i, sub + i, out + i, s, n - i);
+}
+
+// rounds half up where the scalar tail rounds half to even
+void neon_pack(float const* in, uint8_t* out, std::size_t n)
+{
+    auto const pack4 = [](float32x4_t v) {
+        v = vminq_f32(vmaxq_f32(v, vdupq_n_f32(0.0f)), vdupq_n_f32(255.0f));
+        return vmovn_u32(vcvtq_u32_f32(vaddq_f32(v, vdupq_n_f32(0.5f))));
+    };
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto const p = vcombine_u16(
+            pack4(vld1q_f32(in + i)), pack4(vld1q_f32(in + i + 4)));
+        vst1_u8(out + i, vmovn_u16(p));
+    }
+    pack_tail(in, out, i, n);
+}
+
+#endif
+
+struct kernels {
+    madd_fn madd;
+    slide_fn slide;
+    pack_fn pack;
+};
+
+auto select_kernels() -> kernels
+{
+    switch (simd::active()) {
+#if defined(GTX_SIMD_X86)
+    case simd::isa::avx2:
+        return {avx2_madd, avx2_slide, avx2_pack};
+    case simd::isa::sse41:
+        return {sse41_madd, sse41_slide, sse41_pack};
+#elif defined(GTX_SIMD_NEON)
+    case simd::isa::neon:
+        return {neon_madd, neon_slide, neon_pack};
+#endif
+    default:
+        return {scalar_madd, scalar_slide, scalar_pack};
+    }
+}
+
+auto active_kernels() -> kernels const&
+{
+    static auto const k = select_kernels();
+    return k;
+}
+
+// plan holds the passes run along each axis: either one convolution with
+// taps (2 * radius + 1 weights) or box passes of the given radii
+struct plan {
+    std::vector<float> taps;
+    std::vector<int> boxes;
+
+    auto passes() const -> std::size_t
+    {
+        return boxes.size() + (taps.empty() ? 0 : 1);
+    }
+};
+
+auto make_plan(blur_options const& opts) -> plan
+{
+    auto p = plan{};
+    auto const radius = std::max(opts.radius, 0.0f);
+    if (opts.filter == blur_filter::box) {
+        if (auto const r = int(std::lround(radius)))
+            p.boxes.push_back(r);
+        return p;
+    }
+
+    auto const sigma = radius / 2.0f;
+    if (sigma < 0.25f)
+        return p;
+    if (sigma < 2.0f) {
+        auto const r = int(std::ceil(3.0f * sigma));
+        auto sum = 0.0f;
+        for (int i = -r; i <= r; ++i)
+            sum += p.taps.emplace_back(
+                std::exp(-float(i * i) / (2.0f * sigma * sigma)));
+        for (auto& t : p.taps)
+            t /= sum;
+        return p;
+    }
+
+    // three boxes of widths wl or wl + 2 whose variances add up to sigma^2
+    // (Kovesi, "Fast almost-Gaussian filtering")
+    auto const var = double(sigma) * sigma;
+    auto wl = int(std::floor(std::sqrt(4.0 * var + 1.0)));
+    if (wl % 2 == 0)
+        --wl;
+    auto const m =
+        std::lround((12.0 * var - 3.0 * wl * wl - 12.0 * wl - 9.0) /
+                    (-4.0 * wl - 4.0));
+    for (int i = 0; i < 3; ++i)
+        p.boxes.push_back(((i < m ? wl : wl + 2) - 1) / 2);
+    return p;
+}
+
+// plane is a grid of floats, rows stride apart
+struct plane {
+    float* data;
+    std::size_t stride;
+    auto row(std::size_t y) const { return data + y * stride; }
+};
+
+// run_passes filters the columns [c0, c1) of a along its rows, the passes
+// alternate between a and b so the result ends up in b after an odd
+// number of passes (see plan::passes)
+void run_passes(plane a, plane b, std::size_t rows, std::size_t c0,
+    std::size_t c1, plan const& p, scratch_arena& arena)
+{
+    auto const& k = active_kernels();
+    auto const n = c1 - c0;
+    auto const zero = arena.allocate_array<float>(n).data();
+    auto const acc = arena.allocate_array<float>(n).data();
+    std::fill_n(zero, n, 0.0f);
+
+    auto in = a;
+    auto out = b;
+    if (!p.taps.empty()) {
+        auto const r = std::ptrdiff_t(p.taps.size() / 2);
+        auto const last_row = std::ptrdiff_t(rows) - 1;
+        for (std::size_t y = 0; y < rows; ++y) {
+            auto const o = out.row(y) + c0;
+            auto const yi = std::ptrdiff_t(y);
+            std::fill_n(o, n, 0.0f);
+            for (auto j = std::max(yi - r, std::ptrdiff_t(0));
+                 j <= std::min(yi + r, last_row); ++j)
+                k.madd(o, in.row(std::size_t(j)) + c0, p.taps[j - yi + r], n);
+        }
+        std::swap(in, out);
+    }
+    for (auto const r : p.boxes) {
+        // the window of row y is rows y - r to y + r, rows outside are zero
+        auto const rr = std::size_t(r);
+        auto const s = 1.0f / float(2 * r + 1);
+        std::fill_n(acc, n, 0.0f);
+        for (std::size_t y = 0; y < std::min(rr, rows); ++y)
+            k.madd(acc, in.row(y) + c0, 1.0f, n);
+        for (std::size_t y = 0; y < rows; ++y) {
+            auto const add = y + rr < rows ? in.row(y + rr) + c0 : zero;
+            auto const sub = y > rr ? in.row(y - rr - 1) + c0 : zero;
+            k.slide(acc, add, sub, out.row(y) + c0, s, n);
+        }
+        std::swap(in, out);
+    }
+}
+
+// transpose copies the C float units of the columns [x0, x1) of the h rows
+// of in to the rows [x0, x1) of out
+template <std::size_t C>
+void transpose(plane in, plane out, std::size_t x0, std::size_t x1,
+    std::size_t h)
+{
+    for (std::size_t y = 0; y < h; ++y) {
+        auto const src = in.row(y);
+        for (auto x = x0; x < x1; ++x)
+            std::copy_n(src + x * C, C, out.row(x) + y * C);
+    }
+}
+
+// bands runs fn(c0, c1, arena) on column bands of n floats
+template <typename Fn>
+void bands(executor& ex, std::size_t n, Fn const& fn)
+{
+    ex.parallel_for((n + band_floats - 1) / band_floats,
+        [&](std::size_t t, scratch_arena& arena) {
+            auto const c0 = t * band_floats;
+            auto const mark = arena.mark();
+            fn(c0, std::min(c0 + band_floats, n), arena);
+            arena.rewind(mark);
+        });
+}
+
+template <typename Fn>
+void column_blocks(executor& ex, std::size_t w, Fn const& fn)
+{
+    ex.parallel_for((w + transpose_columns - 1) / transpose_columns,
+        [&](std::size_t t, scratch_arena&) {
+            auto const x0 = t * transpose_columns;
+            fn(x0, std::min(x0 + transpose_columns, w));
+        });
+}
+
+} // namespace
+
+template <typename T>
+void blur(surface<T> const& src, surface<T>& dst, blur_options const& opts)
+{
+    constexpr auto C = channels<T>;
+    static_assert(sizeof(T) == C);
+
+    auto const w = std::min(src.width(), dst.width());
+    auto const h = std::min(src.height(), dst.height());
+    if (!w || !h || src.empty() || dst.empty())
+        return;
+
+    auto const p = make_plan(opts);
+    auto& ex = opts.exec ? *opts.exec : default_executor();
+    auto const& k = active_kernels();
+    auto const bytes = [](surface<T> const& s, std::size_t y) {
+        return reinterpret_cast<uint8_t*>(s.data() + y * s.stride());
+    };
+
+    // rows are filtered as the columns of the transposed image, so both
+    // axes run the same column passes over contiguous bands
+    auto t0 = image<float>(h * C, w);
+    auto t1 = image<float>(h * C, w);
+    column_blocks(ex, w, [&](std::size_t x0, std::size_t x1) {
+        for (std::size_t y = 0; y < h; ++y) {
+            auto const s = bytes(src, y);
+            for (auto x = x0; x < x1; ++x)
+                for (std::size_t c = 0; c < C; ++c)
+                    t0.row(x)[y * C + c] = float(s[x * C + c]);
+        }
+    });
+    auto const odd = p.passes() % 2 != 0;
+    auto const a0 = plane{t0.data(), t0.stride()};
+    auto const a1 = plane{t1.data(), t1.stride()};
+    bands(ex, h * C, [&](std::size_t c0, std::size_t c1, scratch_arena& a) {
+        run_passes(a0, a1, w, c0, c1, p, a);
+    });
+
+    auto n0 = image<float>(w * C, h);
+    auto n1 = image<float>(w * C, h);
+    auto const d0 = plane{n0.data(), n0.stride()};
+    auto const d1 = plane{n1.data(), n1.stride()};
+    column_blocks(ex, h, [&](std::size_t y0, std::size_t y1) {
+        transpose<C>(odd ? a1 : a0, d0, y0, y1, w);
+    });
+    t0.reset();
+    t1.reset();
+
+    auto const down = odd ? d1 : d0;
+    bands(ex, w * C, [&](std::size_t c0, std::size_t c1, scratch_arena& a) {
+        run_passes(d0, d1, h, c0, c1, p, a);
+        for (std::size_t y = 0; y < h; ++y)
+            k.pack(down.row(y) + c0, bytes(dst, y) + c0, c1 - c0);
+    });
+}
+
+#define GTX_BLUR(T)                                                            \
+    template void blur(surface<T> const&, surface<T>&, blur_options const&);
+
+GTX_BLUR(nargb8888)
+GTX_BLUR(xrgb8888)
+GTX_BLUR(l8)
+GTX_BLUR(a8)
+
+#undef GTX_BLUR
+
+} // namespace gtx::pixel
@@ -0,0 +1,449 @@
+#include "simd.hpp"
+#include "strips.hpp"
+#include <gtx/pixel/color.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace gtx::pixel {
+
+namespace {
+
+// the tables are 32-bit wide for the gathers, narrow has the 8-bit tables
+// again for the byte table lookups
+struct srgb_tables {
+    uint32_t decode8[256];   // sRGB to 8-bit linear
+    uint32_t encode8[256];   // 8-bit linear to sRGB
+    uint32_t decode16[256];  // sRGB to 16-bit linear
+    uint32_t encode16[4096]; // 16-bit linear >> 4 to sRGB
+    uint8_t narrow_decode8[256];
+    uint8_t narrow_encode8[256];
+
+    static auto decode(double c) -> double
+    {
+        return c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+    }
+
+    static auto encode(double l) -> double
+    {
+        return l <= 0.0031308 ? l * 12.92
+                              : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+    }
+
+    srgb_tables()
+    {
+        for (int i = 0; i < 256; ++i) {
+            auto const l = decode(i / 255.0);
+            decode8[i] = uint32_t(l * 255.0 + 0.5);
+            decode16[i] = uint32_t(l * 65535.0 + 0.5);
+            encode8[i] = uint32_t(encode(i / 255.0) * 255.0 + 0.5);
+            narrow_decode8[i] = uint8_t(decode8[i]);
+            narrow_encode8[i] = uint8_t(encode8[i]);
+        }
+        // each entry covers 16 values, sampled at their middle
+        for (int i = 0; i < 4096; ++i)
+            encode16[i] = uint32_t(
+                encode(std::min((i * 16 + 8) / 65535.0, 1.0)) * 255.0 + 0.5);
+    }
+};
+
+auto tables() -> srgb_tables const&
+{
+    static srgb_tables const t;
+    return t;
+}
+
+// lut8_fn maps the color channels of n nargb8888 pixels through a 256
+// entry table (wide and narrow copies), widen_fn maps them through a
+// 16-bit table into linear16, narrow_fn maps linear16 through a 4096 entry
+// table, map_fn maps n scalars through map with the index
+// clamp((v - lo) * scale + 0.5, 0, last)
+using lut8_fn = void (*)(uint32_t const* src, uint32_t* dst, std::size_t n,
+    uint32_t const* wide, uint8_t const* narrow);
+using widen_fn = void (*)(uint32_t const* src, linear16* dst, std::size_t n,
+    uint32_t const* table);
+using narrow_fn = void (*)(linear16 const* src, uint32_t* dst, std::size_t n,
+    uint32_t const* table);
+using map_fn = void (*)(float const* src, uint32_t* dst, std::size_t n,
+    float lo, float scale, uint32_t const* map, uint32_t last);
+
+void scalar_lut8(uint32_t const* src, uint32_t* dst, std::size_t n,
+    uint32_t const* wide, uint8_t const*)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        auto const v = src[i];
+        dst[i] = (v & 0xff000000) | wide[v >> 16 & 0xff] << 16 |
+                 wide[v >> 8 & 0xff] << 8 | wide[v & 0xff];
+    }
+}
+
+void scalar_widen(uint32_t const* src, linear16* dst, std::size_t n,
+    uint32_t const* table)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        auto const v = src[i];
+        dst[i] = {uint16_t(table[v & 0xff]), uint16_t(table[v >> 8 & 0xff]),
+            uint16_t(table[v >> 16 & 0xff]), uint16_t((v >> 24) * 257)};
+    }
+}
+
+void scalar_narrow(linear16 const* src, uint32_t* dst, std::size_t n,
+    uint32_t const* table)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        auto const& p = src[i];
+        dst[i] = uint32_t(p.a >> 8) << 24 | table[p.r >> 4] << 16 |
+                 table[p.g >> 4] << 8 | table[p.b >> 4];
+    }
+}
+
+inline auto map_index(float v, float lo, float scale, uint32_t last)
+    -> uint32_t
+{
+    // written so that NaN ends up at 0 like the vector max
+    auto f = (v - lo) * scale + 0.5f;
+    f = f > 0.0f ? f : 0.0f;
+    f = f < float(last) ? f : float(last);
+    return uint32_t(f);
+}
+
+void scalar_map(float const* src, uint32_t* dst, std::size_t n, float lo,
+    float scale, uint32_t const* map, uint32_t last)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        dst[i] = map[map_index(src[i], lo, scale, last)];
+}
+
+#if defined(GTX_SIMD_X86)
+
+// without gathers only the index computation is vectorized
+GTX_TARGET("sse4.1")
+void sse41_map(float const* src, uint32_t* dst, std::size_t n, float lo,
+    float scale, uint32_t const* map, uint32_t last)
+{
+    auto const vlo = _mm_set1_ps(lo);
+    auto const vscale = _mm_set1_ps(scale);
+    auto const half = _mm_set1_ps(0.5f);
+    auto const vlast = _mm_set1_ps(float(last));
+    alignas(16) uint32_t idx[4];
+    auto i = std::size_t(0);
+    for (; i + 4 <= n; i += 4) {
+        auto f = _mm_add_ps(
+            _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(src + i), vlo), vscale), half);
+        f = _mm_min_ps(_mm_max_ps(f, _mm_setzero_ps()), vlast);
+        _mm_store_si128(reinterpret_cast<__m128i*>(idx), _mm_cvttps_epi32(f));
+        for (int j = 0; j < 4; ++j)
+            dst[i + j] = map[idx[j]];
+    }
+    scalar_map(src + i, dst + i, n - i, lo, scale, map, last);
+}
+
+GTX_TARGET("avx2")
+inline auto avx2_gather(uint32_t const* table, __m256i idx) -> __m256i
+{
+    return _mm256_i32gather_epi32(reinterpret_cast<int const*>(table), idx, 4);
+}
+
+GTX_TARGET("avx2")
+void avx2_lut8(uint32_t const* src, uint32_t* dst, std::size_t n,
+    uint32_t const* wide, uint8_t const* narrow)
+{
+    auto const m = _mm256_set1_epi32(0xff);
+    auto const alpha = _mm256_set1_epi32(int(0xff000000));
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto const v =
+            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+        auto const b = avx2_gather(wide, _mm256_and_si256(v, m));
+        auto const g =
+            avx2_gather(wide, _mm256_and_si256(_mm256_srli_epi32(v, 8), m));
+        auto const r =
+            avx2_gather(wide, _mm256_and_si256(_mm256_srli_epi32(v, 16), m));
+        auto const out = _mm256_or_si256(
+            _mm256_or_si256(_mm256_and_si256(v, alpha), b),
+            _mm256_or_si256(_mm256_slli_epi32(g, 8), _mm256_slli_epi32(r, 16)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), out);
+    }
+    scalar_lut8(src + i, dst + i, n - i, wide, narrow);
+}
+
+GTX_TARGET("avx2")
+void avx2_widen(uint32_t const* src, linear16* dst, std::size_t n,
+    uint32_t const* table)
+{
+    auto const m = _mm256_set1_epi32(0xff);
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto const v =
+            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+        auto const b = avx2_gather(table, _mm256_and_si256(v, m));
+        auto const g =
+            avx2_gather(table, _mm256_and_si256(_mm256_srli_epi32(v, 8), m));
+        auto const r =
+            avx2_gather(table, _mm256_and_si256(_mm256_srli_epi32(v, 16), m));
+        auto const a = _mm256_mullo_epi32(
+            _mm256_srli_epi32(v, 24), _mm256_set1_epi32(257));
+        // b | g << 16 and r | a << 16 interleaved are the linear16 pixels,
+        // the unpacks work within 128-bit lanes
+        auto const lo = _mm256_or_si256(b, _mm256_slli_epi32(g, 16));
+        auto const hi = _mm256_or_si256(r, _mm256_slli_epi32(a, 16));
+        auto const p0 = _mm256_unpacklo_epi32(lo, hi); // pixels 0, 1, 4, 5
+        auto const p1 = _mm256_unpackhi_epi32(lo, hi); // pixels 2, 3, 6, 7
+        auto const out = reinterpret_cast<__m256i*>(dst + i);
+        _mm256_storeu_si256(out, _mm256_permute2x128_si256(p0, p1, 0x20));
+        _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(p0, p1, 0x31));
+    }
+    scalar_widen(src + i, dst + i, n - i, table);
+}
+
+// avx2_narrow4 encodes the four linear16 pixels of v into the low 32 bits
+// of each 64-bit lane
+GTX_TARGET("avx2")
+inline auto avx2_narrow4(__m256i v, uint32_t const* table) -> __m256i
+{
+    // 32-bit lanes hold b | g << 16 and r | a << 16 alternately
+    auto const x = _mm256_and_si256(v, _mm256_set1_epi32(0xffff));
+    auto const y = _mm256_srli_epi32(v, 16);
+    auto const bx = avx2_gather(table, _mm256_srli_epi32(x, 4)); // b, r
+    auto const gy = avx2_gather(table, _mm256_srli_epi32(y, 4)); // g, -
+    auto const ay = _mm256_srli_epi32(y, 8);                     // -, a
+    auto const lo = _mm256_or_si256(bx, _mm256_slli_epi32(gy, 8));
+    auto const hi = _mm256_or_si256(bx, _mm256_slli_epi32(ay, 8));
+    auto const t = _mm256_blend_epi32(lo, hi, 0xaa);
+    return _mm256_or_si256(t, _mm256_srli_epi64(t, 16));
+}
+
+GTX_TARGET("avx2")
+void avx2_narrow(linear16 const* src, uint32_t* dst, std::size_t n,
+    uint32_t const* table)
+{
+    auto const even = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto const in = reinterpret_cast<__m256i const*>(src + i);
+        auto const a = _mm256_permutevar8x32_epi32(
+            avx2_narrow4(_mm256_loadu_si256(in), table), even);
+        auto const b = _mm256_permutevar8x32_epi32(
+            avx2_narrow4(_mm256_loadu_si256(in + 1), table), even);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+            _mm256_permute2x128_si256(a, b, 0x20));
+    }
+    scalar_narrow(src + i, dst + i, n - i, table);
+}
+
+GTX_TARGET("avx2")
+void avx2_map(float const* src, uint32_t* dst, std::size_t n, float lo,
+    float scale, uint32_t const* map, uint32_t last)
+{
+    auto const vlo = _mm256_set1_ps(lo);
+    auto const vscale = _mm256_set1_ps(scale);
+    auto const half = _mm256_set1_ps(0.5f);
+    auto const vlast = _mm256_set1_ps(float(last));
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto f = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(src + i), vlo), vscale),
+            half);
+        f = _mm256_min_ps(_mm256_max_ps(f, _mm256_setzero_ps()), vlast);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+            avx2_gather(map, _mm256_cvttps_epi32(f)));
+    }
+    scalar_map(src + i, dst + i, n - i, lo, scale, map, last);
+}
+
+#elif defined(GTX_SIMD_NEON)
+
+#if defined(__aarch64__)
+
+// a 256 entry byte table is four 64 byte tbl lookups, out of range
+// indices give 0 so the four results can be or-ed together
+inline auto neon_lookup(uint8x16x4_t const* t, uint8x16_t idx) -> uint8x16_t
+{
+    auto const step = vdupq_n_u8(64);
+    auto r = vqtbl4q_u8(t[0], idx);
+    r = vorrq_u8(r, vqtbl4q_u8(t[1], idx = vsubq_u8(idx, step)));
+    r = vorrq_u8(r, vqtbl4q_u8(t[2], idx = vsubq_u8(idx, step)));
+    return vorrq_u8(r, vqtbl4q_u8(t[3], vsubq_u8(idx, step)));
+}
+
+void neon_lut8(uint32_t const* src, uint32_t* dst, std::size_t n,
+    uint32_t const* wide, uint8_t const* narrow)
+{
+    uint8x16x4_t t[4];
+    for (int j = 0; j < 4; ++j)
+        t[j] = vld1q_u8_x4(narrow + 64 * j);
+    auto i = std::size_t(0);
+    for (; i + 16 <= n; i += 16) {
+        // vld4 splits the b, g, r and a bytes of 16 pixels
+        auto v = vld4q_u8(reinterpret_cast<uint8_t const*>(src + i));
+        v.val[0] = neon_lookup(t, v.val[0]);
+        v.val[1] = neon_lookup(t, v.val[1]);
+        v.val[2] = neon_lookup(t, v.val[2]);
+        vst4q_u8(reinterpret_cast<uint8_t*>(dst + i), v);
+    }
+    scalar_lut8(src + i, dst + i, n - i, wide, narrow);
+}
+
+#endif
+
+void neon_map(float const* src, uint32_t* dst, std::size_t n, float lo,
+    float scale, uint32_t const* map, uint32_t last)
+{
+    auto const vlo = vdupq_n_f32(lo);
+    auto const half = vdupq_n_f32(0.5f);
+    auto const vlast = vdupq_n_f32(float(last));
+    uint32_t idx[4];
+    auto i = std::size_t(0);
+    for (; i + 4 <= n; i += 4) {
+        auto f = vmlaq_n_f32(half, vsubq_f32(vld1q_f32(src + i), vlo), scale);
+        // vmaxq returns NaN for NaN, the compare selects 0 instead
+        f = vbslq_f32(vcgtq_f32(f, vdupq_n_f32(0.0f)), f, vdupq_n_f32(0.0f));
+        vst1q_u32(idx, vcvtq_u32_f32(vminq_f32(f, vlast)));
+        for (int j = 0; j < 4; ++j)
+            dst[i + j] = map[idx[j]];
+    }
+    scalar_map(src + i, dst + i, n - i, lo, scale, map, last);
+}
+
+#endif
+
+struct kernels {
+    lut8_fn lut8;
+    widen_fn widen;
+    narrow_fn narrow;
+    map_fn map;
+};
+
+auto select_kernels() -> kernels
+{
+    switch (simd::active()) {
+#if defined(GTX_SIMD_X86)
+    case simd::isa::avx2:
+        return {avx2_lut8, avx2_widen, avx2_narrow, avx2_map};
+    case simd::isa::sse41:
+        return {scalar_lut8, scalar_widen, scalar_narrow, sse41_map};
+#elif defined(GTX_SIMD_NEON) && defined(__aarch64__)
+    case simd::isa::neon:
+        return {neon_lut8, scalar_widen, scalar_narrow, neon_map};
+#elif defined(GTX_SIMD_NEON)
+    case simd::isa::neon:
+        return {scalar_lut8, scalar_widen, scalar_narrow, neon_map};
+#endif
+    default:
+        return {scalar_lut8, scalar_widen, scalar_narrow, scalar_map};
+    }
+}
+
+auto active_kernels() -> kernels const&
+{
+    static auto const k = select_kernels();
+    return k;
+}
+
+template <typename T> auto row(surface<T> const& s, std::size_t y)
+{
+    return s.data() + y * s.stride();
+}
+
+// for_rows runs fn(src row, dst row, n) over the common region in strips
+template <typename Src, typename Dst, typename Fn>
+void for_rows(surface<Src> const& src, surface<Dst>& dst, executor* exec,
+    Fn const& fn)
+{
+    auto const w = std::min(src.width(), dst.width());
+    auto const h = std::min(src.height(), dst.height());
+    if (!w || !h || src.empty() || dst.empty())
+        return;
+    detail::for_each_strip(dst.subsurface(0, 0, w, h), detail::strip_pixels,
+        exec, [&](std::size_t y0, std::size_t y1, scratch_arena& arena) {
+            for (auto y = y0; y < y1; ++y)
+                fn(row(src, y), row(dst, y), w, arena);
+        });
+}
+
+auto words(nargb8888* p) { return reinterpret_cast<uint32_t*>(p); }
+
+template <typename T>
+void map_rows(surface<T> const& src, std::span<nargb8888 const> map,
+    surface<nargb8888>& dst, colormap_options const& opts)
+{
+    if (map.empty())
+        return;
+    auto const& k = active_kernels();
+    auto const last = uint32_t(map.size() - 1);
+    auto const range = opts.hi - opts.lo;
+    auto const scale = range != 0.0f ? float(last) / range : 0.0f;
+    auto const table = reinterpret_cast<uint32_t const*>(map.data());
+    for_rows(src, dst, opts.exec,
+        [&](T const* s, nargb8888* d, std::size_t n, scratch_arena& arena) {
+            if constexpr (std::is_same_v<T, float>)
+                k.map(s, words(d), n, opts.lo, scale, table, last);
+            else {
+                auto const mark = arena.mark();
+                auto const f = arena.allocate_array<float>(n).data();
+                std::copy_n(s, n, f);
+                k.map(f, words(d), n, opts.lo, scale, table, last);
+                arena.rewind(mark);
+            }
+        });
+}
+
+} // namespace
+
+void srgb_to_linear(
+    surface<nargb8888> const& src, surface<nargb8888>& dst, executor* exec)
+{
+    auto const& t = tables();
+    for_rows(src, dst, exec,
+        [&](nargb8888 const* s, nargb8888* d, std::size_t n, scratch_arena&) {
+            active_kernels().lut8(reinterpret_cast<uint32_t const*>(s),
+                words(d), n, t.decode8, t.narrow_decode8);
+        });
+}
+
+void linear_to_srgb(
+    surface<nargb8888> const& src, surface<nargb8888>& dst, executor* exec)
+{
+    auto const& t = tables();
+    for_rows(src, dst, exec,
+        [&](nargb8888 const* s, nargb8888* d, std::size_t n, scratch_arena&) {
+            active_kernels().lut8(reinterpret_cast<uint32_t const*>(s),
+                words(d), n, t.encode8, t.narrow_encode8);
+        });
+}
+
+void srgb_to_linear(
+    surface<nargb8888> const& src, surface<linear16>& dst, executor* exec)
+{
+    auto const& t = tables();
+    for_rows(src, dst, exec,
+        [&](nargb8888 const* s, linear16* d, std::size_t n, scratch_arena&) {
+            active_kernels().widen(
+                reinterpret_cast<uint32_t const*>(s), d, n, t.decode16);
+        });
+}
+
+void linear_to_srgb(
+    surface<linear16> const& src, surface<nargb8888>& dst, executor* exec)
+{
+    auto const& t = tables();
+    for_rows(src, dst, exec,
+        [&](linear16 const* s, nargb8888* d, std::size_t n, scratch_arena&) {
+            active_kernels().narrow(s, words(d), n, t.encode16);
+        });
+}
+
+void colormap(surface<float> const& src, std::span<nargb8888 const> map,
+    surface<nargb8888>& dst, colormap_options const& opts)
+{
+    map_rows(src, map, dst, opts);
+}
+
+void colormap(surface<uint16_t> const& src, std::span<nargb8888 const> map,
+    surface<nargb8888>& dst, colormap_options const& opts)
+{
+    map_rows(src, map, dst, opts);
+}
+
+} // namespace gtx::pixel
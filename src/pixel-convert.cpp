@@ -0,0 +1,709 @@
+#include "simd.hpp"
+#include "strips.hpp"
+#include <gtx/pixel/convert.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+namespace gtx::pixel {
+
+namespace {
+
+using row_fn = void (*)(void const* src, void* dst, std::size_t n);
+
+// scalar reference conversions, also used for the row tails
+
+constexpr auto luma(uint32_t v) -> uint8_t
+{
+    auto const r = (v >> 16) & 0xff;
+    auto const g = (v >> 8) & 0xff;
+    auto const b = v & 0xff;
+    return uint8_t((77 * r + 150 * g + 29 * b) >> 8);
+}
+
+constexpr auto to_565(uint32_t v) -> uint16_t
+{
+    return uint16_t(
+        ((v >> 8) & 0xf800) | ((v >> 5) & 0x07e0) | ((v >> 3) & 0x001f));
+}
+
+constexpr auto from_565(uint16_t p) -> uint32_t
+{
+    auto const r = (p >> 11) & 0x1f;
+    auto const g = (p >> 5) & 0x3f;
+    auto const b = p & 0x1f;
+    return 0xff000000 | ((r << 3 | r >> 2) << 16) | ((g << 2 | g >> 4) << 8) |
+           (b << 3 | b >> 2);
+}
+
+constexpr auto grey(uint8_t l) -> uint32_t
+{
+    return 0xff000000 | l * 0x010101u;
+}
+
+void scalar_opaque(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint32_t const*>(src);
+    auto d = static_cast<uint32_t*>(dst);
+    for (std::size_t i = 0; i < n; ++i)
+        d[i] = s[i] | 0xff000000;
+}
+
+void scalar_32_565(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint32_t const*>(src);
+    auto d = static_cast<uint16_t*>(dst);
+    for (std::size_t i = 0; i < n; ++i)
+        d[i] = to_565(s[i]);
+}
+
+void scalar_565_32(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint16_t const*>(src);
+    auto d = static_cast<uint32_t*>(dst);
+    for (std::size_t i = 0; i < n; ++i)
+        d[i] = from_565(s[i]);
+}
+
+void scalar_32_l8(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint32_t const*>(src);
+    auto d = static_cast<uint8_t*>(dst);
+    for (std::size_t i = 0; i < n; ++i)
+        d[i] = luma(s[i]);
+}
+
+void scalar_32_a8(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint32_t const*>(src);
+    auto d = static_cast<uint8_t*>(dst);
+    for (std::size_t i = 0; i < n; ++i)
+        d[i] = uint8_t(s[i] >> 24);
+}
+
+void scalar_8_grey(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint8_t const*>(src);
+    auto d = static_cast<uint32_t*>(dst);
+    for (std::size_t i = 0; i < n; ++i)
+        d[i] = grey(s[i]);
+}
+
+void scalar_a8_nargb(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint8_t const*>(src);
+    auto d = static_cast<uint32_t*>(dst);
+    for (std::size_t i = 0; i < n; ++i)
+        d[i] = uint32_t(s[i]) << 24 | 0x00ffffff;
+}
+
+void scalar_565_l8(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint16_t const*>(src);
+    auto d = static_cast<uint8_t*>(dst);
+    for (std::size_t i = 0; i < n; ++i)
+        d[i] = luma(from_565(s[i]));
+}
+
+void scalar_8_565(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint8_t const*>(src);
+    auto d = static_cast<uint16_t*>(dst);
+    for (std::size_t i = 0; i < n; ++i)
+        d[i] = to_565(grey(s[i]));
+}
+
+// kernels is the set of row conversions that have vectorized variants
+
+struct kernels {
+    row_fn opaque = scalar_opaque;
+    row_fn x32_565 = scalar_32_565;
+    row_fn x565_32 = scalar_565_32;
+    row_fn x32_l8 = scalar_32_l8;
+    row_fn x32_a8 = scalar_32_a8;
+    row_fn x8_grey = scalar_8_grey;
+    row_fn a8_nargb = scalar_a8_nargb;
+};
+
+#if defined(GTX_SIMD_X86)
+
+// SSE4.1: 4 pixels per 128-bit register
+
+GTX_TARGET("sse4.1")
+inline auto sse41_luma(__m128i v) -> __m128i
+{
+    // 16-bit lanes: [b, r] and [g, a] per pixel, then a pair of madds
+    auto const mask = _mm_set1_epi32(0x00ff00ff);
+    auto const br = _mm_and_si128(v, mask);
+    auto const ga = _mm_and_si128(_mm_srli_epi32(v, 8), mask);
+    auto const l =
+        _mm_add_epi32(_mm_madd_epi16(br, _mm_set1_epi32(77 << 16 | 29)),
+            _mm_madd_epi16(ga, _mm_set1_epi32(150)));
+    return _mm_srli_epi32(l, 8);
+}
+
+GTX_TARGET("sse4.1")
+inline auto sse41_565(__m128i v) -> __m128i
+{
+    auto const r = _mm_and_si128(_mm_srli_epi32(v, 8), _mm_set1_epi32(0xf800));
+    auto const g = _mm_and_si128(_mm_srli_epi32(v, 5), _mm_set1_epi32(0x07e0));
+    auto const b = _mm_and_si128(_mm_srli_epi32(v, 3), _mm_set1_epi32(0x001f));
+    return _mm_or_si128(_mm_or_si128(r, g), b);
+}
+
+GTX_TARGET("sse4.1")
+inline auto sse41_from_565(__m128i p) -> __m128i
+{
+    auto const r = _mm_and_si128(_mm_srli_epi32(p, 11), _mm_set1_epi32(0x1f));
+    auto const g = _mm_and_si128(_mm_srli_epi32(p, 5), _mm_set1_epi32(0x3f));
+    auto const b = _mm_and_si128(p, _mm_set1_epi32(0x1f));
+    auto const r8 = _mm_or_si128(_mm_slli_epi32(r, 3), _mm_srli_epi32(r, 2));
+    auto const g8 = _mm_or_si128(_mm_slli_epi32(g, 2), _mm_srli_epi32(g, 4));
+    auto const b8 = _mm_or_si128(_mm_slli_epi32(b, 3), _mm_srli_epi32(b, 2));
+    return _mm_or_si128(_mm_or_si128(_mm_set1_epi32(int(0xff000000)),
+                            _mm_slli_epi32(r8, 16)),
+        _mm_or_si128(_mm_slli_epi32(g8, 8), b8));
+}
+
+// sse41_pack_u8 stores 16 pixels of 32-bit lanes holding values in 0..255
+GTX_TARGET("sse4.1")
+inline void sse41_pack_u8(
+    __m128i a, __m128i b, __m128i c, __m128i d, uint8_t* dst)
+{
+    auto const ab = _mm_packus_epi32(a, b);
+    auto const cd = _mm_packus_epi32(c, d);
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(ab, cd));
+}
+
+GTX_TARGET("sse4.1")
+void sse41_opaque(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint32_t const*>(src);
+    auto d = static_cast<uint32_t*>(dst);
+    auto const alpha = _mm_set1_epi32(int(0xff000000));
+    auto i = std::size_t(0);
+    for (; i + 4 <= n; i += 4) {
+        auto v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i));
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(d + i), _mm_or_si128(v, alpha));
+    }
+    scalar_opaque(s + i, d + i, n - i);
+}
+
+GTX_TARGET("sse4.1")
+void sse41_32_565(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint32_t const*>(src);
+    auto d = static_cast<uint16_t*>(dst);
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto a = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i));
+        auto b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i),
+            _mm_packus_epi32(sse41_565(a), sse41_565(b)));
+    }
+    scalar_32_565(s + i, d + i, n - i);
+}
+
+GTX_TARGET("sse4.1")
+void sse41_565_32(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint16_t const*>(src);
+    auto d = static_cast<uint32_t*>(dst);
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto p = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i));
+        auto lo = _mm_cvtepu16_epi32(p);
+        auto hi = _mm_cvtepu16_epi32(_mm_srli_si128(p, 8));
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(d + i), sse41_from_565(lo));
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(d + i + 4), sse41_from_565(hi));
+    }
+    scalar_565_32(s + i, d + i, n - i);
+}
+
+GTX_TARGET("sse4.1")
+void sse41_32_l8(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint32_t const*>(src);
+    auto d = static_cast<uint8_t*>(dst);
+    auto i = std::size_t(0);
+    for (; i + 16 <= n; i += 16) {
+        auto p = reinterpret_cast<__m128i const*>(s + i);
+        sse41_pack_u8(sse41_luma(_mm_loadu_si128(p)),
+            sse41_luma(_mm_loadu_si128(p + 1)),
+            sse41_luma(_mm_loadu_si128(p + 2)),
+            sse41_luma(_mm_loadu_si128(p + 3)), d + i);
+    }
+    scalar_32_l8(s + i, d + i, n - i);
+}
+
+GTX_TARGET("sse4.1")
+void sse41_32_a8(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint32_t const*>(src);
+    auto d = static_cast<uint8_t*>(dst);
+    auto i = std::size_t(0);
+    for (; i + 16 <= n; i += 16) {
+        auto p = reinterpret_cast<__m128i const*>(s + i);
+        sse41_pack_u8(_mm_srli_epi32(_mm_loadu_si128(p), 24),
+            _mm_srli_epi32(_mm_loadu_si128(p + 1), 24),
+            _mm_srli_epi32(_mm_loadu_si128(p + 2), 24),
+            _mm_srli_epi32(_mm_loadu_si128(p + 3), 24), d + i);
+    }
+    scalar_32_a8(s + i, d + i, n - i);
+}
+
+GTX_TARGET("sse4.1")
+void sse41_8_grey(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint8_t const*>(src);
+    auto d = static_cast<uint32_t*>(dst);
+    // replicate each byte into b, g, r and set alpha
+    auto const shuffle = _mm_setr_epi8(
+        0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1);
+    auto const alpha = _mm_set1_epi32(int(0xff000000));
+    auto i = std::size_t(0);
+    for (; i + 16 <= n; i += 16) {
+        auto v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i));
+        for (int k = 0; k < 4; ++k) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i + 4 * k),
+                _mm_or_si128(_mm_shuffle_epi8(v, shuffle), alpha));
+            v = _mm_srli_si128(v, 4);
+        }
+    }
+    scalar_8_grey(s + i, d + i, n - i);
+}
+
+GTX_TARGET("sse4.1")
+void sse41_a8_nargb(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint8_t const*>(src);
+    auto d = static_cast<uint32_t*>(dst);
+    auto const shuffle = _mm_setr_epi8(
+        -1, -1, -1, 0, -1, -1, -1, 1, -1, -1, -1, 2, -1, -1, -1, 3);
+    auto const white = _mm_set1_epi32(0x00ffffff);
+    auto i = std::size_t(0);
+    for (; i + 16 <= n; i += 16) {
+        auto v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i));
+        for (int k = 0; k < 4; ++k) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i + 4 * k),
+                _mm_or_si128(_mm_shuffle_epi8(v, shuffle), white));
+            v = _mm_srli_si128(v, 4);
+        }
+    }
+    scalar_a8_nargb(s + i, d + i, n - i);
+}
+
+// AVX2: 8 pixels per 256-bit register
+
+GTX_TARGET("avx2")
+inline auto avx2_luma(__m256i v) -> __m256i
+{
+    auto const mask = _mm256_set1_epi32(0x00ff00ff);
+    auto const br = _mm256_and_si256(v, mask);
+    auto const ga = _mm256_and_si256(_mm256_srli_epi32(v, 8), mask);
+    auto const l = _mm256_add_epi32(
+        _mm256_madd_epi16(br, _mm256_set1_epi32(77 << 16 | 29)),
+        _mm256_madd_epi16(ga, _mm256_set1_epi32(150)));
+    return _mm256_srli_epi32(l, 8);
+}
+
+GTX_TARGET("avx2")
+inline auto avx2_565(__m256i v) -> __m256i
+{
+    auto const r =
+        _mm256_and_si256(_mm256_srli_epi32(v, 8), _mm256_set1_epi32(0xf800));
+    auto const g =
+        _mm256_and_si256(_mm256_srli_epi32(v, 5), _mm256_set1_epi32(0x07e0));
+    auto const b =
+        _mm256_and_si256(_mm256_srli_epi32(v, 3), _mm256_set1_epi32(0x001f));
+    return _mm256_or_si256(_mm256_or_si256(r, g), b);
+}
+
+GTX_TARGET("avx2")
+inline auto avx2_from_565(__m256i p) -> __m256i
+{
+    auto const r =
+        _mm256_and_si256(_mm256_srli_epi32(p, 11), _mm256_set1_epi32(0x1f));
+    auto const g =
+        _mm256_and_si256(_mm256_srli_epi32(p, 5), _mm256_set1_epi32(0x3f));
+    auto const b = _mm256_and_si256(p, _mm256_set1_epi32(0x1f));
+    auto const r8 =
+        _mm256_or_si256(_mm256_slli_epi32(r, 3), _mm256_srli_epi32(r, 2));
+    auto const g8 =
+        _mm256_or_si256(_mm256_slli_epi32(g, 2), _mm256_srli_epi32(g, 4));
+    auto const b8 =
+        _mm256_or_si256(_mm256_slli_epi32(b, 3), _mm256_srli_epi32(b, 2));
+    return _mm256_or_si256(
+        _mm256_or_si256(
+            _mm256_set1_epi32(int(0xff000000)), _mm256_slli_epi32(r8, 16)),
+        _mm256_or_si256(_mm256_slli_epi32(g8, 8), b8));
+}
+
+// avx2_pack_u8 stores 32 pixels of 32-bit lanes holding values in 0..255,
+// the packs work within 128-bit lanes so the dwords are put back in order
+GTX_TARGET("avx2")
+inline void avx2_pack_u8(
+    __m256i a, __m256i b, __m256i c, __m256i d, uint8_t* dst)
+{
+    auto const ab = _mm256_packus_epi32(a, b);
+    auto const cd = _mm256_packus_epi32(c, d);
+    auto const abcd = _mm256_packus_epi16(ab, cd);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),
+        _mm256_permutevar8x32_epi32(
+            abcd, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)));
+}
+
+GTX_TARGET("avx2")
+void avx2_opaque(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint32_t const*>(src);
+    auto d = static_cast<uint32_t*>(dst);
+    auto const alpha = _mm256_set1_epi32(int(0xff000000));
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(s + i));
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(d + i), _mm256_or_si256(v, alpha));
+    }
+    scalar_opaque(s + i, d + i, n - i);
+}
+
+GTX_TARGET("avx2")
+void avx2_32_565(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint32_t const*>(src);
+    auto d = static_cast<uint16_t*>(dst);
+    auto i = std::size_t(0);
+    for (; i + 16 <= n; i += 16) {
+        auto p = reinterpret_cast<__m256i const*>(s + i);
+        auto ab = _mm256_packus_epi32(avx2_565(_mm256_loadu_si256(p)),
+            avx2_565(_mm256_loadu_si256(p + 1)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i),
+            _mm256_permute4x64_epi64(ab, 0xd8));
+    }
+    scalar_32_565(s + i, d + i, n - i);
+}
+
+GTX_TARGET("avx2")
+void avx2_565_32(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint16_t const*>(src);
+    auto d = static_cast<uint32_t*>(dst);
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto p = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i),
+            avx2_from_565(_mm256_cvtepu16_epi32(p)));
+    }
+    scalar_565_32(s + i, d + i, n - i);
+}
+
+GTX_TARGET("avx2")
+void avx2_32_l8(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint32_t const*>(src);
+    auto d = static_cast<uint8_t*>(dst);
+    auto i = std::size_t(0);
+    for (; i + 32 <= n; i += 32) {
+        auto p = reinterpret_cast<__m256i const*>(s + i);
+        avx2_pack_u8(avx2_luma(_mm256_loadu_si256(p)),
+            avx2_luma(_mm256_loadu_si256(p + 1)),
+            avx2_luma(_mm256_loadu_si256(p + 2)),
+            avx2_luma(_mm256_loadu_si256(p + 3)), d + i);
+    }
+    scalar_32_l8(s + i, d + i, n - i);
+}
+
+GTX_TARGET("avx2")
+void avx2_32_a8(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint32_t const*>(src);
+    auto d = static_cast<uint8_t*>(dst);
+    auto i = std::size_t(0);
+    for (; i + 32 <= n; i += 32) {
+        auto p = reinterpret_cast<__m256i const*>(s + i);
+        avx2_pack_u8(_mm256_srli_epi32(_mm256_loadu_si256(p), 24),
+            _mm256_srli_epi32(_mm256_loadu_si256(p + 1), 24),
+            _mm256_srli_epi32(_mm256_loadu_si256(p + 2), 24),
+            _mm256_srli_epi32(_mm256_loadu_si256(p + 3), 24), d + i);
+    }
+    scalar_32_a8(s + i, d + i, n - i);
+}
+
+GTX_TARGET("avx2")
+void avx2_8_grey(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint8_t const*>(src);
+    auto d = static_cast<uint32_t*>(dst);
+    auto const alpha = _mm256_set1_epi32(int(0xff000000));
+    auto const splat = _mm256_set1_epi32(0x010101);
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto v = _mm256_cvtepu8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<__m128i const*>(s + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i),
+            _mm256_or_si256(_mm256_mullo_epi32(v, splat), alpha));
+    }
+    scalar_8_grey(s + i, d + i, n - i);
+}
+
+GTX_TARGET("avx2")
+void avx2_a8_nargb(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint8_t const*>(src);
+    auto d = static_cast<uint32_t*>(dst);
+    auto const white = _mm256_set1_epi32(0x00ffffff);
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto v = _mm256_cvtepu8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<__m128i const*>(s + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i),
+            _mm256_or_si256(_mm256_slli_epi32(v, 24), white));
+    }
+    scalar_a8_nargb(s + i, d + i, n - i);
+}
+
+#elif defined(GTX_SIMD_NEON)
+
+// NEON: 8 pixels per iteration through the de-interleaving loads/stores
+
+void neon_opaque(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint32_t const*>(src);
+    auto d = static_cast<uint32_t*>(dst);
+    auto const alpha = vdupq_n_u32(0xff000000);
+    auto i = std::size_t(0);
+    for (; i + 4 <= n; i += 4)
+        vst1q_u32(d + i, vorrq_u32(vld1q_u32(s + i), alpha));
+    scalar_opaque(s + i, d + i, n - i);
+}
+
+void neon_32_565(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint32_t const*>(src);
+    auto d = static_cast<uint16_t*>(dst);
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto bgra = vld4_u8(reinterpret_cast<uint8_t const*>(s + i));
+        auto r = vandq_u16(vshll_n_u8(bgra.val[2], 8), vdupq_n_u16(0xf800));
+        auto g = vandq_u16(vshll_n_u8(bgra.val[1], 3), vdupq_n_u16(0x07e0));
+        auto b = vshrq_n_u16(vmovl_u8(bgra.val[0]), 3);
+        vst1q_u16(d + i, vorrq_u16(vorrq_u16(r, g), b));
+    }
+    scalar_32_565(s + i, d + i, n - i);
+}
+
+void neon_565_32(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint16_t const*>(src);
+    auto d = static_cast<uint32_t*>(dst);
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto p = vld1q_u16(s + i);
+        auto r = vmovn_u16(vshrq_n_u16(p, 11));
+        auto g = vmovn_u16(vandq_u16(vshrq_n_u16(p, 5), vdupq_n_u16(0x3f)));
+        auto b = vmovn_u16(vandq_u16(p, vdupq_n_u16(0x1f)));
+        auto bgra = uint8x8x4_t{};
+        bgra.val[0] = vorr_u8(vshl_n_u8(b, 3), vshr_n_u8(b, 2));
+        bgra.val[1] = vorr_u8(vshl_n_u8(g, 2), vshr_n_u8(g, 4));
+        bgra.val[2] = vorr_u8(vshl_n_u8(r, 3), vshr_n_u8(r, 2));
+        bgra.val[3] = vdup_n_u8(255);
+        vst4_u8(reinterpret_cast<uint8_t*>(d + i), bgra);
+    }
+    scalar_565_32(s + i, d + i, n - i);
+}
+
+void neon_32_l8(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint32_t const*>(src);
+    auto d = static_cast<uint8_t*>(dst);
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto bgra = vld4_u8(reinterpret_cast<uint8_t const*>(s + i));
+        auto l = vmull_u8(bgra.val[0], vdup_n_u8(29));
+        l = vmlal_u8(l, bgra.val[1], vdup_n_u8(150));
+        l = vmlal_u8(l, bgra.val[2], vdup_n_u8(77));
+        vst1_u8(d + i, vshrn_n_u16(l, 8));
+    }
+    scalar_32_l8(s + i, d + i, n - i);
+}
+
+void neon_32_a8(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint32_t const*>(src);
+    auto d = static_cast<uint8_t*>(dst);
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8)
+        vst1_u8(d + i, vld4_u8(reinterpret_cast<uint8_t const*>(s + i)).val[3]);
+    scalar_32_a8(s + i, d + i, n - i);
+}
+
+void neon_8_grey(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint8_t const*>(src);
+    auto d = static_cast<uint32_t*>(dst);
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto l = vld1_u8(s + i);
+        auto bgra = uint8x8x4_t{{l, l, l, vdup_n_u8(255)}};
+        vst4_u8(reinterpret_cast<uint8_t*>(d + i), bgra);
+    }
+    scalar_8_grey(s + i, d + i, n - i);
+}
+
+void neon_a8_nargb(void const* src, void* dst, std::size_t n)
+{
+    auto s = static_cast<uint8_t const*>(src);
+    auto d = static_cast<uint32_t*>(dst);
+    auto const white = vdup_n_u8(255);
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto bgra = uint8x8x4_t{{white, white, white, vld1_u8(s + i)}};
+        vst4_u8(reinterpret_cast<uint8_t*>(d + i), bgra);
+    }
+    scalar_a8_nargb(s + i, d + i, n - i);
+}
+
+#endif
+
+auto select_kernels() -> kernels
+{
+    auto k = kernels{};
+    switch (simd::active()) {
+#if defined(GTX_SIMD_X86)
+    case simd::isa::avx2:
+        k.opaque = avx2_opaque;
+        k.x32_565 = avx2_32_565;
+        k.x565_32 = avx2_565_32;
+        k.x32_l8 = avx2_32_l8;
+        k.x32_a8 = avx2_32_a8;
+        k.x8_grey = avx2_8_grey;
+        k.a8_nargb = avx2_a8_nargb;
+        break;
+    case simd::isa::sse41:
+        k.opaque = sse41_opaque;
+        k.x32_565 = sse41_32_565;
+        k.x565_32 = sse41_565_32;
+        k.x32_l8 = sse41_32_l8;
+        k.x32_a8 = sse41_32_a8;
+        k.x8_grey = sse41_8_grey;
+        k.a8_nargb = sse41_a8_nargb;
+        break;
+#elif defined(GTX_SIMD_NEON)
+    case simd::isa::neon:
+        k.opaque = neon_opaque;
+        k.x32_565 = neon_32_565;
+        k.x565_32 = neon_565_32;
+        k.x32_l8 = neon_32_l8;
+        k.x32_a8 = neon_32_a8;
+        k.x8_grey = neon_8_grey;
+        k.a8_nargb = neon_a8_nargb;
+        break;
+#endif
+    default:
+        break;
+    }
+    return k;
+}
+
+auto active_kernels() -> kernels const&
+{
+    static auto const k = select_kernels();
+    return k;
+}
+
+template <typename T>
+constexpr bool is_32 =
+    std::is_same_v<T, nargb8888> || std::is_same_v<T, xrgb8888>;
+
+template <typename T>
+constexpr bool is_8 = std::is_same_v<T, l8> || std::is_same_v<T, a8>;
+
+template <typename T>
+constexpr bool is_opaque =
+    !std::is_same_v<T, nargb8888> && !std::is_same_v<T, a8>;
+
+// plain row copy: same format, or a8 -> l8 which keeps the coverage as grey
+template <typename Src, typename Dst>
+constexpr bool is_copy =
+    std::is_same_v<Src, Dst> || (std::is_same_v<Src, a8> && is_8<Dst>);
+
+// a8 from an opaque format is a 255 fill
+template <typename Src, typename Dst>
+constexpr bool is_fill = std::is_same_v<Dst, a8> && is_opaque<Src>;
+
+template <typename Src, typename Dst> auto pick_row() -> row_fn
+{
+    auto const& k = active_kernels();
+    if constexpr (is_32<Src> && is_32<Dst>)
+        return k.opaque;
+    else if constexpr (is_32<Src> && std::is_same_v<Dst, rgb565>)
+        return k.x32_565;
+    else if constexpr (is_32<Src> && std::is_same_v<Dst, l8>)
+        return k.x32_l8;
+    else if constexpr (is_32<Src> && std::is_same_v<Dst, a8>)
+        return k.x32_a8;
+    else if constexpr (std::is_same_v<Src, rgb565> && is_32<Dst>)
+        return k.x565_32;
+    else if constexpr (std::is_same_v<Src, rgb565> && std::is_same_v<Dst, l8>)
+        return scalar_565_l8;
+    else if constexpr (std::is_same_v<Src, a8> &&
+                       std::is_same_v<Dst, nargb8888>)
+        return k.a8_nargb;
+    else if constexpr (is_8<Src> && is_32<Dst>)
+        return k.x8_grey;
+    else if constexpr (is_8<Src> && std::is_same_v<Dst, rgb565>)
+        return scalar_8_565;
+    else
+        static_assert(sizeof(Src) == 0, "unsupported conversion");
+}
+
+} // namespace
+
+template <typename Src, typename Dst>
+void convert(surface<Src> const& src, surface<Dst>& dst)
+{
+    static_assert(sizeof(Src) == sizeof(typename Src::value_type));
+    static_assert(sizeof(Dst) == sizeof(typename Dst::value_type));
+
+    auto const w = std::min(src.width(), dst.width());
+    auto const h = std::min(src.height(), dst.height());
+    if (!w || !h || !src.data() || !dst.data())
+        return;
+
+    detail::for_each_strip(dst.subsurface(0, 0, w, h), detail::strip_pixels,
+        nullptr, [&](std::size_t y0, std::size_t y1, scratch_arena&) {
+            for (auto y = y0; y < y1; ++y) {
+                void const* s = src.data() + y * src.stride();
+                void* d = dst.data() + y * dst.stride();
+                if constexpr (is_copy<Src, Dst>)
+                    std::memcpy(d, s, w * sizeof(Dst));
+                else if constexpr (is_fill<Src, Dst>)
+                    std::memset(d, 255, w);
+                else
+                    pick_row<Src, Dst>()(s, d, w);
+            }
+        });
+}
+
+#define GTX_CONVERT_FROM(Src)                                                  \
+    template void convert(surface<Src> const&, surface<nargb8888>&);           \
+    template void convert(surface<Src> const&, surface<xrgb8888>&);            \
+    template void convert(surface<Src> const&, surface<rgb565>&);              \
+    template void convert(surface<Src> const&, surface<l8>&);                  \
+    template void convert(surface<Src> const&, surface<a8>&);
+
+GTX_CONVERT_FROM(nargb8888)
+GTX_CONVERT_FROM(xrgb8888)
+GTX_CONVERT_FROM(rgb565)
+GTX_CONVERT_FROM(l8)
+GTX_CONVERT_FROM(a8)
+
+#undef GTX_CONVERT_FROM
+
+} // namespace gtx::pixel
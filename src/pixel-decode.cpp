@@ -0,0 +1,403 @@
+#include <gtx/pixel/decode.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+namespace gtx::pixel {
+
+namespace {
+
+struct rgba {
+    uint8_t r = 0;
+    uint8_t g = 0;
+    uint8_t b = 0;
+    uint8_t a = 255;
+};
+
+// pack converts a decoded pixel with the channel conventions of convert
+template <typename T> constexpr auto pack(rgba const& c) -> T
+{
+    if constexpr (std::is_same_v<T, nargb8888>)
+        return T{c.r, c.g, c.b, c.a};
+    else if constexpr (std::is_same_v<T, xrgb8888> ||
+                       std::is_same_v<T, rgb565>)
+        return T{c.r, c.g, c.b};
+    else if constexpr (std::is_same_v<T, l8>)
+        return T{uint8_t((77 * c.r + 150 * c.g + 29 * c.b) >> 8)};
+    else if constexpr (std::is_same_v<T, a8>)
+        return T{c.a};
+    else
+        static_assert(sizeof(T) == 0, "unsupported pixel format");
+}
+
+// target hands out the dst rows of the image rows it covers, decoders walk
+// every image pixel and store the first n of each covered row
+template <typename T> struct target {
+    surface<T>& dst;
+    std::size_t n; // pixels stored per row
+
+    target(surface<T>& dst, std::size_t w)
+        : dst{dst}
+        , n{std::min(w, dst.width())}
+    {
+    }
+
+    auto row(std::size_t y) const -> T*
+    {
+        return y < dst.height() && dst.data() ? dst.data() + y * dst.stride()
+                                              : nullptr;
+    }
+};
+
+constexpr auto be32(uint8_t const* p) -> uint32_t
+{
+    return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 |
+           p[3];
+}
+
+constexpr auto le16(uint8_t const* p) -> uint32_t
+{
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8;
+}
+
+// qoi
+
+constexpr std::size_t qoi_header = 14;
+constexpr std::size_t qoi_padding = 8; // end marker
+
+auto qoi_probe(uint8_t const* p, std::size_t n) -> image_info
+{
+    if (n < qoi_header + qoi_padding || std::memcmp(p, "qoif", 4) != 0)
+        return {};
+    auto const w = be32(p + 4);
+    auto const h = be32(p + 8);
+    if (!w || !h || (p[12] != 3 && p[12] != 4))
+        return {};
+    return {image_format::qoi, {w, h}, p[12] == 4};
+}
+
+template <typename T>
+auto qoi_decode(uint8_t const* p, std::size_t n, image_info const& info,
+    surface<T>& dst) -> bool
+{
+    auto const end = p + n - qoi_padding;
+    p += qoi_header;
+
+    auto const out = target<T>{dst, info.size.w};
+    // the spec starts the index all zero, alpha included, unlike px
+    rgba index[64];
+    std::fill(std::begin(index), std::end(index), rgba{0, 0, 0, 0});
+    auto px = rgba{};
+    auto run = 0u;
+    for (std::size_t y = 0; y < info.size.h; ++y) {
+        auto const row = out.row(y);
+        if (!row)
+            return true; // below dst, nothing left to store
+        for (std::size_t x = 0; x < info.size.w; ++x) {
+            if (run)
+                --run;
+            else {
+                // the longest op is 5 bytes, the end marker pads the last
+                if (p >= end)
+                    return false;
+                auto const b1 = *p++;
+                if (b1 == 0xfe) {
+                    px.r = p[0];
+                    px.g = p[1];
+                    px.b = p[2];
+                    p += 3;
+                }
+                else if (b1 == 0xff) {
+                    px = {p[0], p[1], p[2], p[3]};
+                    p += 4;
+                }
+                else if ((b1 & 0xc0) == 0x00)
+                    px = index[b1];
+                else if ((b1 & 0xc0) == 0x40) {
+                    px.r += ((b1 >> 4) & 3) - 2;
+                    px.g += ((b1 >> 2) & 3) - 2;
+                    px.b += (b1 & 3) - 2;
+                }
+                else if ((b1 & 0xc0) == 0x80) {
+                    auto const b2 = *p++;
+                    auto const dg = (b1 & 0x3f) - 32;
+                    px.r += dg - 8 + ((b2 >> 4) & 0x0f);
+                    px.g += dg;
+                    px.b += dg - 8 + (b2 & 0x0f);
+                }
+                else
+                    run = b1 & 0x3f;
+                index[(px.r * 3 + px.g * 5 + px.b * 7 + px.a * 11) % 64] = px;
+            }
+            if (x < out.n)
+                row[x] = pack<T>(px);
+        }
+    }
+    return true;
+}
+
+// pnm
+
+// pnm_token skips whitespace and comments and reads a decimal number
+auto pnm_token(uint8_t const*& p, uint8_t const* end, uint32_t& v) -> bool
+{
+    for (;;) {
+        while (p < end && (*p == ' ' || (*p >= '\t' && *p <= '\r')))
+            ++p;
+        if (p < end && *p == '#') {
+            while (p < end && *p != '\n')
+                ++p;
+            continue;
+        }
+        break;
+    }
+    if (p == end || *p < '0' || *p > '9')
+        return false;
+    v = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+        v = v * 10 + uint32_t(*p - '0');
+        if (v > 0xffffff)
+            return false;
+    }
+    return true;
+}
+
+struct pnm_header {
+    image_info info;
+    uint32_t channels = 0;
+    uint32_t maxval = 0;
+    uint8_t const* pixels = nullptr;
+};
+
+auto pnm_parse(uint8_t const* p, std::size_t n) -> pnm_header
+{
+    if (n < 3 || p[0] != 'P' || (p[1] != '5' && p[1] != '6'))
+        return {};
+    auto h = pnm_header{};
+    auto const end = p + n;
+    auto q = p + 2;
+    uint32_t w = 0, ht = 0;
+    if (!pnm_token(q, end, w) || !pnm_token(q, end, ht) ||
+        !pnm_token(q, end, h.maxval) || !w || !ht || !h.maxval ||
+        h.maxval > 65535 || q == end)
+        return {};
+    h.info = {image_format::pnm, {w, ht}, false};
+    h.channels = p[1] == '6' ? 3 : 1;
+    h.pixels = q + 1; // a single whitespace ends the header
+    return h;
+}
+
+template <typename T>
+auto pnm_decode(pnm_header const& hd, uint8_t const* end, surface<T>& dst)
+    -> bool
+{
+    auto const w = std::size_t(hd.info.size.w);
+    auto const wide = hd.maxval > 255;
+    auto const row_bytes = w * hd.channels * (wide ? 2 : 1);
+    auto const out = target<T>{dst, w};
+
+    // samples are scaled to 8 bits, the division is skipped for maxval 255
+    auto const sample = [&](uint8_t const* s) -> uint8_t {
+        auto const v = wide ? uint32_t(s[0]) << 8 | s[1] : uint32_t(s[0]);
+        if (hd.maxval == 255)
+            return uint8_t(v);
+        return uint8_t((v * 255 + hd.maxval / 2) / hd.maxval);
+    };
+
+    auto p = hd.pixels;
+    for (std::size_t y = 0; y < hd.info.size.h; ++y, p += row_bytes) {
+        auto const row = out.row(y);
+        if (!row)
+            return true;
+        if (std::size_t(end - p) < row_bytes)
+            return false;
+        auto s = p;
+        auto const step = std::size_t(wide ? 2 : 1);
+        if (hd.channels == 3)
+            for (std::size_t x = 0; x < out.n; ++x, s += 3 * step)
+                row[x] = pack<T>({sample(s), sample(s + step),
+                    sample(s + 2 * step), 255});
+        else
+            for (std::size_t x = 0; x < out.n; ++x, s += step) {
+                auto const l = sample(s);
+                row[x] = pack<T>({l, l, l, 255});
+            }
+    }
+    return true;
+}
+
+// tga
+
+constexpr std::size_t tga_header = 18;
+
+struct tga_layout {
+    image_info info;
+    uint32_t bytes = 0; // per pixel
+    bool grey = false;
+    bool rle = false;
+    bool bottom_up = false;
+    bool right_to_left = false;
+    uint8_t const* pixels = nullptr;
+};
+
+auto tga_parse(uint8_t const* p, std::size_t n) -> tga_layout
+{
+    if (n < tga_header)
+        return {};
+    auto const id_length = p[0];
+    auto const map_type = p[1];
+    auto const type = p[2];
+    auto const map_length = le16(p + 5);
+    auto const map_bits = p[7];
+    auto const w = le16(p + 12);
+    auto const h = le16(p + 14);
+    auto const depth = p[16];
+    auto const desc = p[17];
+
+    auto t = tga_layout{};
+    t.grey = type == 3 || type == 11;
+    t.rle = type == 10 || type == 11;
+    if (type != 2 && type != 3 && type != 10 && type != 11)
+        return {};
+    if (map_type > 1 || !w || !h)
+        return {};
+    if (t.grey ? depth != 8 && depth != 16
+               : depth != 15 && depth != 16 && depth != 24 && depth != 32)
+        return {};
+
+    auto const alpha_bits = desc & 0x0f;
+    t.bytes = (depth + 7) / 8;
+    t.info = {image_format::tga, {w, h},
+        t.grey ? depth == 16 : depth == 32 || (depth == 16 && alpha_bits)};
+    t.bottom_up = !(desc & 0x20);
+    t.right_to_left = desc & 0x10;
+
+    // a color map may come with a true color image, it is skipped
+    auto const skip = tga_header + id_length +
+                      (map_type ? std::size_t(map_length) * (map_bits + 7) / 8
+                                : 0);
+    if (skip > n)
+        return {};
+    t.pixels = p + skip;
+    return t;
+}
+
+template <typename T>
+auto tga_decode(tga_layout const& t, uint8_t const* end, surface<T>& dst)
+    -> bool
+{
+    auto const w = std::size_t(t.info.size.w);
+    auto const h = std::size_t(t.info.size.h);
+    auto const out = target<T>{dst, w};
+
+    auto const fetch = [&](uint8_t const* s) -> rgba {
+        if (t.grey)
+            return {s[0], s[0], s[0], t.bytes == 2 ? s[1] : uint8_t(255)};
+        switch (t.bytes) {
+        case 2: {
+            auto const v = le16(s);
+            auto const five = [](uint32_t c) {
+                return uint8_t(c << 3 | c >> 2);
+            };
+            return {five(v >> 10 & 31), five(v >> 5 & 31), five(v & 31),
+                uint8_t(!t.info.alpha || v & 0x8000 ? 255 : 0)};
+        }
+        case 3:
+            return {s[2], s[1], s[0], 255};
+        default:
+            return {s[2], s[1], s[0], t.info.alpha ? s[3] : uint8_t(255)};
+        }
+    };
+
+    auto p = t.pixels;
+    auto count = 0u; // pixels left in the current packet
+    auto repeat = false;
+    auto px = rgba{};
+    for (std::size_t i = 0; i < h; ++i) {
+        auto const y = t.bottom_up ? h - 1 - i : i;
+        auto const row = out.row(y);
+        if (!row && !t.rle) {
+            // raw rows can be skipped, the region below dst is not read
+            if (!t.bottom_up)
+                return true;
+            if (std::size_t(end - p) < w * t.bytes)
+                return false;
+            p += w * t.bytes;
+            continue;
+        }
+        for (std::size_t j = 0; j < w; ++j) {
+            if (t.rle) {
+                if (!count) {
+                    if (p >= end)
+                        return false;
+                    repeat = *p & 0x80;
+                    count = (*p++ & 0x7f) + 1u;
+                    if (repeat) {
+                        if (std::size_t(end - p) < t.bytes)
+                            return false;
+                        px = fetch(p);
+                        p += t.bytes;
+                    }
+                }
+                --count;
+                if (!repeat) {
+                    if (std::size_t(end - p) < t.bytes)
+                        return false;
+                    px = fetch(p);
+                    p += t.bytes;
+                }
+            }
+            else {
+                if (std::size_t(end - p) < t.bytes)
+                    return false;
+                px = fetch(p);
+                p += t.bytes;
+            }
+            auto const x = t.right_to_left ? w - 1 - j : j;
+            if (row && x < out.n)
+                row[x] = pack<T>(px);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+auto probe(std::span<std::byte const> data) -> image_info
+{
+    auto const p = reinterpret_cast<uint8_t const*>(data.data());
+    auto const n = data.size();
+    if (auto const i = qoi_probe(p, n); i.format != image_format::unknown)
+        return i;
+    if (auto const h = pnm_parse(p, n); h.pixels)
+        return h.info;
+    if (auto const t = tga_parse(p, n); t.pixels)
+        return t.info;
+    return {};
+}
+
+template <typename T>
+auto decode(std::span<std::byte const> data, surface<T>& dst) -> bool
+{
+    static_assert(sizeof(T) == sizeof(typename T::value_type));
+
+    auto const p = reinterpret_cast<uint8_t const*>(data.data());
+    auto const n = data.size();
+    if (auto const i = qoi_probe(p, n); i.format != image_format::unknown)
+        return qoi_decode(p, n, i, dst);
+    if (auto const h = pnm_parse(p, n); h.pixels)
+        return pnm_decode(h, p + n, dst);
+    if (auto const t = tga_parse(p, n); t.pixels)
+        return tga_decode(t, p + n, dst);
+    return false;
+}
+
+template auto decode(std::span<std::byte const>, surface<nargb8888>&) -> bool;
+template auto decode(std::span<std::byte const>, surface<xrgb8888>&) -> bool;
+template auto decode(std::span<std::byte const>, surface<rgb565>&) -> bool;
+template auto decode(std::span<std::byte const>, surface<l8>&) -> bool;
+template auto decode(std::span<std::byte const>, surface<a8>&) -> bool;
+
+} // namespace gtx::pixel
@@ -0,0 +1,223 @@
+#include "simd.hpp"
+#include <gtx/pixel/hash.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace gtx::pixel {
+
+namespace {
+
+constexpr uint64_t prime32_1 = 0x9e3779b1;
+constexpr uint64_t prime32_2 = 0x85ebca77;
+constexpr uint64_t prime32_3 = 0xc2b2ae3d;
+constexpr uint64_t prime64_1 = 0x9e3779b185ebca87;
+constexpr uint64_t prime64_2 = 0xc2b2ae3d27d4eb4f;
+constexpr uint64_t prime64_3 = 0x165667b19e3779f9;
+constexpr uint64_t prime64_4 = 0x85ebca77c2b2ae63;
+constexpr uint64_t prime64_5 = 0x27d4eb2f165667c5;
+
+constexpr std::size_t stripe_bytes = 64;
+constexpr std::size_t block_stripes = 16;
+
+// stripe s of a block is keyed with secret[s..s + 8), the scramble and the
+// final merge use the keys after those
+constexpr auto make_secret()
+{
+    auto s = std::array<uint64_t, block_stripes + 8>{};
+    auto x = prime64_1;
+    for (auto& k : s) {
+        // splitmix64
+        auto z = (x += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        k = z ^ (z >> 31);
+    }
+    return s;
+}
+
+constexpr auto secret = make_secret();
+
+// accumulate_fn adds n consecutive stripes at p to the lanes in acc, the
+// stripe i being keyed with keys + i
+using accumulate_fn = void (*)(uint64_t* acc, std::byte const* p,
+    std::size_t n, uint64_t const* keys);
+
+void scalar_accumulate(uint64_t* acc, std::byte const* p, std::size_t n,
+    uint64_t const* keys)
+{
+    for (std::size_t s = 0; s < n; ++s, p += stripe_bytes)
+        for (std::size_t i = 0; i < 8; ++i) {
+            auto d = uint64_t(0);
+            std::memcpy(&d, p + i * 8, 8);
+            auto const k = d ^ keys[s + i];
+            acc[i ^ 1] += d;
+            acc[i] += (k & 0xffffffff) * (k >> 32);
+        }
+}
+
+#if defined(GTX_SIMD_X86)
+
+GTX_TARGET("sse4.1")
+void sse41_accumulate(uint64_t* acc, std::byte const* p, std::size_t n,
+    uint64_t const* keys)
+{
+    auto const a = reinterpret_cast<__m128i*>(acc);
+    __m128i v[4];
+    for (int i = 0; i < 4; ++i)
+        v[i] = _mm_loadu_si128(a + i);
+    for (std::size_t s = 0; s < n; ++s, p += stripe_bytes) {
+        auto const src = reinterpret_cast<__m128i const*>(p);
+        auto const key = reinterpret_cast<__m128i const*>(keys + s);
+        for (int i = 0; i < 4; ++i) {
+            auto const d = _mm_loadu_si128(src + i);
+            auto const k = _mm_xor_si128(d, _mm_loadu_si128(key + i));
+            auto const hi = _mm_shuffle_epi32(k, _MM_SHUFFLE(0, 3, 0, 1));
+            auto const swap = _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+            v[i] = _mm_add_epi64(
+                v[i], _mm_add_epi64(_mm_mul_epu32(k, hi), swap));
+        }
+    }
+    for (int i = 0; i < 4; ++i)
+        _mm_storeu_si128(a + i, v[i]);
+}
+
+GTX_TARGET("avx2")
+void avx2_accumulate(uint64_t* acc, std::byte const* p, std::size_t n,
+    uint64_t const* keys)
+{
+    auto const a = reinterpret_cast<__m256i*>(acc);
+    __m256i v[2] = {_mm256_loadu_si256(a), _mm256_loadu_si256(a + 1)};
+    for (std::size_t s = 0; s < n; ++s, p += stripe_bytes) {
+        auto const src = reinterpret_cast<__m256i const*>(p);
+        auto const key = reinterpret_cast<__m256i const*>(keys + s);
+        for (int i = 0; i < 2; ++i) {
+            auto const d = _mm256_loadu_si256(src + i);
+            auto const k = _mm256_xor_si256(d, _mm256_loadu_si256(key + i));
+            auto const hi = _mm256_shuffle_epi32(k, _MM_SHUFFLE(0, 3, 0, 1));
+            auto const swap = _mm256_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+            v[i] = _mm256_add_epi64(
+                v[i], _mm256_add_epi64(_mm256_mul_epu32(k, hi), swap));
+        }
+    }
+    _mm256_storeu_si256(a, v[0]);
+    _mm256_storeu_si256(a + 1, v[1]);
+}
+
+#elif defined(GTX_SIMD_NEON)
+
+void neon_accumulate(uint64_t* acc, std::byte const* p, std::size_t n,
+    uint64_t const* keys)
+{
+    uint64x2_t v[4];
+    for (int i = 0; i < 4; ++i)
+        v[i] = vld1q_u64(acc + 2 * i);
+    for (std::size_t s = 0; s < n; ++s, p += stripe_bytes) {
+        auto const src = reinterpret_cast<uint8_t const*>(p);
+        for (int i = 0; i < 4; ++i) {
+            auto const d = vreinterpretq_u64_u8(vld1q_u8(src + 16 * i));
+            auto const k = veorq_u64(d, vld1q_u64(keys + s + 2 * i));
+            v[i] = vaddq_u64(v[i], vextq_u64(d, d, 1));
+            v[i] = vmlal_u32(v[i], vmovn_u64(k), vshrn_n_u64(k, 32));
+        }
+    }
+    for (int i = 0; i < 4; ++i)
+        vst1q_u64(acc + 2 * i, v[i]);
+}
+
+#endif
+
+auto select_accumulate() -> accumulate_fn
+{
+    switch (simd::active()) {
+#if defined(GTX_SIMD_X86)
+    case simd::isa::avx2:
+        return avx2_accumulate;
+    case simd::isa::sse41:
+        return sse41_accumulate;
+#elif defined(GTX_SIMD_NEON)
+    case simd::isa::neon:
+        return neon_accumulate;
+#endif
+    default:
+        return scalar_accumulate;
+    }
+}
+
+// mul_fold is the xor of the halves of the 128-bit product
+auto mul_fold(uint64_t a, uint64_t b) -> uint64_t
+{
+    auto const ll = (a & 0xffffffff) * (b & 0xffffffff);
+    auto const lh = (a & 0xffffffff) * (b >> 32);
+    auto const hl = (a >> 32) * (b & 0xffffffff);
+    auto const hh = (a >> 32) * (b >> 32);
+    auto const cross = (ll >> 32) + (hl & 0xffffffff) + lh;
+    auto const hi = hh + (hl >> 32) + (cross >> 32);
+    auto const lo = cross << 32 | (ll & 0xffffffff);
+    return lo ^ hi;
+}
+
+struct hasher {
+    accumulate_fn accumulate;
+    uint64_t acc[8] = {prime32_3, prime64_1, prime64_2, prime64_3, prime64_4,
+        prime32_2, prime64_5, prime32_1};
+    std::size_t stripe = 0;
+
+    void feed(std::byte const* p, std::size_t n)
+    {
+        while (n) {
+            auto const take = std::min(n, block_stripes - stripe);
+            accumulate(acc, p, take, secret.data() + stripe);
+            p += take * stripe_bytes;
+            n -= take;
+            if ((stripe += take) == block_stripes) {
+                scramble();
+                stripe = 0;
+            }
+        }
+    }
+
+    void scramble()
+    {
+        for (std::size_t i = 0; i < 8; ++i) {
+            acc[i] ^= acc[i] >> 47;
+            acc[i] ^= secret[block_stripes + i];
+            acc[i] *= prime32_1;
+        }
+    }
+};
+
+} // namespace
+
+auto content_hash(void const* data, std::size_t row_bytes, std::size_t rows,
+    std::size_t stride_bytes) -> uint64_t
+{
+    static auto const accumulate = select_accumulate();
+    auto h = hasher{accumulate};
+
+    // a row is its whole stripes followed by its tail zero padded to a
+    // stripe, the shape mixed in below tells the padding from pixels
+    auto const full = row_bytes / stripe_bytes;
+    auto const tail = row_bytes % stripe_bytes;
+    auto const base = static_cast<std::byte const*>(data);
+    for (std::size_t y = 0; y < rows; ++y) {
+        auto const row = base + y * stride_bytes;
+        h.feed(row, full);
+        if (tail) {
+            std::byte last[stripe_bytes] = {};
+            std::memcpy(last, row + full * stripe_bytes, tail);
+            h.feed(last, 1);
+        }
+    }
+
+    auto r = row_bytes * prime64_1 ^ rows * prime64_2;
+    for (std::size_t i = 0; i < 8; i += 2)
+        r += mul_fold(h.acc[i] ^ secret[block_stripes + i],
+            h.acc[i + 1] ^ secret[block_stripes + i + 1]);
+    r ^= r >> 37;
+    r *= prime64_3;
+    return r ^ (r >> 32);
+}
+
+} // namespace gtx::pixel
@@ -0,0 +1,425 @@
+#include "simd.hpp"
+#include <gtx/executor.hpp>
+#include <gtx/image.hpp>
+#include <gtx/pixel/raster.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace gtx::pixel {
+
+namespace {
+
+// resolve_fn turns a row of accumulated cells into coverage: the running
+// sum of the cells is the winding of each pixel weighted by its area
+using resolve_fn = void (*)(
+    float const* cells, uint8_t* dst, std::size_t n, bool even_odd);
+
+inline auto coverage(float s, bool even_odd) -> float
+{
+    auto a = std::abs(s);
+    if (even_odd) {
+        a -= 2.0f * std::floor(a * 0.5f);
+        a = std::min(a, 2.0f - a);
+    }
+    return std::min(a, 1.0f);
+}
+
+void scalar_resolve(
+    float const* cells, uint8_t* dst, std::size_t n, bool even_odd)
+{
+    auto s = 0.0f;
+    for (std::size_t x = 0; x < n; ++x) {
+        s += cells[x];
+        dst[x] = uint8_t(coverage(s, even_odd) * 255.0f + 0.5f);
+    }
+}
+
+#if defined(GTX_SIMD_X86)
+
+GTX_TARGET("sse4.1")
+void sse41_resolve(
+    float const* cells, uint8_t* dst, std::size_t n, bool even_odd)
+{
+    auto const sign = _mm_set1_ps(-0.0f);
+    auto const half = _mm_set1_ps(0.5f);
+    auto const one = _mm_set1_ps(1.0f);
+    auto const two = _mm_set1_ps(2.0f);
+    auto const scale = _mm_set1_ps(255.0f);
+    auto carry = _mm_setzero_ps();
+    auto x = std::size_t(0);
+    for (; x + 16 <= n; x += 16) {
+        __m128i q[4];
+        for (std::size_t j = 0; j < 4; ++j) {
+            // in-register prefix sum, then add the sum of the previous cells
+            auto v = _mm_loadu_ps(cells + x + 4 * j);
+            v = _mm_add_ps(
+                v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4)));
+            v = _mm_add_ps(
+                v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 8)));
+            v = _mm_add_ps(v, carry);
+            carry = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+
+            auto a = _mm_andnot_ps(sign, v);
+            if (even_odd) {
+                a = _mm_sub_ps(
+                    a, _mm_mul_ps(two, _mm_floor_ps(_mm_mul_ps(a, half))));
+                a = _mm_min_ps(a, _mm_sub_ps(two, a));
+            }
+            a = _mm_min_ps(a, one);
+            q[j] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(a, scale), half));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x),
+            _mm_packus_epi16(
+                _mm_packus_epi32(q[0], q[1]), _mm_packus_epi32(q[2], q[3])));
+    }
+
+    auto s = _mm_cvtss_f32(carry);
+    for (; x < n; ++x) {
+        s += cells[x];
+        dst[x] = uint8_t(coverage(s, even_odd) * 255.0f + 0.5f);
+    }
+}
+
+GTX_TARGET("avx2")
+void avx2_resolve(
+    float const* cells, uint8_t* dst, std::size_t n, bool even_odd)
+{
+    auto const sign = _mm256_set1_ps(-0.0f);
+    auto const half = _mm256_set1_ps(0.5f);
+    auto const one = _mm256_set1_ps(1.0f);
+    auto const two = _mm256_set1_ps(2.0f);
+    auto const scale = _mm256_set1_ps(255.0f);
+    auto const zero = _mm256_setzero_ps();
+    auto const lane3 = _mm256_set1_epi32(3);
+    auto const lane7 = _mm256_set1_epi32(7);
+    auto carry = _mm256_setzero_ps();
+    auto x = std::size_t(0);
+    for (; x + 16 <= n; x += 16) {
+        __m256i q[2];
+        for (std::size_t j = 0; j < 2; ++j) {
+            // prefix sum within each 128-bit lane, carry the low lane into
+            // the high one, then add the sum of the previous cells
+            auto v = _mm256_loadu_ps(cells + x + 8 * j);
+            v = _mm256_add_ps(v,
+                _mm256_castsi256_ps(
+                    _mm256_slli_si256(_mm256_castps_si256(v), 4)));
+            v = _mm256_add_ps(v,
+                _mm256_castsi256_ps(
+                    _mm256_slli_si256(_mm256_castps_si256(v), 8)));
+            v = _mm256_add_ps(v,
+                _mm256_blend_ps(
+                    zero, _mm256_permutevar8x32_ps(v, lane3), 0xf0));
+            v = _mm256_add_ps(v, carry);
+            carry = _mm256_permutevar8x32_ps(v, lane7);
+
+            auto a = _mm256_andnot_ps(sign, v);
+            if (even_odd) {
+                a = _mm256_sub_ps(a,
+                    _mm256_mul_ps(
+                        two, _mm256_floor_ps(_mm256_mul_ps(a, half))));
+                a = _mm256_min_ps(a, _mm256_sub_ps(two, a));
+            }
+            a = _mm256_min_ps(a, one);
+            q[j] = _mm256_cvttps_epi32(
+                _mm256_add_ps(_mm256_mul_ps(a, scale), half));
+        }
+        auto const a = _mm_packus_epi32(
+            _mm256_castsi256_si128(q[0]), _mm256_extracti128_si256(q[0], 1));
+        auto const b = _mm_packus_epi32(
+            _mm256_castsi256_si128(q[1]), _mm256_extracti128_si256(q[1], 1));
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(a, b));
+    }
+
+    auto s = _mm256_cvtss_f32(carry);
+    for (; x < n; ++x) {
+        s += cells[x];
+        dst[x] = uint8_t(coverage(s, even_odd) * 255.0f + 0.5f);
+    }
+}
+
+#elif defined(GTX_SIMD_NEON) && defined(__aarch64__)
+
+// vrndmq_f32 is AArch64 only
+void neon_resolve(
+    float const* cells, uint8_t* dst, std::size_t n, bool even_odd)
+{
+    auto const zero = vdupq_n_f32(0.0f);
+    auto const half = vdupq_n_f32(0.5f);
+    auto const one = vdupq_n_f32(1.0f);
+    auto const two = vdupq_n_f32(2.0f);
+    auto const scale = vdupq_n_f32(255.0f);
+    auto carry = vdupq_n_f32(0.0f);
+    auto x = std::size_t(0);
+    for (; x + 8 <= n; x += 8) {
+        uint16x4_t q[2];
+        for (std::size_t j = 0; j < 2; ++j) {
+            auto v = vld1q_f32(cells + x + 4 * j);
+            v = vaddq_f32(v, vextq_f32(zero, v, 3));
+            v = vaddq_f32(v, vextq_f32(zero, v, 2));
+            v = vaddq_f32(v, carry);
+            carry = vdupq_laneq_f32(v, 3);
+
+            auto a = vabsq_f32(v);
+            if (even_odd) {
+                a = vsubq_f32(
+                    a, vmulq_f32(two, vrndmq_f32(vmulq_f32(a, half))));
+                a = vminq_f32(a, vsubq_f32(two, a));
+            }
+            a = vminq_f32(a, one);
+            q[j] = vmovn_u32(
+                vcvtq_u32_f32(vaddq_f32(vmulq_f32(a, scale), half)));
+        }
+        vst1_u8(dst + x, vmovn_u16(vcombine_u16(q[0], q[1])));
+    }
+
+    auto s = vgetq_lane_f32(carry, 0);
+    for (; x < n; ++x) {
+        s += cells[x];
+        dst[x] = uint8_t(coverage(s, even_odd) * 255.0f + 0.5f);
+    }
+}
+
+#endif
+
+auto select_resolve() -> resolve_fn
+{
+    switch (simd::active()) {
+#if defined(GTX_SIMD_X86)
+    case simd::isa::avx2:
+        return avx2_resolve;
+    case simd::isa::sse41:
+        return sse41_resolve;
+#elif defined(GTX_SIMD_NEON) && defined(__aarch64__)
+    case simd::isa::neon:
+        return neon_resolve;
+#endif
+    default:
+        return scalar_resolve;
+    }
+}
+
+// accumulator holds one cell per pixel plus two past the end of each row,
+// lines clamped to the right edge land there and never reach the resolve
+struct accumulator {
+    float* cells;
+    std::size_t stride;
+    float w;
+    float h;
+
+    void add(std::size_t x, std::size_t y, float v)
+    {
+        cells[y * stride + x] += v;
+    }
+
+    // line splits p0 -> p1 where it crosses the left and right edges, the
+    // parts outside are moved onto the edge: as vertical lines they keep
+    // their winding for the pixels inside
+    void line(vec2<float> p0, vec2<float> p1)
+    {
+        if (p0.y == p1.y || std::max(p0.y, p1.y) <= 0.0f ||
+            std::min(p0.y, p1.y) >= h)
+            return;
+
+        float t[2];
+        auto n = 0;
+        for (auto const edge : {0.0f, w})
+            if ((p0.x - edge) * (p1.x - edge) < 0.0f)
+                t[n++] = (edge - p0.x) / (p1.x - p0.x);
+        if (n == 2 && t[0] > t[1])
+            std::swap(t[0], t[1]);
+
+        auto a = p0;
+        for (auto i = 0; i < n; ++i) {
+            auto const b = vec2<float>{
+                p0.x + (p1.x - p0.x) * t[i], p0.y + (p1.y - p0.y) * t[i]};
+            clamped(a, b);
+            a = b;
+        }
+        clamped(a, p1);
+    }
+
+    void clamped(vec2<float> a, vec2<float> b)
+    {
+        a.x = std::clamp(a.x, 0.0f, w);
+        b.x = std::clamp(b.x, 0.0f, w);
+        accumulate(a, b);
+    }
+
+    // accumulate adds the signed area of p0 -> p1 (0 <= x <= w) row by
+    // row: each pixel gets the area between the line and its right edge,
+    // the pixels further right get the full height through the prefix sum
+    void accumulate(vec2<float> p0, vec2<float> p1)
+    {
+        if (p0.y == p1.y)
+            return;
+        auto dir = 1.0f;
+        if (p0.y > p1.y) {
+            std::swap(p0, p1);
+            dir = -1.0f;
+        }
+        auto const dxdy = (p1.x - p0.x) / (p1.y - p0.y);
+        auto const y0 = std::max(p0.y, 0.0f);
+        auto const y1 = std::min(p1.y, h);
+        // x is clamped again on every row, the steps can round a little
+        // past the edges and a negative x would index the previous row
+        auto x = std::clamp(p0.x + (y0 - p0.y) * dxdy, 0.0f, w);
+
+        for (auto y = std::size_t(y0); float(y) < y1; ++y) {
+            auto const dy = std::min(float(y + 1), y1) - std::max(float(y), y0);
+            auto const xnext = std::clamp(x + dxdy * dy, 0.0f, w);
+            auto const d = dy * dir;
+            auto const x0 = std::min(x, xnext);
+            auto const x1 = std::max(x, xnext);
+            auto const x0floor = std::floor(x0);
+            auto const x0i = std::size_t(x0floor);
+            auto const x1ceil = std::ceil(x1);
+            auto const x1i = std::size_t(x1ceil);
+
+            if (x1i <= x0i + 1) {
+                // within one pixel: split by the mean x of the line
+                auto const xmf = 0.5f * (x + xnext) - x0floor;
+                add(x0i, y, d - d * xmf);
+                add(x0i + 1, y, d * xmf);
+            }
+            else {
+                // across pixels: trapezoids between the first and the last
+                auto const s = 1.0f / (x1 - x0);
+                auto const x0f = x0 - x0floor;
+                auto const a0 = 0.5f * s * (1.0f - x0f) * (1.0f - x0f);
+                auto const x1f = x1 - x1ceil + 1.0f;
+                auto const am = 0.5f * s * x1f * x1f;
+                add(x0i, y, d * a0);
+                if (x1i == x0i + 2)
+                    add(x0i + 1, y, d * (1.0f - a0 - am));
+                else {
+                    auto const a1 = s * (1.5f - x0f);
+                    add(x0i + 1, y, d * (a1 - a0));
+                    for (auto xi = x0i + 2; xi < x1i - 1; ++xi)
+                        add(xi, y, d * s);
+                    auto const a2 = a1 + float(x1i - x0i - 3) * s;
+                    add(x1i - 1, y, d * (1.0f - a2 - am));
+                }
+                add(x1i, y, d * am);
+            }
+            x = xnext;
+        }
+    }
+
+    // curves are flattened into n lines, n bounds the distance between
+    // the curve and the chords by tolerance from the second derivative
+    void quad(vec2<float> p0, vec2<float> c, vec2<float> p1, float tol)
+    {
+        auto const ddx = p0.x - 2.0f * c.x + p1.x;
+        auto const ddy = p0.y - 2.0f * c.y + p1.y;
+        auto const dd = std::sqrt(ddx * ddx + ddy * ddy);
+        auto const n = segments(std::sqrt(dd / (4.0f * tol)));
+        auto prev = p0;
+        for (auto i = 1; i < n; ++i) {
+            auto const t = float(i) / float(n);
+            auto const u = 1.0f - t;
+            auto const q =
+                vec2<float>{u * u * p0.x + 2.0f * u * t * c.x + t * t * p1.x,
+                    u * u * p0.y + 2.0f * u * t * c.y + t * t * p1.y};
+            line(prev, q);
+            prev = q;
+        }
+        line(prev, p1);
+    }
+
+    void cubic(vec2<float> p0, vec2<float> c1, vec2<float> c2, vec2<float> p1,
+        float tol)
+    {
+        auto const norm = [](float x, float y) {
+            return std::sqrt(x * x + y * y);
+        };
+        auto const dd = std::max(norm(p0.x - 2.0f * c1.x + c2.x,
+                                     p0.y - 2.0f * c1.y + c2.y),
+            norm(c1.x - 2.0f * c2.x + p1.x, c1.y - 2.0f * c2.y + p1.y));
+        auto const n = segments(std::sqrt(0.75f * dd / tol));
+        auto prev = p0;
+        for (auto i = 1; i < n; ++i) {
+            auto const t = float(i) / float(n);
+            auto const u = 1.0f - t;
+            auto const b0 = u * u * u;
+            auto const b1 = 3.0f * u * u * t;
+            auto const b2 = 3.0f * u * t * t;
+            auto const b3 = t * t * t;
+            auto const q =
+                vec2<float>{b0 * p0.x + b1 * c1.x + b2 * c2.x + b3 * p1.x,
+                    b0 * p0.y + b1 * c1.y + b2 * c2.y + b3 * p1.y};
+            line(prev, q);
+            prev = q;
+        }
+        line(prev, p1);
+    }
+
+    static auto segments(float n) -> int
+    {
+        return int(std::clamp(std::ceil(n), 1.0f, 256.0f));
+    }
+};
+
+} // namespace
+
+void fill(path const& p, surface<a8>& dst, fill_options const& opts)
+{
+    if (dst.empty())
+        return;
+
+    // the pool is constructed first so that it outlives the arena
+    default_buffer_pool();
+    thread_local scratch_arena local;
+    auto& arena = opts.arena ? *opts.arena : local;
+    auto const mark = arena.mark();
+
+    auto const w = dst.width();
+    auto const h = dst.height();
+    auto const cells = arena.allocate_array<float>((w + 2) * h);
+    std::memset(cells.data(), 0, cells.size_bytes());
+    auto acc = accumulator{cells.data(), w + 2, float(w), float(h)};
+
+    auto const tol = std::max(opts.tolerance, 1e-3f);
+    auto m = opts.m;
+    auto pts = p.points();
+    auto start = vec2<float>{};
+    auto cur = vec2<float>{};
+    for (auto const v : p.verbs()) {
+        switch (v) {
+        case path::verb::move:
+            acc.line(cur, start);
+            start = cur = m(pts[0]);
+            pts = pts.subspan(1);
+            break;
+        case path::verb::line:
+            acc.line(cur, m(pts[0]));
+            cur = m(pts[0]);
+            pts = pts.subspan(1);
+            break;
+        case path::verb::quad:
+            acc.quad(cur, m(pts[0]), m(pts[1]), tol);
+            cur = m(pts[1]);
+            pts = pts.subspan(2);
+            break;
+        case path::verb::cubic:
+            acc.cubic(cur, m(pts[0]), m(pts[1]), m(pts[2]), tol);
+            cur = m(pts[2]);
+            pts = pts.subspan(3);
+            break;
+        }
+    }
+    acc.line(cur, start);
+
+    static auto const resolve = select_resolve();
+    auto const even_odd = opts.rule == fill_rule::even_odd;
+    for (std::size_t y = 0; y < h; ++y)
+        resolve(cells.data() + y * acc.stride,
+            reinterpret_cast<uint8_t*>(dst.data() + y * dst.stride()), w,
+            even_odd);
+
+    arena.rewind(mark);
+}
+
+} // namespace gtx::pixel
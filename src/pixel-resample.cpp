@@ -0,0 +1,710 @@
+#include "simd.hpp"
+#include "strips.hpp"
+#include <gtx/image.hpp>
+#include <gtx/pixel/resample.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace gtx::pixel {
+
+namespace {
+
+template <typename T> constexpr std::size_t channels = 4;
+template <> constexpr std::size_t channels<l8> = 1;
+template <> constexpr std::size_t channels<a8> = 1;
+
+// srgb applies to the leading color channels only (b, g, r in memory order)
+template <typename T> constexpr std::size_t color_channels = 3;
+template <> constexpr std::size_t color_channels<l8> = 1;
+template <> constexpr std::size_t color_channels<a8> = 0;
+
+template <typename T> auto bytes(surface<T> const& s, std::size_t y)
+{
+    return reinterpret_cast<uint8_t*>(s.data() + y * s.stride());
+}
+
+// linear values are kept in 0..255 so both modes share the filter kernels,
+// encoding samples the linear range in 4096 steps which is within one
+// level of the exact curve
+struct srgb_tables {
+    float decode[256];
+    uint8_t encode[4096];
+
+    srgb_tables()
+    {
+        for (int i = 0; i < 256; ++i) {
+            auto const c = i / 255.0;
+            auto const l =
+                c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+            decode[i] = float(l * 255.0);
+        }
+        for (int i = 0; i < 4096; ++i) {
+            auto const l = i / 4095.0;
+            auto const c = l <= 0.0031308
+                               ? l * 12.92
+                               : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+            encode[i] = uint8_t(c * 255.0 + 0.5);
+        }
+    }
+};
+
+auto srgb_lut() -> srgb_tables const&
+{
+    static srgb_tables const tables;
+    return tables;
+}
+
+auto radius(filter f) -> double
+{
+    switch (f) {
+    case filter::box:
+        return 0.5;
+    case filter::bilinear:
+        return 1.0;
+    case filter::lanczos3:
+        return 3.0;
+    }
+    return 1.0;
+}
+
+auto weight(filter f, double x) -> double
+{
+    constexpr auto pi = 3.14159265358979323846;
+    switch (f) {
+    case filter::box:
+        // half open so that neighbouring samples do not both cover x
+        return x > -0.5 && x <= 0.5 ? 1.0 : 0.0;
+    case filter::bilinear:
+        x = std::abs(x);
+        return x < 1.0 ? 1.0 - x : 0.0;
+    case filter::lanczos3:
+        x = std::abs(x);
+        if (x < 1e-8)
+            return 1.0;
+        if (x >= 3.0)
+            return 0.0;
+        return 3.0 * std::sin(pi * x) * std::sin(pi * x / 3.0) /
+               (pi * pi * x * x);
+    }
+    return 0.0;
+}
+
+// taps holds the filter weights of one axis, every output sample reads n
+// consecutive source samples starting at first[i], source indices beyond
+// the edges are clamped by folding their weights into the edge samples
+struct taps {
+    std::size_t n = 0;
+    std::vector<std::size_t> first;
+    std::vector<float> weights;
+};
+
+auto make_taps(std::size_t src, std::size_t dst, filter f) -> taps
+{
+    auto const scale = double(src) / double(dst);
+    auto const fscale = std::max(scale, 1.0);
+    auto const support = radius(f) * fscale;
+    auto const last = std::ptrdiff_t(src) - 1;
+
+    auto t = taps{};
+    t.n = std::min(std::size_t(std::ceil(2.0 * support)) + 2, src);
+    t.first.resize(dst);
+    t.weights.resize(dst * t.n);
+
+    auto w = std::vector<double>(t.n);
+    for (std::size_t i = 0; i < dst; ++i) {
+        auto const c = (double(i) + 0.5) * scale - 0.5;
+        auto const a = std::ptrdiff_t(std::floor(c - support));
+        auto const b = std::ptrdiff_t(std::ceil(c + support));
+        auto const left =
+            std::clamp(a, std::ptrdiff_t(0), std::ptrdiff_t(src - t.n));
+        auto const slot = [&](std::ptrdiff_t j) {
+            return std::size_t(std::clamp(
+                std::clamp(j, std::ptrdiff_t(0), last) - left,
+                std::ptrdiff_t(0), std::ptrdiff_t(t.n) - 1));
+        };
+
+        std::fill(w.begin(), w.end(), 0.0);
+        auto sum = 0.0;
+        for (auto j = a; j <= b; ++j) {
+            auto const v = weight(f, (double(j) - c) / fscale);
+            if (v != 0.0) {
+                w[slot(j)] += v;
+                sum += v;
+            }
+        }
+        if (sum == 0.0) {
+            w[slot(std::ptrdiff_t(std::lround(c)))] = 1.0;
+            sum = 1.0;
+        }
+
+        t.first[i] = std::size_t(left);
+        for (std::size_t k = 0; k < t.n; ++k)
+            t.weights[i * t.n + k] = float(w[k] / sum);
+    }
+    return t;
+}
+
+// the horizontal pass filters one row of unpacked floats, the vertical
+// pass blends n rows of the horizontal result and pack rounds the floats
+// back to bytes
+using hfilter_fn = void (*)(float const* in, float* out, taps const& t);
+using vfilter_fn = void (*)(float const* const* rows, float const* w,
+    std::size_t n, float* out, std::size_t count);
+using pack_fn = void (*)(float const* in, uint8_t* out, std::size_t count);
+using halve_fn = void (*)(
+    uint8_t const* r0, uint8_t const* r1, uint8_t* out, std::size_t count);
+
+template <std::size_t C>
+void scalar_hfilter(float const* in, float* out, taps const& t)
+{
+    auto w = t.weights.data();
+    for (std::size_t i = 0; i < t.first.size(); ++i, w += t.n) {
+        auto const p = in + t.first[i] * C;
+        float acc[C] = {};
+        for (std::size_t k = 0; k < t.n; ++k)
+            for (std::size_t c = 0; c < C; ++c)
+                acc[c] += w[k] * p[k * C + c];
+        for (std::size_t c = 0; c < C; ++c)
+            out[i * C + c] = acc[c];
+    }
+}
+
+inline void vfilter_tail(float const* const* rows, float const* w,
+    std::size_t n, float* out, std::size_t i, std::size_t count)
+{
+    for (; i < count; ++i) {
+        auto acc = 0.0f;
+        for (std::size_t k = 0; k < n; ++k)
+            acc += w[k] * rows[k][i];
+        out[i] = acc;
+    }
+}
+
+void scalar_vfilter(float const* const* rows, float const* w, std::size_t n,
+    float* out, std::size_t count)
+{
+    vfilter_tail(rows, w, n, out, 0, count);
+}
+
+inline void pack_tail(
+    float const* in, uint8_t* out, std::size_t i, std::size_t count)
+{
+    // nearbyint rounds to even like the vector conversions
+    for (; i < count; ++i)
+        out[i] = uint8_t(std::clamp(std::nearbyint(in[i]), 0.0f, 255.0f));
+}
+
+void scalar_pack(float const* in, uint8_t* out, std::size_t count)
+{
+    pack_tail(in, out, 0, count);
+}
+
+inline void scalar_halve4_tail(uint8_t const* r0, uint8_t const* r1,
+    uint8_t* out, std::size_t i, std::size_t count)
+{
+    for (; i < count; ++i)
+        for (std::size_t c = 0; c < 4; ++c) {
+            auto const s = 8 * i + c;
+            out[4 * i + c] =
+                uint8_t((r0[s] + r0[s + 4] + r1[s] + r1[s + 4] + 2) >> 2);
+        }
+}
+
+void scalar_halve4(
+    uint8_t const* r0, uint8_t const* r1, uint8_t* out, std::size_t count)
+{
+    scalar_halve4_tail(r0, r1, out, 0, count);
+}
+
+inline void scalar_halve1_tail(uint8_t const* r0, uint8_t const* r1,
+    uint8_t* out, std::size_t i, std::size_t count)
+{
+    for (; i < count; ++i) {
+        auto const s = 2 * i;
+        out[i] = uint8_t((r0[s] + r0[s + 1] + r1[s] + r1[s + 1] + 2) >> 2);
+    }
+}
+
+void scalar_halve1(
+    uint8_t const* r0, uint8_t const* r1, uint8_t* out, std::size_t count)
+{
+    scalar_halve1_tail(r0, r1, out, 0, count);
+}
+
+#if defined(GTX_SIMD_X86)
+
+GTX_TARGET("sse4.1")
+void sse41_hfilter4(float const* in, float* out, taps const& t)
+{
+    auto w = t.weights.data();
+    for (std::size_t i = 0; i < t.first.size(); ++i, w += t.n) {
+        auto const p = in + t.first[i] * 4;
+        auto acc = _mm_setzero_ps();
+        for (std::size_t k = 0; k < t.n; ++k)
+            acc = _mm_add_ps(
+                acc, _mm_mul_ps(_mm_set1_ps(w[k]), _mm_loadu_ps(p + k * 4)));
+        _mm_storeu_ps(out + i * 4, acc);
+    }
+}
+
+GTX_TARGET("sse4.1")
+void sse41_vfilter(float const* const* rows, float const* w, std::size_t n,
+    float* out, std::size_t count)
+{
+    auto i = std::size_t(0);
+    for (; i + 8 <= count; i += 8) {
+        auto a = _mm_setzero_ps();
+        auto b = _mm_setzero_ps();
+        for (std::size_t k = 0; k < n; ++k) {
+            auto const wk = _mm_set1_ps(w[k]);
+            a = _mm_add_ps(a, _mm_mul_ps(wk, _mm_loadu_ps(rows[k] + i)));
+            b = _mm_add_ps(b, _mm_mul_ps(wk, _mm_loadu_ps(rows[k] + i + 4)));
+        }
+        _mm_storeu_ps(out + i, a);
+        _mm_storeu_ps(out + i + 4, b);
+    }
+    vfilter_tail(rows, w, n, out, i, count);
+}
+
+GTX_TARGET("sse4.1")
+void sse41_pack(float const* in, uint8_t* out, std::size_t count)
+{
+    auto i = std::size_t(0);
+    for (; i + 16 <= count; i += 16) {
+        auto const a = _mm_cvtps_epi32(_mm_loadu_ps(in + i));
+        auto const b = _mm_cvtps_epi32(_mm_loadu_ps(in + i + 4));
+        auto const c = _mm_cvtps_epi32(_mm_loadu_ps(in + i + 8));
+        auto const d = _mm_cvtps_epi32(_mm_loadu_ps(in + i + 12));
+        auto const p =
+            _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), p);
+    }
+    pack_tail(in, out, i, count);
+}
+
+// sse41_quad_sums returns the 16-bit sums of the 2x2 blocks of four
+// pixels from two rows, two output pixels per register
+GTX_TARGET("sse4.1")
+inline auto sse41_quad_sums(__m128i a, __m128i b) -> __m128i
+{
+    auto const zero = _mm_setzero_si128();
+    auto const lo =
+        _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+    auto const hi =
+        _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+    return _mm_unpacklo_epi64(_mm_add_epi16(lo, _mm_srli_si128(lo, 8)),
+        _mm_add_epi16(hi, _mm_srli_si128(hi, 8)));
+}
+
+GTX_TARGET("sse4.1")
+void sse41_halve4(
+    uint8_t const* r0, uint8_t const* r1, uint8_t* out, std::size_t count)
+{
+    auto const two = _mm_set1_epi16(2);
+    auto i = std::size_t(0);
+    for (; i + 4 <= count; i += 4) {
+        auto const a = reinterpret_cast<__m128i const*>(r0 + 8 * i);
+        auto const b = reinterpret_cast<__m128i const*>(r1 + 8 * i);
+        auto const x = sse41_quad_sums(_mm_loadu_si128(a), _mm_loadu_si128(b));
+        auto const y =
+            sse41_quad_sums(_mm_loadu_si128(a + 1), _mm_loadu_si128(b + 1));
+        auto const p =
+            _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(x, two), 2),
+                _mm_srli_epi16(_mm_add_epi16(y, two), 2));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * i), p);
+    }
+    scalar_halve4_tail(r0, r1, out, i, count);
+}
+
+GTX_TARGET("sse4.1")
+void sse41_halve1(
+    uint8_t const* r0, uint8_t const* r1, uint8_t* out, std::size_t count)
+{
+    auto const ones = _mm_set1_epi8(1);
+    auto const two = _mm_set1_epi16(2);
+    auto i = std::size_t(0);
+    for (; i + 16 <= count; i += 16) {
+        auto const a = reinterpret_cast<__m128i const*>(r0 + 2 * i);
+        auto const b = reinterpret_cast<__m128i const*>(r1 + 2 * i);
+        auto const lo =
+            _mm_add_epi16(_mm_maddubs_epi16(_mm_loadu_si128(a), ones),
+                _mm_maddubs_epi16(_mm_loadu_si128(b), ones));
+        auto const hi =
+            _mm_add_epi16(_mm_maddubs_epi16(_mm_loadu_si128(a + 1), ones),
+                _mm_maddubs_epi16(_mm_loadu_si128(b + 1), ones));
+        auto const p =
+            _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(lo, two), 2),
+                _mm_srli_epi16(_mm_add_epi16(hi, two), 2));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), p);
+    }
+    scalar_halve1_tail(r0, r1, out, i, count);
+}
+
+// two taps per iteration, the upper lane accumulates the odd taps
+GTX_TARGET("avx2")
+void avx2_hfilter4(float const* in, float* out, taps const& t)
+{
+    auto w = t.weights.data();
+    for (std::size_t i = 0; i < t.first.size(); ++i, w += t.n) {
+        auto const p = in + t.first[i] * 4;
+        auto acc = _mm256_setzero_ps();
+        auto k = std::size_t(0);
+        for (; k + 2 <= t.n; k += 2) {
+            auto const wk =
+                _mm256_set_m128(_mm_set1_ps(w[k + 1]), _mm_set1_ps(w[k]));
+            acc = _mm256_add_ps(
+                acc, _mm256_mul_ps(wk, _mm256_loadu_ps(p + k * 4)));
+        }
+        auto sum = _mm_add_ps(
+            _mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        if (k < t.n)
+            sum = _mm_add_ps(
+                sum, _mm_mul_ps(_mm_set1_ps(w[k]), _mm_loadu_ps(p + k * 4)));
+        _mm_storeu_ps(out + i * 4, sum);
+    }
+}
+
+GTX_TARGET("avx2")
+void avx2_vfilter(float const* const* rows, float const* w, std::size_t n,
+    float* out, std::size_t count)
+{
+    auto i = std::size_t(0);
+    for (; i + 16 <= count; i += 16) {
+        auto a = _mm256_setzero_ps();
+        auto b = _mm256_setzero_ps();
+        for (std::size_t k = 0; k < n; ++k) {
+            auto const wk = _mm256_set1_ps(w[k]);
+            a = _mm256_add_ps(
+                a, _mm256_mul_ps(wk, _mm256_loadu_ps(rows[k] + i)));
+            b = _mm256_add_ps(
+                b, _mm256_mul_ps(wk, _mm256_loadu_ps(rows[k] + i + 8)));
+        }
+        _mm256_storeu_ps(out + i, a);
+        _mm256_storeu_ps(out + i + 8, b);
+    }
+    vfilter_tail(rows, w, n, out, i, count);
+}
+
+GTX_TARGET("avx2")
+void avx2_pack(float const* in, uint8_t* out, std::size_t count)
+{
+    // the packs interleave 128-bit lanes, the permute restores the order
+    auto const order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    auto i = std::size_t(0);
+    for (; i + 32 <= count; i += 32) {
+        auto const a = _mm256_cvtps_epi32(_mm256_loadu_ps(in + i));
+        auto const b = _mm256_cvtps_epi32(_mm256_loadu_ps(in + i + 8));
+        auto const c = _mm256_cvtps_epi32(_mm256_loadu_ps(in + i + 16));
+        auto const d = _mm256_cvtps_epi32(_mm256_loadu_ps(in + i + 24));
+        auto const p = _mm256_packus_epi16(
+            _mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+            _mm256_permutevar8x32_epi32(p, order));
+    }
+    pack_tail(in, out, i, count);
+}
+
+GTX_TARGET("avx2")
+inline auto avx2_quad_sums(__m256i a, __m256i b) -> __m256i
+{
+    auto const zero = _mm256_setzero_si256();
+    auto const lo = _mm256_add_epi16(
+        _mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero));
+    auto const hi = _mm256_add_epi16(
+        _mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero));
+    return _mm256_unpacklo_epi64(_mm256_add_epi16(lo, _mm256_srli_si256(lo, 8)),
+        _mm256_add_epi16(hi, _mm256_srli_si256(hi, 8)));
+}
+
+GTX_TARGET("avx2")
+void avx2_halve4(
+    uint8_t const* r0, uint8_t const* r1, uint8_t* out, std::size_t count)
+{
+    auto const two = _mm256_set1_epi16(2);
+    auto i = std::size_t(0);
+    for (; i + 8 <= count; i += 8) {
+        auto const a = reinterpret_cast<__m256i const*>(r0 + 8 * i);
+        auto const b = reinterpret_cast<__m256i const*>(r1 + 8 * i);
+        auto const x =
+            avx2_quad_sums(_mm256_loadu_si256(a), _mm256_loadu_si256(b));
+        auto const y = avx2_quad_sums(
+            _mm256_loadu_si256(a + 1), _mm256_loadu_si256(b + 1));
+        auto const p = _mm256_packus_epi16(
+            _mm256_srli_epi16(_mm256_add_epi16(x, two), 2),
+            _mm256_srli_epi16(_mm256_add_epi16(y, two), 2));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 4 * i),
+            _mm256_permute4x64_epi64(p, 0xd8));
+    }
+    scalar_halve4_tail(r0, r1, out, i, count);
+}
+
+GTX_TARGET("avx2")
+void avx2_halve1(
+    uint8_t const* r0, uint8_t const* r1, uint8_t* out, std::size_t count)
+{
+    auto const ones = _mm256_set1_epi8(1);
+    auto const two = _mm256_set1_epi16(2);
+    auto i = std::size_t(0);
+    for (; i + 32 <= count; i += 32) {
+        auto const a = reinterpret_cast<__m256i const*>(r0 + 2 * i);
+        auto const b = reinterpret_cast<__m256i const*>(r1 + 2 * i);
+        auto const lo = _mm256_add_epi16(
+            _mm256_maddubs_epi16(_mm256_loadu_si256(a), ones),
+            _mm256_maddubs_epi16(_mm256_loadu_si256(b), ones));
+        auto const hi = _mm256_add_epi16(
+            _mm256_maddubs_epi16(_mm256_loadu_si256(a + 1), ones),
+            _mm256_maddubs_epi16(_mm256_loadu_si256(b + 1), ones));
+        auto const p = _mm256_packus_epi16(
+            _mm256_srli_epi16(_mm256_add_epi16(lo, two), 2),
+            _mm256_srli_epi16(_mm256_add_epi16(hi, two), 2));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+            _mm256_permute4x64_epi64(p, 0xd8));
+    }
+    scalar_halve1_tail(r0, r1, out, i, count);
+}
+
+#elif defined(GTX_SIMD_NEON)
+
+void neon_hfilter4(float const* in, float* out, taps const& t)
+{
+    auto w = t.weights.data();
+    for (std::size_t i = 0; i < t.first.size(); ++i, w += t.n) {
+        auto const p = in + t.first[i] * 4;
+        auto acc = vdupq_n_f32(0.0f);
+        for (std::size_t k = 0; k < t.n; ++k)
+            acc = vmlaq_n_f32(acc, vld1q_f32(p + k * 4), w[k]);
+        vst1q_f32(out + i * 4, acc);
+    }
+}
+
+void neon_vfilter(float const* const* rows, float const* w, std::size_t n,
+    float* out, std::size_t count)
+{
+    auto i = std::size_t(0);
+    for (; i + 8 <= count; i += 8) {
+        auto a = vdupq_n_f32(0.0f);
+        auto b = vdupq_n_f32(0.0f);
+        for (std::size_t k = 0; k < n; ++k) {
+            a = vmlaq_n_f32(a, vld1q_f32(rows[k] + i), w[k]);
+            b = vmlaq_n_f32(b, vld1q_f32(rows[k] + i + 4), w[k]);
+        }
+        vst1q_f32(out + i, a);
+        vst1q_f32(out + i + 4, b);
+    }
+    vfilter_tail(rows, w, n, out, i, count);
+}
+
+// rounds half up where the scalar tail rounds half to even, the results
+// differ only for exact .5 values
+inline auto neon_pack4(float32x4_t v) -> uint16x4_t
+{
+    v = vminq_f32(vmaxq_f32(v, vdupq_n_f32(0.0f)), vdupq_n_f32(255.0f));
+    return vmovn_u32(vcvtq_u32_f32(vaddq_f32(v, vdupq_n_f32(0.5f))));
+}
+
+void neon_pack(float const* in, uint8_t* out, std::size_t count)
+{
+    auto i = std::size_t(0);
+    for (; i + 8 <= count; i += 8) {
+        auto const p = vcombine_u16(
+            neon_pack4(vld1q_f32(in + i)), neon_pack4(vld1q_f32(in + i + 4)));
+        vst1_u8(out + i, vmovn_u16(p));
+    }
+    pack_tail(in, out, i, count);
+}
+
+// vld2 splits even and odd pixels so the horizontal pairs line up
+void neon_halve4(
+    uint8_t const* r0, uint8_t const* r1, uint8_t* out, std::size_t count)
+{
+    auto i = std::size_t(0);
+    for (; i + 4 <= count; i += 4) {
+        auto const a = vld2q_u32(reinterpret_cast<uint32_t const*>(r0) + 2 * i);
+        auto const b = vld2q_u32(reinterpret_cast<uint32_t const*>(r1) + 2 * i);
+        auto const a0 = vreinterpretq_u8_u32(a.val[0]);
+        auto const a1 = vreinterpretq_u8_u32(a.val[1]);
+        auto const b0 = vreinterpretq_u8_u32(b.val[0]);
+        auto const b1 = vreinterpretq_u8_u32(b.val[1]);
+        auto const lo = vaddq_u16(vaddl_u8(vget_low_u8(a0), vget_low_u8(a1)),
+            vaddl_u8(vget_low_u8(b0), vget_low_u8(b1)));
+        auto const hi = vaddq_u16(vaddl_u8(vget_high_u8(a0), vget_high_u8(a1)),
+            vaddl_u8(vget_high_u8(b0), vget_high_u8(b1)));
+        vst1q_u8(out + 4 * i,
+            vcombine_u8(vrshrn_n_u16(lo, 2), vrshrn_n_u16(hi, 2)));
+    }
+    scalar_halve4_tail(r0, r1, out, i, count);
+}
+
+void neon_halve1(
+    uint8_t const* r0, uint8_t const* r1, uint8_t* out, std::size_t count)
+{
+    auto i = std::size_t(0);
+    for (; i + 16 <= count; i += 16) {
+        auto const lo = vpadalq_u8(
+            vpaddlq_u8(vld1q_u8(r0 + 2 * i)), vld1q_u8(r1 + 2 * i));
+        auto const hi = vpadalq_u8(
+            vpaddlq_u8(vld1q_u8(r0 + 2 * i + 16)), vld1q_u8(r1 + 2 * i + 16));
+        vst1q_u8(
+            out + i, vcombine_u8(vrshrn_n_u16(lo, 2), vrshrn_n_u16(hi, 2)));
+    }
+    scalar_halve1_tail(r0, r1, out, i, count);
+}
+
+#endif
+
+struct kernels {
+    hfilter_fn hfilter;
+    vfilter_fn vfilter;
+    pack_fn pack;
+    halve_fn halve;
+};
+
+// the single channel horizontal pass stays scalar, its inner loop is a
+// short dot product which does not pay for a vector reduction
+template <std::size_t C> auto select_kernels() -> kernels
+{
+    auto const h4 = C == 4;
+    switch (simd::active()) {
+#if defined(GTX_SIMD_X86)
+    case simd::isa::avx2:
+        return {h4 ? avx2_hfilter4 : scalar_hfilter<C>, avx2_vfilter,
+            avx2_pack, h4 ? avx2_halve4 : avx2_halve1};
+    case simd::isa::sse41:
+        return {h4 ? sse41_hfilter4 : scalar_hfilter<C>, sse41_vfilter,
+            sse41_pack, h4 ? sse41_halve4 : sse41_halve1};
+#elif defined(GTX_SIMD_NEON)
+    case simd::isa::neon:
+        return {h4 ? neon_hfilter4 : scalar_hfilter<C>, neon_vfilter,
+            neon_pack, h4 ? neon_halve4 : neon_halve1};
+#endif
+    default:
+        return {scalar_hfilter<C>, scalar_vfilter, scalar_pack,
+            h4 ? scalar_halve4 : scalar_halve1};
+    }
+}
+
+template <std::size_t C> auto active_kernels() -> kernels const&
+{
+    static auto const k = select_kernels<C>();
+    return k;
+}
+
+template <std::size_t C, std::size_t Color>
+void unpack(uint8_t const* in, float* out, std::size_t w, bool srgb)
+{
+    if (!srgb) {
+        for (std::size_t i = 0; i < w * C; ++i)
+            out[i] = float(in[i]);
+        return;
+    }
+    auto const& decode = srgb_lut().decode;
+    for (std::size_t i = 0; i < w * C; i += C)
+        for (std::size_t c = 0; c < C; ++c)
+            out[i + c] = c < Color ? decode[in[i + c]] : float(in[i + c]);
+}
+
+template <std::size_t C, std::size_t Color>
+void encode(float const* in, uint8_t* out, std::size_t w)
+{
+    auto const& table = srgb_lut().encode;
+    for (std::size_t i = 0; i < w * C; i += C) {
+        for (std::size_t c = 0; c < Color; ++c) {
+            auto const v = std::clamp(in[i + c] * (4095.0f / 255.0f) + 0.5f,
+                0.0f, 4095.0f);
+            out[i + c] = table[std::size_t(v)];
+        }
+        pack_tail(in + i, out + i, Color, C);
+    }
+}
+
+} // namespace
+
+template <typename T>
+void resample(
+    surface<T> const& src, surface<T>& dst, resample_options const& opts)
+{
+    constexpr auto C = channels<T>;
+    constexpr auto Color = color_channels<T>;
+    static_assert(sizeof(T) == C);
+
+    if (src.empty() || dst.empty())
+        return;
+
+    auto const& k = active_kernels<C>();
+    auto const srgb = opts.srgb && Color;
+    auto const sw = src.width();
+    auto const sh = src.height();
+    auto const dw = dst.width();
+    auto const dh = dst.height();
+    auto const htaps = make_taps(sw, dw, opts.filter);
+    auto const vtaps = make_taps(sh, dh, opts.filter);
+
+    // horizontal pass over every source row
+    auto mid = image<float>(dw * C, sh);
+    detail::for_each_strip(src, detail::strip_pixels, opts.exec,
+        [&](std::size_t y0, std::size_t y1, scratch_arena& arena) {
+            auto const row = arena.allocate_array<float>(sw * C).data();
+            for (auto y = y0; y < y1; ++y) {
+                unpack<C, Color>(bytes(src, y), row, sw, srgb);
+                k.hfilter(row, mid.row(y), htaps);
+            }
+        });
+
+    // vertical pass per destination row, its cost grows with the taps
+    detail::for_each_strip(dst, detail::strip_pixels / vtaps.n, opts.exec,
+        [&](std::size_t y0, std::size_t y1, scratch_arena& arena) {
+            auto const row = arena.allocate_array<float>(dw * C).data();
+            auto const r = arena.allocate_array<float const*>(vtaps.n).data();
+            for (auto y = y0; y < y1; ++y) {
+                for (std::size_t i = 0; i < vtaps.n; ++i)
+                    r[i] = mid.row(vtaps.first[y] + i);
+                k.vfilter(r, vtaps.weights.data() + y * vtaps.n, vtaps.n, row,
+                    dw * C);
+                if (srgb)
+                    encode<C, Color>(row, bytes(dst, y), dw);
+                else
+                    k.pack(row, bytes(dst, y), dw * C);
+            }
+        });
+}
+
+template <typename T>
+void halve(surface<T> const& src, surface<T>& dst, bool srgb, executor* exec)
+{
+    constexpr auto C = channels<T>;
+
+    auto const w = std::min(src.width() / 2, dst.width());
+    auto const h = std::min(src.height() / 2, dst.height());
+    if (!w || !h || !src.data() || !dst.data())
+        return;
+
+    if (srgb && color_channels<T>) {
+        // the box filter at exactly half size averages the same blocks
+        resample(src.subsurface(0, 0, 2 * w, 2 * h),
+            dst.subsurface(0, 0, w, h), {filter::box, true, exec});
+        return;
+    }
+
+    auto const fn = active_kernels<C>().halve;
+    detail::for_each_strip(dst.subsurface(0, 0, w, h), detail::strip_pixels,
+        exec, [&](std::size_t y0, std::size_t y1, scratch_arena&) {
+            for (auto y = y0; y < y1; ++y)
+                fn(bytes(src, 2 * y), bytes(src, 2 * y + 1), bytes(dst, y), w);
+        });
+}
+
+#define GTX_RESAMPLE(T)                                                        \
+    template void resample(                                                    \
+        surface<T> const&, surface<T>&, resample_options const&);              \
+    template void halve(surface<T> const&, surface<T>&, bool, executor*);
+
+GTX_RESAMPLE(nargb8888)
+GTX_RESAMPLE(xrgb8888)
+GTX_RESAMPLE(l8)
+GTX_RESAMPLE(a8)
+
+#undef GTX_RESAMPLE
+
+} // namespace gtx::pixel
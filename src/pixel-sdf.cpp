@@ -0,0 +1,226 @@
+#include "simd.hpp"
+#include <gtx/executor.hpp>
+#include <gtx/pixel/sdf.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace gtx::pixel {
+
+namespace {
+
+constexpr float far = 1e20f;
+
+// lines handled by one task of the separable passes
+constexpr std::size_t lines_per_task = 16;
+
+// encode_fn writes a row of the field from the squared distances to the
+// shape (o) and to the background (i): trunc(clamp(d * k + 128, 0, 255))
+// with d = sqrt(o) - sqrt(i), the distance to the edge positive outside
+using encode_fn = void (*)(float const* o, float const* i, uint8_t* dst,
+    std::size_t n, float k);
+
+void scalar_encode(
+    float const* o, float const* i, uint8_t* dst, std::size_t n, float k)
+{
+    for (std::size_t x = 0; x < n; ++x) {
+        auto const v = (std::sqrt(o[x]) - std::sqrt(i[x])) * k + 128.0f;
+        dst[x] = uint8_t(std::min(std::max(v, 0.0f), 255.0f));
+    }
+}
+
+#if defined(GTX_SIMD_X86)
+
+GTX_TARGET("sse4.1")
+void sse41_encode(
+    float const* o, float const* i, uint8_t* dst, std::size_t n, float k)
+{
+    auto const vk = _mm_set1_ps(k);
+    auto const bias = _mm_set1_ps(128.0f);
+    auto const lo = _mm_setzero_ps();
+    auto const hi = _mm_set1_ps(255.0f);
+    auto x = std::size_t(0);
+    for (; x + 16 <= n; x += 16) {
+        __m128i q[4];
+        for (std::size_t j = 0; j < 4; ++j) {
+            auto const d = _mm_sub_ps(_mm_sqrt_ps(_mm_loadu_ps(o + x + 4 * j)),
+                _mm_sqrt_ps(_mm_loadu_ps(i + x + 4 * j)));
+            auto const v = _mm_add_ps(_mm_mul_ps(d, vk), bias);
+            q[j] = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(v, lo), hi));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x),
+            _mm_packus_epi16(
+                _mm_packus_epi32(q[0], q[1]), _mm_packus_epi32(q[2], q[3])));
+    }
+    scalar_encode(o + x, i + x, dst + x, n - x, k);
+}
+
+GTX_TARGET("avx2")
+void avx2_encode(
+    float const* o, float const* i, uint8_t* dst, std::size_t n, float k)
+{
+    auto const vk = _mm256_set1_ps(k);
+    auto const bias = _mm256_set1_ps(128.0f);
+    auto const lo = _mm256_setzero_ps();
+    auto const hi = _mm256_set1_ps(255.0f);
+    auto x = std::size_t(0);
+    for (; x + 16 <= n; x += 16) {
+        __m256i q[2];
+        for (std::size_t j = 0; j < 2; ++j) {
+            auto const d =
+                _mm256_sub_ps(_mm256_sqrt_ps(_mm256_loadu_ps(o + x + 8 * j)),
+                    _mm256_sqrt_ps(_mm256_loadu_ps(i + x + 8 * j)));
+            auto const v = _mm256_add_ps(_mm256_mul_ps(d, vk), bias);
+            q[j] =
+                _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(v, lo), hi));
+        }
+        auto const a = _mm_packus_epi32(
+            _mm256_castsi256_si128(q[0]), _mm256_extracti128_si256(q[0], 1));
+        auto const b = _mm_packus_epi32(
+            _mm256_castsi256_si128(q[1]), _mm256_extracti128_si256(q[1], 1));
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(a, b));
+    }
+    scalar_encode(o + x, i + x, dst + x, n - x, k);
+}
+
+#elif defined(GTX_SIMD_NEON) && defined(__aarch64__)
+
+// vsqrtq_f32 is AArch64 only
+void neon_encode(
+    float const* o, float const* i, uint8_t* dst, std::size_t n, float k)
+{
+    auto const vk = vdupq_n_f32(k);
+    auto const bias = vdupq_n_f32(128.0f);
+    auto const lo = vdupq_n_f32(0.0f);
+    auto const hi = vdupq_n_f32(255.0f);
+    auto x = std::size_t(0);
+    for (; x + 8 <= n; x += 8) {
+        uint16x4_t q[2];
+        for (std::size_t j = 0; j < 2; ++j) {
+            auto const d = vsubq_f32(vsqrtq_f32(vld1q_f32(o + x + 4 * j)),
+                vsqrtq_f32(vld1q_f32(i + x + 4 * j)));
+            auto const v = vaddq_f32(vmulq_f32(d, vk), bias);
+            q[j] = vmovn_u32(vcvtq_u32_f32(vminq_f32(vmaxq_f32(v, lo), hi)));
+        }
+        vst1_u8(dst + x, vmovn_u16(vcombine_u16(q[0], q[1])));
+    }
+    scalar_encode(o + x, i + x, dst + x, n - x, k);
+}
+
+#endif
+
+auto select_encode() -> encode_fn
+{
+    switch (simd::active()) {
+#if defined(GTX_SIMD_X86)
+    case simd::isa::avx2:
+        return avx2_encode;
+    case simd::isa::sse41:
+        return sse41_encode;
+#elif defined(GTX_SIMD_NEON) && defined(__aarch64__)
+    case simd::isa::neon:
+        return neon_encode;
+#endif
+    default:
+        return scalar_encode;
+    }
+}
+
+// transform replaces f[0..n) (stride apart) with its 1D squared distance
+// transform: min over q of (p - q)^2 + f[q], the lower envelope of the
+// parabolas rooted at each sample is built first and then sampled
+void transform(float* f, std::size_t stride, std::size_t n, float* g,
+    uint32_t* v, float* z)
+{
+    for (std::size_t q = 0; q < n; ++q)
+        g[q] = f[q * stride];
+
+    auto k = std::size_t(0);
+    v[0] = 0;
+    z[0] = -far;
+    z[1] = far;
+    for (std::size_t q = 1; q < n; ++q) {
+        // where the parabola of q crosses the last one of the envelope,
+        // z[0] is below every crossing so the loop stops at the first
+        auto const fq = g[q] + float(q) * float(q);
+        auto const cross = [&](uint32_t r) {
+            return (fq - g[r] - float(r) * float(r)) / (2.0f * float(q - r));
+        };
+        auto s = cross(v[k]);
+        while (s <= z[k])
+            s = cross(v[--k]);
+        ++k;
+        v[k] = uint32_t(q);
+        z[k] = s;
+        z[k + 1] = far;
+    }
+
+    k = 0;
+    for (std::size_t q = 0; q < n; ++q) {
+        while (z[k + 1] < float(q))
+            ++k;
+        auto const d = float(q) - float(v[k]);
+        f[q * stride] = d * d + g[v[k]];
+    }
+}
+
+// transform_2d runs the transform on the columns and then on the rows of
+// a w x h grid
+void transform_2d(float* grid, std::size_t w, std::size_t h, executor& ex)
+{
+    auto const run = [&](std::size_t lines, std::size_t n,
+                         std::size_t line_step, std::size_t stride) {
+        ex.parallel_for((lines + lines_per_task - 1) / lines_per_task,
+            [&](std::size_t t, scratch_arena& arena) {
+                auto g = arena.allocate_array<float>(n);
+                auto v = arena.allocate_array<uint32_t>(n);
+                auto z = arena.allocate_array<float>(n + 1);
+                auto const end = std::min(lines, (t + 1) * lines_per_task);
+                for (auto l = t * lines_per_task; l < end; ++l)
+                    transform(grid + l * line_step, stride, n, g.data(),
+                        v.data(), z.data());
+            });
+    };
+    run(w, h, 1, w);
+    run(h, w, w, 1);
+}
+
+} // namespace
+
+void sdf(surface<a8> const& src, surface<a8>& dst, sdf_options const& opts)
+{
+    auto const w = std::min(src.width(), dst.width());
+    auto const h = std::min(src.height(), dst.height());
+    if (!w || !h || src.empty() || dst.empty())
+        return;
+
+    auto& ex = opts.exec ? *opts.exec : default_executor();
+
+    // squared distances to the shape and to the background, the edge of a
+    // partially covered pixel is 0.5 - coverage away
+    auto shape = std::vector<float>(w * h);
+    auto background = std::vector<float>(w * h);
+    for (std::size_t y = 0; y < h; ++y) {
+        auto const s = src.data() + y * src.stride();
+        auto const o = shape.data() + y * w;
+        auto const i = background.data() + y * w;
+        for (std::size_t x = 0; x < w; ++x) {
+            auto const a = float(s[x].value) / 255.0f;
+            auto const d = 0.5f - a;
+            o[x] = a >= 1.0f ? 0.0f : a <= 0.0f ? far : d > 0 ? d * d : 0.0f;
+            i[x] = a <= 0.0f ? 0.0f : a >= 1.0f ? far : d < 0 ? d * d : 0.0f;
+        }
+    }
+    transform_2d(shape.data(), w, h, ex);
+    transform_2d(background.data(), w, h, ex);
+
+    static auto const encode = select_encode();
+    auto const k = -255.0f / (2.0f * std::max(opts.radius, 1e-3f));
+    for (std::size_t y = 0; y < h; ++y)
+        encode(shape.data() + y * w, background.data() + y * w,
+            reinterpret_cast<uint8_t*>(dst.data() + y * dst.stride()), w, k);
+}
+
+} // namespace gtx::pixel
@@ -0,0 +1,296 @@
+#include "simd.hpp"
+#include <gtx/pixel/trim.hpp>
+
+#include <bit>
+
+namespace gtx::pixel {
+
+namespace {
+
+// find_fn returns the index of the first visible pixel of a row, or n,
+// rfind_fn one past the last visible pixel, or 0
+using find_fn = std::size_t (*)(void const* row, std::size_t n);
+using rfind_fn = std::size_t (*)(void const* row, std::size_t n);
+
+struct kernels {
+    find_fn find32;
+    rfind_fn rfind32;
+    find_fn find8;
+    rfind_fn rfind8;
+};
+
+auto scalar_find32(void const* row, std::size_t n) -> std::size_t
+{
+    auto const p = static_cast<uint32_t const*>(row);
+    auto i = std::size_t(0);
+    while (i < n && !(p[i] >> 24))
+        ++i;
+    return i;
+}
+
+auto scalar_rfind32(void const* row, std::size_t n) -> std::size_t
+{
+    auto const p = static_cast<uint32_t const*>(row);
+    while (n && !(p[n - 1] >> 24))
+        --n;
+    return n;
+}
+
+auto scalar_find8(void const* row, std::size_t n) -> std::size_t
+{
+    auto const p = static_cast<uint8_t const*>(row);
+    auto i = std::size_t(0);
+    while (i < n && !p[i])
+        ++i;
+    return i;
+}
+
+auto scalar_rfind8(void const* row, std::size_t n) -> std::size_t
+{
+    auto const p = static_cast<uint8_t const*>(row);
+    while (n && !p[n - 1])
+        --n;
+    return n;
+}
+
+#if defined(GTX_SIMD_X86)
+
+// the masks have a bit set per visible pixel
+
+GTX_TARGET("sse4.1")
+inline auto sse41_mask32(uint32_t const* p) -> unsigned
+{
+    auto const a = _mm_srli_epi32(_mm_loadu_si128((__m128i const*)p), 24);
+    return ~unsigned(_mm_movemask_ps(_mm_castsi128_ps(
+               _mm_cmpeq_epi32(a, _mm_setzero_si128())))) &
+           0xf;
+}
+
+GTX_TARGET("sse4.1")
+inline auto sse41_mask8(uint8_t const* p) -> unsigned
+{
+    auto const v = _mm_loadu_si128((__m128i const*)p);
+    auto const z = _mm_cmpeq_epi8(v, _mm_setzero_si128());
+    return ~unsigned(_mm_movemask_epi8(z)) & 0xffff;
+}
+
+GTX_TARGET("sse4.1")
+auto sse41_find32(void const* row, std::size_t n) -> std::size_t
+{
+    auto const p = static_cast<uint32_t const*>(row);
+    auto i = std::size_t(0);
+    for (; i + 4 <= n; i += 4)
+        if (auto const m = sse41_mask32(p + i))
+            return i + std::countr_zero(m);
+    return i + scalar_find32(p + i, n - i);
+}
+
+GTX_TARGET("sse4.1")
+auto sse41_rfind32(void const* row, std::size_t n) -> std::size_t
+{
+    auto const p = static_cast<uint32_t const*>(row);
+    for (; n >= 4; n -= 4)
+        if (auto const m = sse41_mask32(p + n - 4))
+            return n - 4 + std::bit_width(m);
+    return scalar_rfind32(p, n);
+}
+
+GTX_TARGET("sse4.1")
+auto sse41_find8(void const* row, std::size_t n) -> std::size_t
+{
+    auto const p = static_cast<uint8_t const*>(row);
+    auto i = std::size_t(0);
+    for (; i + 16 <= n; i += 16)
+        if (auto const m = sse41_mask8(p + i))
+            return i + std::countr_zero(m);
+    return i + scalar_find8(p + i, n - i);
+}
+
+GTX_TARGET("sse4.1")
+auto sse41_rfind8(void const* row, std::size_t n) -> std::size_t
+{
+    auto const p = static_cast<uint8_t const*>(row);
+    for (; n >= 16; n -= 16)
+        if (auto const m = sse41_mask8(p + n - 16))
+            return n - 16 + std::bit_width(m);
+    return scalar_rfind8(p, n);
+}
+
+GTX_TARGET("avx2")
+inline auto avx2_mask32(uint32_t const* p) -> unsigned
+{
+    auto const a =
+        _mm256_srli_epi32(_mm256_loadu_si256((__m256i const*)p), 24);
+    return ~unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(
+               _mm256_cmpeq_epi32(a, _mm256_setzero_si256())))) &
+           0xff;
+}
+
+GTX_TARGET("avx2")
+inline auto avx2_mask8(uint8_t const* p) -> unsigned
+{
+    auto const v = _mm256_loadu_si256((__m256i const*)p);
+    return ~unsigned(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_setzero_si256())));
+}
+
+GTX_TARGET("avx2")
+auto avx2_find32(void const* row, std::size_t n) -> std::size_t
+{
+    auto const p = static_cast<uint32_t const*>(row);
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8)
+        if (auto const m = avx2_mask32(p + i))
+            return i + std::countr_zero(m);
+    return i + scalar_find32(p + i, n - i);
+}
+
+GTX_TARGET("avx2")
+auto avx2_rfind32(void const* row, std::size_t n) -> std::size_t
+{
+    auto const p = static_cast<uint32_t const*>(row);
+    for (; n >= 8; n -= 8)
+        if (auto const m = avx2_mask32(p + n - 8))
+            return n - 8 + std::bit_width(m);
+    return scalar_rfind32(p, n);
+}
+
+GTX_TARGET("avx2")
+auto avx2_find8(void const* row, std::size_t n) -> std::size_t
+{
+    auto const p = static_cast<uint8_t const*>(row);
+    auto i = std::size_t(0);
+    for (; i + 32 <= n; i += 32)
+        if (auto const m = avx2_mask8(p + i))
+            return i + std::countr_zero(m);
+    return i + scalar_find8(p + i, n - i);
+}
+
+GTX_TARGET("avx2")
+auto avx2_rfind8(void const* row, std::size_t n) -> std::size_t
+{
+    auto const p = static_cast<uint8_t const*>(row);
+    for (; n >= 32; n -= 32)
+        if (auto const m = avx2_mask8(p + n - 32))
+            return n - 32 + std::bit_width(m);
+    return scalar_rfind8(p, n);
+}
+
+#elif defined(GTX_SIMD_NEON) && defined(__aarch64__)
+
+// vmaxvq is AArch64 only: a block with any visible pixel is located with
+// one reduction and then searched pixel by pixel
+
+inline auto neon_any32(uint32_t const* p) -> bool
+{
+    return vmaxvq_u32(vshrq_n_u32(vld1q_u32(p), 24)) != 0;
+}
+
+inline auto neon_any8(uint8_t const* p) -> bool
+{
+    return vmaxvq_u8(vld1q_u8(p)) != 0;
+}
+
+auto neon_find32(void const* row, std::size_t n) -> std::size_t
+{
+    auto const p = static_cast<uint32_t const*>(row);
+    auto i = std::size_t(0);
+    while (i + 4 <= n && !neon_any32(p + i))
+        i += 4;
+    return i + scalar_find32(p + i, n - i);
+}
+
+auto neon_rfind32(void const* row, std::size_t n) -> std::size_t
+{
+    auto const p = static_cast<uint32_t const*>(row);
+    while (n >= 4 && !neon_any32(p + n - 4))
+        n -= 4;
+    return scalar_rfind32(p, n);
+}
+
+auto neon_find8(void const* row, std::size_t n) -> std::size_t
+{
+    auto const p = static_cast<uint8_t const*>(row);
+    auto i = std::size_t(0);
+    while (i + 16 <= n && !neon_any8(p + i))
+        i += 16;
+    return i + scalar_find8(p + i, n - i);
+}
+
+auto neon_rfind8(void const* row, std::size_t n) -> std::size_t
+{
+    auto const p = static_cast<uint8_t const*>(row);
+    while (n >= 16 && !neon_any8(p + n - 16))
+        n -= 16;
+    return scalar_rfind8(p, n);
+}
+
+#endif
+
+auto select_kernels() -> kernels
+{
+    switch (simd::active()) {
+#if defined(GTX_SIMD_X86)
+    case simd::isa::avx2:
+        return {avx2_find32, avx2_rfind32, avx2_find8, avx2_rfind8};
+    case simd::isa::sse41:
+        return {sse41_find32, sse41_rfind32, sse41_find8, sse41_rfind8};
+#elif defined(GTX_SIMD_NEON) && defined(__aarch64__)
+    case simd::isa::neon:
+        return {neon_find32, neon_rfind32, neon_find8, neon_rfind8};
+#endif
+    default:
+        return {scalar_find32, scalar_rfind32, scalar_find8, scalar_rfind8};
+    }
+}
+
+template <typename T>
+auto bounds(surface<T> const& s, find_fn find, rfind_fn rfind) -> box
+{
+    if (s.empty())
+        return {0, 0, 0, 0};
+    auto const w = s.width();
+    auto const row = [&](std::size_t y) { return s.data() + y * s.stride(); };
+
+    auto top = std::size_t(0);
+    auto left = w;
+    while (top < s.height() && (left = find(row(top), w)) == w)
+        ++top;
+    if (top == s.height())
+        return {0, 0, 0, 0};
+
+    auto right = rfind(row(top), w);
+    auto bottom = s.height();
+    while (bottom - 1 > top && rfind(row(bottom - 1), w) == 0)
+        --bottom;
+
+    // the rows in between can only widen the box
+    for (auto y = top; y < bottom && (left || right < w); ++y) {
+        left = find(row(y), left);
+        right += rfind(row(y) + right, w - right);
+    }
+    return {unsigned(left), unsigned(top), unsigned(right - left),
+        unsigned(bottom - top)};
+}
+
+auto active_kernels() -> kernels const&
+{
+    static auto const k = select_kernels();
+    return k;
+}
+
+} // namespace
+
+auto trim_bounds(surface<nargb8888> const& s) -> box
+{
+    auto const& k = active_kernels();
+    return bounds(s, k.find32, k.rfind32);
+}
+
+auto trim_bounds(surface<a8> const& s) -> box
+{
+    auto const& k = active_kernels();
+    return bounds(s, k.find8, k.rfind8);
+}
+
+} // namespace gtx::pixel
@@ -0,0 +1,305 @@
+#include "simd.hpp"
+#include "strips.hpp"
+#include <gtx/pixel/yuv.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace gtx::pixel {
+
+namespace {
+
+// coeffs are the 16.16 fixed point factors of
+//
+//   r = ys (y - yo) + rv (v - 128)
+//   g = ys (y - yo) - gu (u - 128) - gv (v - 128)
+//   b = ys (y - yo) + bu (u - 128)
+//
+// derived from the matrix's kr and kb, with the range scaling folded in
+struct coeffs {
+    int32_t yo;
+    int32_t ys;
+    int32_t rv;
+    int32_t gu;
+    int32_t gv;
+    int32_t bu;
+};
+
+auto make_coeffs(yuv_options const& opts) -> coeffs
+{
+    auto const bt709 = opts.matrix == yuv_matrix::bt709;
+    auto const kr = bt709 ? 0.2126 : 0.299;
+    auto const kb = bt709 ? 0.0722 : 0.114;
+    auto const kg = 1.0 - kr - kb;
+    auto const full = opts.range == yuv_range::full;
+    auto const ys = full ? 1.0 : 255.0 / 219.0;
+    auto const cs = full ? 1.0 : 255.0 / 224.0;
+    auto const q = [](double v) { return int32_t(v * 65536.0 + 0.5); };
+    return {full ? 0 : 16, q(ys), q(2 * (1 - kr) * cs),
+        q(2 * kb * (1 - kb) / kg * cs), q(2 * kr * (1 - kr) / kg * cs),
+        q(2 * (1 - kb) * cs)};
+}
+
+// yuv_fn converts n pixels of a row, u and v hold the chroma of pixel i at
+// i / 2
+using yuv_fn = void (*)(uint8_t const* y, uint8_t const* u, uint8_t const* v,
+    uint32_t* dst, std::size_t n, coeffs const& c);
+
+inline auto clamp8(int32_t v) -> uint32_t
+{
+    return uint32_t(std::clamp(v, 0, 255));
+}
+
+void scalar_yuv(uint8_t const* y, uint8_t const* u, uint8_t const* v,
+    uint32_t* dst, std::size_t n, coeffs const& c)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        auto const l = (y[i] - c.yo) * c.ys + 32768;
+        auto const cb = u[i / 2] - 128;
+        auto const cr = v[i / 2] - 128;
+        dst[i] = 0xff000000 | clamp8((l + c.rv * cr) >> 16) << 16 |
+                 clamp8((l - c.gu * cb - c.gv * cr) >> 16) << 8 |
+                 clamp8((l + c.bu * cb) >> 16);
+    }
+}
+
+template <typename T> auto load(uint8_t const* p) -> T
+{
+    auto v = T{};
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+#if defined(GTX_SIMD_X86)
+
+GTX_TARGET("sse4.1")
+void sse41_yuv(uint8_t const* y, uint8_t const* u, uint8_t const* v,
+    uint32_t* dst, std::size_t n, coeffs const& c)
+{
+    auto const yo = _mm_set1_epi32(c.yo);
+    auto const ys = _mm_set1_epi32(c.ys);
+    auto const rv = _mm_set1_epi32(c.rv);
+    auto const gu = _mm_set1_epi32(c.gu);
+    auto const gv = _mm_set1_epi32(c.gv);
+    auto const bu = _mm_set1_epi32(c.bu);
+    auto const half = _mm_set1_epi32(32768);
+    auto const mid = _mm_set1_epi32(128);
+    auto const opaque = _mm_set1_epi32(255);
+    auto const dup = _mm_setr_epi8(0, 0, 1, 1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1);
+    // packus leaves the b, g, r and a bytes of 4 pixels in turn
+    auto const interleave =
+        _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    auto i = std::size_t(0);
+    for (; i + 4 <= n; i += 4) {
+        auto const yv = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(load<int>(y + i)));
+        auto const uv = _mm_cvtsi32_si128(load<uint16_t>(u + i / 2));
+        auto const vv = _mm_cvtsi32_si128(load<uint16_t>(v + i / 2));
+        auto const cb =
+            _mm_sub_epi32(_mm_cvtepu8_epi32(_mm_shuffle_epi8(uv, dup)), mid);
+        auto const cr =
+            _mm_sub_epi32(_mm_cvtepu8_epi32(_mm_shuffle_epi8(vv, dup)), mid);
+        auto const l =
+            _mm_add_epi32(_mm_mullo_epi32(_mm_sub_epi32(yv, yo), ys), half);
+        auto const r =
+            _mm_srai_epi32(_mm_add_epi32(l, _mm_mullo_epi32(cr, rv)), 16);
+        auto const g = _mm_srai_epi32(
+            _mm_sub_epi32(_mm_sub_epi32(l, _mm_mullo_epi32(cb, gu)),
+                _mm_mullo_epi32(cr, gv)),
+            16);
+        auto const b =
+            _mm_srai_epi32(_mm_add_epi32(l, _mm_mullo_epi32(cb, bu)), 16);
+        auto const p = _mm_packus_epi16(
+            _mm_packs_epi32(b, g), _mm_packs_epi32(r, opaque));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+            _mm_shuffle_epi8(p, interleave));
+    }
+    scalar_yuv(y + i, u + i / 2, v + i / 2, dst + i, n - i, c);
+}
+
+GTX_TARGET("avx2")
+void avx2_yuv(uint8_t const* y, uint8_t const* u, uint8_t const* v,
+    uint32_t* dst, std::size_t n, coeffs const& c)
+{
+    auto const yo = _mm256_set1_epi32(c.yo);
+    auto const ys = _mm256_set1_epi32(c.ys);
+    auto const rv = _mm256_set1_epi32(c.rv);
+    auto const gu = _mm256_set1_epi32(c.gu);
+    auto const gv = _mm256_set1_epi32(c.gv);
+    auto const bu = _mm256_set1_epi32(c.bu);
+    auto const half = _mm256_set1_epi32(32768);
+    auto const mid = _mm256_set1_epi32(128);
+    auto const opaque = _mm256_set1_epi32(255);
+    auto const dup = _mm_setr_epi8(
+        0, 0, 1, 1, 2, 2, 3, 3, -1, -1, -1, -1, -1, -1, -1, -1);
+    // the packs work within 128-bit lanes, each lane ends up with the
+    // b, g, r and a bytes of 4 pixels in turn
+    auto const interleave = _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6,
+        10, 14, 3, 7, 11, 15, 0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11,
+        15);
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto const yv = _mm256_cvtepu8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<__m128i const*>(y + i)));
+        auto const uv = _mm_cvtsi32_si128(load<int>(u + i / 2));
+        auto const vv = _mm_cvtsi32_si128(load<int>(v + i / 2));
+        auto const cb = _mm256_sub_epi32(
+            _mm256_cvtepu8_epi32(_mm_shuffle_epi8(uv, dup)), mid);
+        auto const cr = _mm256_sub_epi32(
+            _mm256_cvtepu8_epi32(_mm_shuffle_epi8(vv, dup)), mid);
+        auto const l = _mm256_add_epi32(
+            _mm256_mullo_epi32(_mm256_sub_epi32(yv, yo), ys), half);
+        auto const r = _mm256_srai_epi32(
+            _mm256_add_epi32(l, _mm256_mullo_epi32(cr, rv)), 16);
+        auto const g = _mm256_srai_epi32(
+            _mm256_sub_epi32(_mm256_sub_epi32(l, _mm256_mullo_epi32(cb, gu)),
+                _mm256_mullo_epi32(cr, gv)),
+            16);
+        auto const b = _mm256_srai_epi32(
+            _mm256_add_epi32(l, _mm256_mullo_epi32(cb, bu)), 16);
+        auto const p = _mm256_packus_epi16(
+            _mm256_packs_epi32(b, g), _mm256_packs_epi32(r, opaque));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+            _mm256_shuffle_epi8(p, interleave));
+    }
+    scalar_yuv(y + i, u + i / 2, v + i / 2, dst + i, n - i, c);
+}
+
+#elif defined(GTX_SIMD_NEON)
+
+// neon_channel narrows the 16.16 sums of 8 pixels to clamped bytes
+inline auto neon_channel(int32x4_t lo, int32x4_t hi) -> uint8x8_t
+{
+    return vqmovn_u16(vcombine_u16(
+        vqmovun_s32(vshrq_n_s32(lo, 16)), vqmovun_s32(vshrq_n_s32(hi, 16))));
+}
+
+// neon_chroma widens 4 chroma bytes, each repeated twice, to 8 signed
+// values around 0
+inline auto neon_chroma(uint8_t const* p) -> int16x8_t
+{
+    auto const c = vreinterpret_u8_u32(vdup_n_u32(load<uint32_t>(p)));
+    return vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vzip_u8(c, c).val[0])),
+        vdupq_n_s16(128));
+}
+
+void neon_yuv(uint8_t const* y, uint8_t const* u, uint8_t const* v,
+    uint32_t* dst, std::size_t n, coeffs const& c)
+{
+    auto const yo = vdupq_n_s32(c.yo);
+    auto const half = vdupq_n_s32(32768);
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8) {
+        auto const yv = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(y + i)));
+        auto const cb = neon_chroma(u + i / 2);
+        auto const cr = neon_chroma(v + i / 2);
+        int32x4_t r[2], g[2], b[2];
+        for (int j = 0; j < 2; ++j) {
+            auto const yj = vmovl_s16(j ? vget_high_s16(yv) : vget_low_s16(yv));
+            auto const bj = vmovl_s16(j ? vget_high_s16(cb) : vget_low_s16(cb));
+            auto const rj = vmovl_s16(j ? vget_high_s16(cr) : vget_low_s16(cr));
+            auto const l = vmlaq_n_s32(half, vsubq_s32(yj, yo), c.ys);
+            r[j] = vmlaq_n_s32(l, rj, c.rv);
+            g[j] = vmlsq_n_s32(vmlsq_n_s32(l, bj, c.gu), rj, c.gv);
+            b[j] = vmlaq_n_s32(l, bj, c.bu);
+        }
+        auto p = uint8x8x4_t{};
+        p.val[0] = neon_channel(b[0], b[1]);
+        p.val[1] = neon_channel(g[0], g[1]);
+        p.val[2] = neon_channel(r[0], r[1]);
+        p.val[3] = vdup_n_u8(255);
+        vst4_u8(reinterpret_cast<uint8_t*>(dst + i), p);
+    }
+    scalar_yuv(y + i, u + i / 2, v + i / 2, dst + i, n - i, c);
+}
+
+#endif
+
+auto select_yuv() -> yuv_fn
+{
+    switch (simd::active()) {
+#if defined(GTX_SIMD_X86)
+    case simd::isa::avx2:
+        return avx2_yuv;
+    case simd::isa::sse41:
+        return sse41_yuv;
+#elif defined(GTX_SIMD_NEON)
+    case simd::isa::neon:
+        return neon_yuv;
+#endif
+    default:
+        return scalar_yuv;
+    }
+}
+
+auto active_yuv() -> yuv_fn
+{
+    static auto const fn = select_yuv();
+    return fn;
+}
+
+template <typename T> auto row(surface<T> const& s, std::size_t y)
+{
+    return s.data() + y * s.stride();
+}
+
+// for_rows runs fn(y row, chroma row index, dst row, n, arena) over the
+// region of y and dst that the chroma planes cover, in strips
+template <typename Fn>
+void for_rows(surface<uint8_t> const& y, std::size_t cw, std::size_t ch,
+    surface<nargb8888>& dst, executor* exec, Fn const& fn)
+{
+    auto const w = std::min({y.width(), dst.width(), 2 * cw});
+    auto const h = std::min({y.height(), dst.height(), 2 * ch});
+    if (!w || !h || y.empty() || dst.empty())
+        return;
+    detail::for_each_strip(dst.subsurface(0, 0, w, h), detail::strip_pixels,
+        exec, [&](std::size_t y0, std::size_t y1, scratch_arena& arena) {
+            for (auto r = y0; r < y1; ++r)
+                fn(row(y, r), r / 2, reinterpret_cast<uint32_t*>(row(dst, r)),
+                    w, arena);
+        });
+}
+
+} // namespace
+
+void yuv_to_nargb(surface<uint8_t> const& y, surface<uint8_t> const& u,
+    surface<uint8_t> const& v, surface<nargb8888>& dst,
+    yuv_options const& opts)
+{
+    if (u.empty() || v.empty())
+        return;
+    auto const c = make_coeffs(opts);
+    auto const fn = active_yuv();
+    for_rows(y, std::min(u.width(), v.width()),
+        std::min(u.height(), v.height()), dst, opts.exec,
+        [&](uint8_t const* yr, std::size_t cr, uint32_t* d, std::size_t n,
+            scratch_arena&) { fn(yr, row(u, cr), row(v, cr), d, n, c); });
+}
+
+void yuv_to_nargb(surface<uint8_t> const& y, surface<uv88> const& uv,
+    surface<nargb8888>& dst, yuv_options const& opts)
+{
+    if (uv.empty())
+        return;
+    auto const c = make_coeffs(opts);
+    auto const fn = active_yuv();
+    for_rows(y, uv.width(), uv.height(), dst, opts.exec,
+        [&](uint8_t const* yr, std::size_t cr, uint32_t* d, std::size_t n,
+            scratch_arena& arena) {
+            // the pairs are split into u and v rows for the kernels
+            auto const m = (n + 1) / 2;
+            auto const mark = arena.mark();
+            auto const u = arena.allocate_array<uint8_t>(2 * m).data();
+            auto const v = u + m;
+            auto const src = row(uv, cr);
+            for (std::size_t i = 0; i < m; ++i) {
+                u[i] = src[i].u;
+                v[i] = src[i].v;
+            }
+            fn(yr, u, v, d, n, c);
+            arena.rewind(mark);
+        });
+}
+
+} // namespace gtx::pixel
@@ -1,3 +0,0 @@
-glslangValidator -V -x --vn polyline_frag -o tmp/polyline.frag.450.glsl.h polyline.450.frag.glsl
-glslangValidator -V -x --vn polyline_vert -o tmp/polyline.vert.450.glsl.h polyline.450.vert.glsl
-glslangValidator -V -x --vn polyline_geom -o tmp/polyline.geom.450.glsl.h polyline.450.geom.glsl
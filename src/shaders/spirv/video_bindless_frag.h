@@ -0,0 +1,101 @@
+const uint32_t video_bindless_frag[] = {0x07230203, 0x00010000, 0x00000000,
+    0x00000068, 0x00000000, 0x00020011, 0x00000001, 0x00020011, 0x000014b5,
+    0x00020011, 0x000014b6, 0x00020011, 0x000014bb, 0x0008000a, 0x5f565053,
+    0x5f545845, 0x63736564, 0x74706972, 0x695f726f, 0x7865646e, 0x00676e69,
+    0x0006000b, 0x00000001, 0x4c534c47, 0x6474732e, 0x3035342e, 0x00000000,
+    0x0003000e, 0x00000000, 0x00000001, 0x000a000f, 0x00000004, 0x00000002,
+    0x6e69616d, 0x00000000, 0x00000003, 0x00000004, 0x00000005, 0x00000006,
+    0x00000007, 0x00030010, 0x00000002, 0x00000007, 0x00030003, 0x00000002,
+    0x000001c2, 0x00080004, 0x455f4c47, 0x6e5f5458, 0x6e756e6f, 0x726f6669,
+    0x75715f6d, 0x66696c61, 0x00726569, 0x00040005, 0x00000002, 0x6e69616d,
+    0x00000000, 0x00040005, 0x00000008, 0x65676170, 0x00000073, 0x00040047,
+    0x00000008, 0x00000022, 0x00000000, 0x00040047, 0x00000008, 0x00000021,
+    0x00000000, 0x00030047, 0x00000007, 0x0000000e, 0x00040047, 0x00000007,
+    0x0000001e, 0x00000002, 0x00030047, 0x00000009, 0x000014b4, 0x00030047,
+    0x0000000a, 0x000014b4, 0x00030047, 0x0000000b, 0x000014b4, 0x00030047,
+    0x0000000c, 0x000014b4, 0x00030047, 0x0000000d, 0x000014b4, 0x00030047,
+    0x0000000e, 0x000014b4, 0x00030047, 0x0000000f, 0x000014b4, 0x00030047,
+    0x00000010, 0x000014b4, 0x00030047, 0x00000011, 0x000014b4, 0x00040047,
+    0x00000003, 0x0000001e, 0x00000000, 0x00040047, 0x00000004, 0x0000001e,
+    0x00000001, 0x00030047, 0x00000006, 0x0000000e, 0x00040047, 0x00000006,
+    0x0000001e, 0x00000003, 0x00040047, 0x00000005, 0x0000001e, 0x00000000,
+    0x00020013, 0x00000012, 0x00030021, 0x00000013, 0x00000012, 0x00030016,
+    0x00000014, 0x00000020, 0x00040015, 0x00000015, 0x00000020, 0x00000000,
+    0x00020014, 0x00000016, 0x00040017, 0x00000017, 0x00000014, 0x00000002,
+    0x00040017, 0x00000018, 0x00000014, 0x00000004, 0x00040017, 0x00000019,
+    0x00000015, 0x00000003, 0x00090019, 0x0000001a, 0x00000014, 0x00000001,
+    0x00000000, 0x00000000, 0x00000000, 0x00000001, 0x00000000, 0x0003001b,
+    0x0000001b, 0x0000001a, 0x00040020, 0x0000001c, 0x00000000, 0x0000001b,
+    0x00040020, 0x0000001d, 0x00000001, 0x00000015, 0x00040020, 0x0000001e,
+    0x00000001, 0x00000019, 0x00040020, 0x0000001f, 0x00000001, 0x00000017,
+    0x00040020, 0x00000020, 0x00000001, 0x00000018, 0x00040020, 0x00000021,
+    0x00000003, 0x00000018, 0x0004002b, 0x00000015, 0x00000022, 0x00000000,
+    0x0004002b, 0x00000015, 0x00000023, 0x00000001, 0x0004002b, 0x00000015,
+    0x00000024, 0x00000002, 0x0004002b, 0x00000015, 0x00000025, 0x00000004,
+    0x0004002b, 0x00000014, 0x00000026, 0x00000000, 0x0004002b, 0x00000014,
+    0x00000027, 0x3f800000, 0x0004002b, 0x00000014, 0x00000028, 0x40000000,
+    0x0004002b, 0x00000014, 0x00000029, 0x3e59b3d0, 0x0004002b, 0x00000014,
+    0x0000002a, 0x3d93dd98, 0x0004002b, 0x00000014, 0x0000002b, 0x3e991687,
+    0x0004002b, 0x00000014, 0x0000002c, 0x3de978d5, 0x0004002b, 0x00000014,
+    0x0000002d, 0x3d808081, 0x0004002b, 0x00000014, 0x0000002e, 0x3f950a85,
+    0x0004002b, 0x00000014, 0x0000002f, 0x3f91b6db, 0x0004002b, 0x00000014,
+    0x00000030, 0x3f008081, 0x0003001d, 0x00000031, 0x0000001b, 0x00040020,
+    0x00000032, 0x00000000, 0x00000031, 0x0004003b, 0x00000032, 0x00000008,
+    0x00000000, 0x0004003b, 0x0000001e, 0x00000007, 0x00000001, 0x0004003b,
+    0x0000001f, 0x00000003, 0x00000001, 0x0004003b, 0x00000020, 0x00000004,
+    0x00000001, 0x0004003b, 0x0000001d, 0x00000006, 0x00000001, 0x0004003b,
+    0x00000021, 0x00000005, 0x00000003, 0x00050036, 0x00000012, 0x00000002,
+    0x00000000, 0x00000013, 0x000200f8, 0x00000033, 0x0004003d, 0x00000017,
+    0x00000034, 0x00000003, 0x0004003d, 0x00000019, 0x00000035, 0x00000007,
+    0x00050051, 0x00000015, 0x00000036, 0x00000035, 0x00000000, 0x00040053,
+    0x00000015, 0x00000009, 0x00000036, 0x00050041, 0x0000001c, 0x0000000a,
+    0x00000008, 0x00000009, 0x0004003d, 0x0000001b, 0x0000000b, 0x0000000a,
+    0x00050057, 0x00000018, 0x00000037, 0x0000000b, 0x00000034, 0x00050051,
+    0x00000015, 0x00000038, 0x00000035, 0x00000001, 0x00040053, 0x00000015,
+    0x0000000c, 0x00000038, 0x00050041, 0x0000001c, 0x0000000d, 0x00000008,
+    0x0000000c, 0x0004003d, 0x0000001b, 0x0000000e, 0x0000000d, 0x00050057,
+    0x00000018, 0x00000039, 0x0000000e, 0x00000034, 0x00050051, 0x00000015,
+    0x0000003a, 0x00000035, 0x00000002, 0x00040053, 0x00000015, 0x0000000f,
+    0x0000003a, 0x00050041, 0x0000001c, 0x00000010, 0x00000008, 0x0000000f,
+    0x0004003d, 0x0000001b, 0x00000011, 0x00000010, 0x00050057, 0x00000018,
+    0x0000003b, 0x00000011, 0x00000034, 0x00050051, 0x00000014, 0x0000003c,
+    0x00000037, 0x00000000, 0x00050051, 0x00000014, 0x0000003d, 0x00000039,
+    0x00000000, 0x00050051, 0x00000014, 0x0000003e, 0x00000039, 0x00000001,
+    0x00050051, 0x00000014, 0x0000003f, 0x0000003b, 0x00000000, 0x0004003d,
+    0x00000015, 0x00000040, 0x00000006, 0x000500c7, 0x00000015, 0x00000041,
+    0x00000040, 0x00000023, 0x000500ab, 0x00000016, 0x00000042, 0x00000041,
+    0x00000022, 0x000500c7, 0x00000015, 0x00000043, 0x00000040, 0x00000024,
+    0x000500ab, 0x00000016, 0x00000044, 0x00000043, 0x00000022, 0x000500c7,
+    0x00000015, 0x00000045, 0x00000040, 0x00000025, 0x000500ab, 0x00000016,
+    0x00000046, 0x00000045, 0x00000022, 0x000600a9, 0x00000014, 0x00000047,
+    0x00000042, 0x0000003e, 0x0000003f, 0x000600a9, 0x00000014, 0x00000048,
+    0x00000044, 0x00000029, 0x0000002b, 0x000600a9, 0x00000014, 0x00000049,
+    0x00000044, 0x0000002a, 0x0000002c, 0x000600a9, 0x00000014, 0x0000004a,
+    0x00000046, 0x00000026, 0x0000002d, 0x000600a9, 0x00000014, 0x0000004b,
+    0x00000046, 0x00000027, 0x0000002e, 0x000600a9, 0x00000014, 0x0000004c,
+    0x00000046, 0x00000027, 0x0000002f, 0x00050083, 0x00000014, 0x0000004d,
+    0x0000003c, 0x0000004a, 0x00050085, 0x00000014, 0x0000004e, 0x0000004d,
+    0x0000004b, 0x00050083, 0x00000014, 0x0000004f, 0x0000003d, 0x00000030,
+    0x00050085, 0x00000014, 0x00000050, 0x0000004f, 0x0000004c, 0x00050083,
+    0x00000014, 0x00000051, 0x00000047, 0x00000030, 0x00050085, 0x00000014,
+    0x00000052, 0x00000051, 0x0000004c, 0x00050083, 0x00000014, 0x00000053,
+    0x00000027, 0x00000048, 0x00050085, 0x00000014, 0x00000054, 0x00000028,
+    0x00000053, 0x00050085, 0x00000014, 0x00000055, 0x00000054, 0x00000052,
+    0x00050081, 0x00000014, 0x00000056, 0x0000004e, 0x00000055, 0x00050083,
+    0x00000014, 0x00000057, 0x00000027, 0x00000049, 0x00050085, 0x00000014,
+    0x00000058, 0x00000028, 0x00000057, 0x00050085, 0x00000014, 0x00000059,
+    0x00000058, 0x00000050, 0x00050081, 0x00000014, 0x0000005a, 0x0000004e,
+    0x00000059, 0x00050085, 0x00000014, 0x0000005b, 0x00000048, 0x00000056,
+    0x00050085, 0x00000014, 0x0000005c, 0x00000049, 0x0000005a, 0x00050083,
+    0x00000014, 0x0000005d, 0x0000004e, 0x0000005b, 0x00050083, 0x00000014,
+    0x0000005e, 0x0000005d, 0x0000005c, 0x00050083, 0x00000014, 0x0000005f,
+    0x00000027, 0x00000048, 0x00050083, 0x00000014, 0x00000060, 0x0000005f,
+    0x00000049, 0x00050088, 0x00000014, 0x00000061, 0x0000005e, 0x00000060,
+    0x0008000c, 0x00000014, 0x00000062, 0x00000001, 0x0000002b, 0x00000056,
+    0x00000026, 0x00000027, 0x0008000c, 0x00000014, 0x00000063, 0x00000001,
+    0x0000002b, 0x00000061, 0x00000026, 0x00000027, 0x0008000c, 0x00000014,
+    0x00000064, 0x00000001, 0x0000002b, 0x0000005a, 0x00000026, 0x00000027,
+    0x00070050, 0x00000018, 0x00000065, 0x00000062, 0x00000063, 0x00000064,
+    0x00000027, 0x0004003d, 0x00000018, 0x00000066, 0x00000004, 0x00050085,
+    0x00000018, 0x00000067, 0x00000065, 0x00000066, 0x0003003e, 0x00000005,
+    0x00000067, 0x000100fd, 0x00010038};
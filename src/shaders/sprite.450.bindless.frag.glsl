@@ -0,0 +1,23 @@
+#version 450 core
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(set = 0, binding = 0) uniform sampler2D pages[];
+
+// inputs
+layout(location = 0) in vec2 frag_uv;
+layout(location = 1) in vec4 frag_clr;
+layout(location = 2) flat in uint frag_page;
+layout(location = 3) flat in uint frag_sampling;
+
+// outputs
+layout(location = 0) out vec4 out_clr;
+
+void main() {
+    vec4 texel = texture(pages[nonuniformEXT(frag_page)], frag_uv);
+    // sdf sampling: alpha is a distance field with the edge at 0.5, the
+    // edge is antialiased over one pixel
+    float d = texel.a;
+    float w = max(0.5 * length(vec2(dFdx(d), dFdy(d))), 1e-4);
+    vec4 sdf = vec4(1.0, 1.0, 1.0, smoothstep(0.5 - w, 0.5 + w, d));
+    out_clr = (frag_sampling == 1u ? sdf : texel) * frag_clr;
+}
@@ -0,0 +1,30 @@
+#version 450 core
+
+// per-instance inputs, the quad corner comes from the vertex index
+layout(location = 0) in vec2 in_pos;
+layout(location = 1) in vec2 in_ax;
+layout(location = 2) in vec2 in_ay;
+layout(location = 3) in vec4 in_uv;
+layout(location = 4) in vec4 in_clr;
+layout(location = 5) in uint in_page;
+layout(location = 6) in uint in_sampling;
+
+layout(push_constant) uniform constants {
+    mat4 mvp;
+} pc;
+
+// outputs
+layout(location = 0) out vec2 frag_uv;
+layout(location = 1) out vec4 frag_clr;
+layout(location = 2) flat out uint frag_page;
+layout(location = 3) flat out uint frag_sampling;
+
+void main() {
+    // triangle strip corners: (0, 0), (1, 0), (0, 1), (1, 1)
+    vec2 t = vec2(gl_VertexIndex & 1, gl_VertexIndex >> 1);
+    gl_Position = pc.mvp * vec4(in_pos + t.x * in_ax + t.y * in_ay, 0.0, 1.0);
+    frag_uv = mix(in_uv.xy, in_uv.zw, t);
+    frag_clr = in_clr;
+    frag_page = in_page;
+    frag_sampling = in_sampling;
+}
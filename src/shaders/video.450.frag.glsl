@@ -0,0 +1,32 @@
+#version 450 core
+
+layout(set = 0, binding = 0) uniform sampler2D tex_y;
+layout(set = 1, binding = 0) uniform sampler2D tex_u;
+layout(set = 2, binding = 0) uniform sampler2D tex_v;
+
+// inputs
+layout(location = 0) in vec2 frag_uv;
+layout(location = 1) in vec4 frag_clr;
+layout(location = 3) flat in uint frag_mode;
+
+// outputs
+layout(location = 0) out vec4 out_clr;
+
+void main() {
+    // mode bits: 1 nv12 (v is the g of the u plane), 2 bt709, 4 full range
+    float y = texture(tex_y, frag_uv).r;
+    vec2 c = texture(tex_u, frag_uv).rg;
+    float vr = texture(tex_v, frag_uv).r;
+    float v = (frag_mode & 1u) != 0u ? c.g : vr;
+    bool full = (frag_mode & 4u) != 0u;
+    vec2 k = (frag_mode & 2u) != 0u ? vec2(0.2126, 0.0722)
+                                    : vec2(0.299, 0.114);
+    float l = (y - (full ? 0.0 : 16.0 / 255.0)) * (full ? 1.0 : 255.0 / 219.0);
+    float cs = full ? 1.0 : 255.0 / 224.0;
+    float cb = (c.r - 128.0 / 255.0) * cs;
+    float cr = (v - 128.0 / 255.0) * cs;
+    float r = l + 2.0 * (1.0 - k.x) * cr;
+    float b = l + 2.0 * (1.0 - k.y) * cb;
+    float g = (l - k.x * r - k.y * b) / (1.0 - k.x - k.y);
+    out_clr = vec4(clamp(vec3(r, g, b), 0.0, 1.0), 1.0) * frag_clr;
+}
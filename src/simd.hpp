@@ -0,0 +1,95 @@
+#pragma once
+
+// internal: instruction set selection for the CPU kernels, the vectorized
+// variants are compiled side by side in the same translation unit through
+// GTX_TARGET and picked at runtime with simd::active(). The GTX_SIMD
+// environment variable (scalar, sse41, avx2 or neon) caps the selection,
+// e.g. to compare the variants or to exercise the scalar paths.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) ||            \
+    defined(_M_IX86)
+#define GTX_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define GTX_TARGET(isa)
+#else
+#define GTX_TARGET(isa) __attribute__((target(isa)))
+#endif
+#elif defined(__ARM_NEON) || defined(__aarch64__) || defined(_M_ARM64)
+#define GTX_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#include <cstdlib>
+#include <cstring>
+
+namespace gtx::simd {
+
+enum class isa {
+    scalar,
+    sse41,
+    avx2,
+    neon,
+};
+
+inline auto detect() -> isa
+{
+#if defined(GTX_SIMD_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+    int r[4] = {};
+    __cpuid(r, 0);
+    auto const max_leaf = r[0];
+    __cpuid(r, 1);
+    auto const sse41 = (r[2] & (1 << 19)) != 0;
+    auto const osxsave = (r[2] & (1 << 27)) != 0;
+    auto avx2 = false;
+    if (max_leaf >= 7 && osxsave && (_xgetbv(0) & 6) == 6) {
+        __cpuidex(r, 7, 0);
+        avx2 = (r[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    auto const sse41 = __builtin_cpu_supports("sse4.1") != 0;
+    auto const avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+    if (avx2)
+        return isa::avx2;
+    if (sse41)
+        return isa::sse41;
+    return isa::scalar;
+#elif defined(GTX_SIMD_NEON)
+    return isa::neon;
+#else
+    return isa::scalar;
+#endif
+}
+
+// requested reads GTX_SIMD, an unknown or missing value requests the best
+inline auto requested() -> isa
+{
+    auto const* v = std::getenv("GTX_SIMD");
+    if (!v)
+        return isa::avx2;
+    if (!std::strcmp(v, "scalar"))
+        return isa::scalar;
+    if (!std::strcmp(v, "sse41"))
+        return isa::sse41;
+    return isa::avx2;
+}
+
+inline auto active() -> isa
+{
+    static auto const v = [] {
+        auto const d = detect();
+        auto const r = requested();
+        if (r == isa::scalar)
+            return isa::scalar;
+        if (r == isa::sse41 && d == isa::avx2)
+            return isa::sse41;
+        return d;
+    }();
+    return v;
+}
+
+} // namespace gtx::simd
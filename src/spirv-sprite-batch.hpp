@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+
+// generated from the GLSL sources in src/shaders and checked with
+// spirv-val by the Vulkan build (see gtx_spirv in CMakeLists.txt), or the
+// prebuilt copies in src/shaders/spirv when the tools are not installed
+#include "spirv/sprite_vert.h"
+#include "spirv/sprite_frag.h"
+#include "spirv/sprite_bindless_frag.h"
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+
+// generated from the GLSL sources in src/shaders and checked with
+// spirv-val by the Vulkan build (see gtx_spirv in CMakeLists.txt), or the
+// prebuilt copies in src/shaders/spirv when the tools are not installed
+#include "spirv/video_vert.h"
+#include "spirv/video_frag.h"
+#include "spirv/video_bindless_frag.h"
@@ -0,0 +1,122 @@
+#include <gtx/shader/sprite-batch.hpp>
+
+namespace gtx::shdr {
+
+// backend-independent batching, the shader setup and the draw calls are
+// implemented in the backend specific sources
+
+void sprite_batch::clear()
+{
+    instances_.clear();
+    handles_.clear();
+}
+
+void sprite_batch::reserve(std::size_t n)
+{
+    instances_.reserve(n);
+    handles_.reserve(n);
+}
+
+void sprite_batch::push(texture::sprite const& s, vec2<float> const& pos,
+    vec2<float> const& ax, vec2<float> const& ay, vec4<float> const& clr,
+    sampling mode)
+{
+    auto r = texture::registry.find(s.handle());
+    if (!r)
+        return;
+
+    auto& i = instances_.emplace_back();
+    i.pos = pos;
+    i.ax = ax;
+    i.ay = ay;
+    i.uv = s.uv_rect();
+    i.clr = clr;
+    i.page = r->native_index;
+    i.mode = mode;
+    handles_.push_back(r->native_handle);
+}
+
+// a trimmed sprite's dst (or m) covers its whole frame, the quad only the
+// stored box within it
+void sprite_batch::add(texture::sprite const& s, rect<float> const& dst,
+    vec4<float> const& clr, sampling mode)
+{
+    if (!s.trimmed()) {
+        push(s, dst.min, {dst.width(), 0.0f}, {0.0f, dst.height()}, clr, mode);
+        return;
+    }
+    auto const& b = s.get_box();
+    auto const f = s.get_frame();
+    auto const sx = dst.width() / float(f.w);
+    auto const sy = dst.height() / float(f.h);
+    push(s, {dst.min.x + float(f.x) * sx, dst.min.y + float(f.y) * sy},
+        {float(b.w) * sx, 0.0f}, {0.0f, float(b.h) * sy}, clr, mode);
+}
+
+void sprite_batch::add(texture::sprite const& s, xform const& m,
+    vec4<float> const& clr, sampling mode)
+{
+    auto const w = float(s.get_box().w);
+    auto const h = float(s.get_box().h);
+    auto const f = s.get_frame();
+    auto const x = float(f.x);
+    auto const y = float(f.y);
+    push(s, {m.m11 * x + m.m21 * y + m.dx, m.m12 * x + m.m22 * y + m.dy},
+        {m.m11 * w, m.m12 * w}, {m.m21 * h, m.m22 * h}, clr, mode);
+}
+
+auto sprite_batch::prepare(order o) -> std::span<instance const>
+{
+    runs_.clear();
+    auto const n = uint32_t(instances_.size());
+
+    if (o == order::submission) {
+        for (uint32_t i = 0; i < n; ++i) {
+            if (runs_.empty() || runs_.back().native_handle != handles_[i])
+                runs_.push_back({handles_[i], i, 0});
+            ++runs_.back().count;
+        }
+        return instances_;
+    }
+
+    // stable counting sort: count instances per page (pages are few, so
+    // a linear lookup with a last-hit shortcut is enough), then scatter
+    auto last = std::size_t(0);
+    for (uint32_t i = 0; i < n; ++i) {
+        auto const h = handles_[i];
+        if (last >= runs_.size() || runs_[last].native_handle != h) {
+            last = 0;
+            while (last < runs_.size() && runs_[last].native_handle != h)
+                ++last;
+            if (last == runs_.size())
+                runs_.push_back({h, 0, 0});
+        }
+        ++runs_[last].count;
+    }
+
+    if (runs_.size() <= 1)
+        return instances_;
+
+    auto first = uint32_t(0);
+    for (auto& r : runs_) {
+        r.first = first;
+        first += r.count;
+        r.count = 0;
+    }
+
+    sorted_.resize(n);
+    last = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        auto const h = handles_[i];
+        if (runs_[last].native_handle != h) {
+            last = 0;
+            while (runs_[last].native_handle != h)
+                ++last;
+        }
+        auto& r = runs_[last];
+        sorted_[r.first + r.count++] = instances_[i];
+    }
+    return sorted_;
+}
+
+} // namespace gtx::shdr
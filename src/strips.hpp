@@ -0,0 +1,31 @@
+#pragma once
+
+// internal: row strips for the pixel kernels, a strip holds about the
+// requested number of pixels so that the dispatch cost stays small next
+// to the kernel, surfaces that fit in one strip run on the calling thread
+
+#include <gtx/executor.hpp>
+
+#include <algorithm>
+
+namespace gtx::detail {
+
+constexpr std::size_t strip_pixels = std::size_t(1) << 14;
+
+// for_each_strip calls fn(y0, y1, arena) for the row strips of s
+template <typename T, typename Fn>
+void for_each_strip(surface<T> const& s, std::size_t pixels, executor* exec,
+    Fn const& fn)
+{
+    auto const rows =
+        std::max<std::size_t>(pixels / std::max<std::size_t>(s.width(), 1), 1);
+    parallel_for_tiles(
+        s, {unsigned(s.width()), unsigned(rows)},
+        [&](surface<T> const& strip, pixel::coord origin,
+            scratch_arena& arena) {
+            fn(std::size_t(origin.y), origin.y + strip.height(), arena);
+        },
+        {false, exec});
+}
+
+} // namespace gtx::detail
@@ -0,0 +1,95 @@
+#pragma once
+
+// internal: the block compressed upload path shared by the backends, the
+// texels of an update are encoded level by level and handed to the
+// backend's block upload
+
+#include <gtx/pixel/alpha.hpp>
+#include <gtx/pixel/block.hpp>
+#include <gtx/tx-mipmap.hpp>
+#include <gtx/tx-page.hpp>
+
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace gtx::texture::detail {
+
+// block_aligned checks that a box of a level of size sz starts on a block
+// and ends on one or at the edge of the level
+constexpr auto block_aligned(texel_box const& b, texel_size const& sz) -> bool
+{
+    return b.x % 4 == 0 && b.y % 4 == 0 && b.x + b.w <= sz.w &&
+           b.y + b.h <= sz.h && (b.w % 4 == 0 || b.x + b.w == sz.w) &&
+           (b.h % 4 == 0 || b.y + b.h == sz.h);
+}
+
+// block_rows returns the bytes per block row and the block rows of a box
+constexpr auto block_rows(format f, texel_box const& b)
+    -> std::pair<size_t, uint32_t>
+{
+    return {(b.w + 3) / 4 * block_bytes(f), (b.h + 3) / 4};
+}
+
+constexpr auto encoder_format(format f) -> std::optional<pixel::block_format>
+{
+    switch (f) {
+    case format::bc1:
+        return pixel::block_format::bc1;
+    case format::bc3:
+        return pixel::block_format::bc3;
+    case format::bc7:
+        return pixel::block_format::bc7;
+    default:
+        return {};
+    }
+}
+
+// encode_levels encodes box and, when the page has mips, the aligned boxes
+// of the levels mips rebuilds, then calls upload(level, box, blocks) for each
+template <typename Upload>
+auto encode_levels(format fmt, texel_size const& sz, mip_source& mips,
+    texel_box const& box, uint32_t const* data, size_t stride,
+    bool premultiply, Upload const& upload) -> bool
+{
+    auto const bf = encoder_format(fmt);
+    if (!bf || !block_aligned(box, sz))
+        return false;
+
+    static std::vector<uint32_t> staging;
+    if (premultiply) {
+        staging.resize(size_t(box.w) * box.h);
+        pixel::premultiply(data, stride, staging.data(), box.w, box.w, box.h);
+        data = staging.data();
+        stride = box.w;
+    }
+
+    static std::vector<std::byte> blocks;
+    auto const encode = [&](uint32_t level, texel_box const& b,
+                            surface<pixel::nargb8888> const& s) {
+        blocks.resize(pixel::encoded_size(*bf, b.w, b.h));
+        pixel::encode_blocks(s, *bf, blocks.data());
+        upload(level, b, static_cast<void const*>(blocks.data()));
+    };
+
+    // the source is only read, surfaces have no const pixel type
+    encode(0, box,
+        surface<pixel::nargb8888>{
+            reinterpret_cast<pixel::nargb8888*>(const_cast<uint32_t*>(data)),
+            box.w, box.h, stride});
+
+    if (auto const levels = mips.levels(); levels > 1) {
+        static mip_chain chain;
+        mips.update(box, data, stride, chain);
+        for (uint32_t i = 1; i < levels; ++i) {
+            auto const b = chain.box(i);
+            if (!b.w || !b.h || !block_aligned(b, mip_size(sz, i)))
+                continue;
+            encode(i, b, chain.level(i));
+        }
+    }
+    return true;
+}
+
+} // namespace gtx::texture::detail
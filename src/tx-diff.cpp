@@ -0,0 +1,185 @@
+#include "simd.hpp"
+#include <gtx/tx-diff.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace gtx::texture {
+
+namespace {
+
+// differs_fn tells whether n pixels at a and b differ
+using differs_fn = bool (*)(uint32_t const* a, uint32_t const* b,
+    std::size_t n);
+
+auto scalar_differs(uint32_t const* a, uint32_t const* b, std::size_t n)
+    -> bool
+{
+    return std::memcmp(a, b, n * sizeof(uint32_t)) != 0;
+}
+
+#if defined(GTX_SIMD_X86)
+
+GTX_TARGET("sse4.1")
+auto sse41_differs(uint32_t const* a, uint32_t const* b, std::size_t n)
+    -> bool
+{
+    auto acc = _mm_setzero_si128();
+    auto i = std::size_t(0);
+    for (; i + 4 <= n; i += 4)
+        acc = _mm_or_si128(acc,
+            _mm_xor_si128(_mm_loadu_si128((__m128i const*)(a + i)),
+                _mm_loadu_si128((__m128i const*)(b + i))));
+    return !_mm_testz_si128(acc, acc) || scalar_differs(a + i, b + i, n - i);
+}
+
+GTX_TARGET("avx2")
+auto avx2_differs(uint32_t const* a, uint32_t const* b, std::size_t n)
+    -> bool
+{
+    auto acc = _mm256_setzero_si256();
+    auto i = std::size_t(0);
+    for (; i + 8 <= n; i += 8)
+        acc = _mm256_or_si256(acc,
+            _mm256_xor_si256(_mm256_loadu_si256((__m256i const*)(a + i)),
+                _mm256_loadu_si256((__m256i const*)(b + i))));
+    return !_mm256_testz_si256(acc, acc) ||
+           scalar_differs(a + i, b + i, n - i);
+}
+
+#elif defined(GTX_SIMD_NEON) && defined(__aarch64__)
+
+auto neon_differs(uint32_t const* a, uint32_t const* b, std::size_t n)
+    -> bool
+{
+    auto acc = vdupq_n_u32(0);
+    auto i = std::size_t(0);
+    for (; i + 4 <= n; i += 4)
+        acc = vorrq_u32(acc, veorq_u32(vld1q_u32(a + i), vld1q_u32(b + i)));
+    return vmaxvq_u32(acc) != 0 || scalar_differs(a + i, b + i, n - i);
+}
+
+#endif
+
+auto select_differs() -> differs_fn
+{
+    switch (simd::active()) {
+#if defined(GTX_SIMD_X86)
+    case simd::isa::avx2:
+        return avx2_differs;
+    case simd::isa::sse41:
+        return sse41_differs;
+#elif defined(GTX_SIMD_NEON) && defined(__aarch64__)
+    case simd::isa::neon:
+        return neon_differs;
+#endif
+    default:
+        return scalar_differs;
+    }
+}
+
+void copy(surface<uint32_t> const& src, image<uint32_t>& dst,
+    texel_box const& b)
+{
+    for (auto y = b.y; y < b.y + b.h; ++y)
+        std::copy_n(src.data() + y * src.stride() + b.x, b.w, dst.row(y) + b.x);
+}
+
+} // namespace
+
+frame_diff::frame_diff(uint32_t tile)
+    : tile_{(std::max(tile, 1u) + 3) & ~3u}
+{
+}
+
+auto frame_diff::diff(surface<uint32_t> const& cur)
+    -> std::span<texel_box const>
+{
+    static auto const differs = select_differs();
+
+    regions_.clear();
+    if (cur.empty()) {
+        prev_.reset();
+        return regions_;
+    }
+
+    auto const w = uint32_t(cur.width());
+    auto const h = uint32_t(cur.height());
+    if (prev_.width() != w || prev_.height() != h) {
+        prev_ = image<uint32_t>{w, h};
+        regions_.push_back({0, 0, w, h});
+        copy(cur, prev_, regions_.back());
+        return regions_;
+    }
+
+    // mark: a single pass over the rows, tiles already dirty are skipped
+    auto const cols = (w + tile_ - 1) / tile_;
+    auto const rows = (h + tile_ - 1) / tile_;
+    dirty_.assign(std::size_t(cols) * rows, 0);
+    for (uint32_t y = 0; y < h; ++y) {
+        auto const a = cur.data() + y * cur.stride();
+        auto const b = prev_.row(y);
+        auto const d = dirty_.data() + std::size_t(y / tile_) * cols;
+        for (uint32_t c = 0, x = 0; c < cols; ++c, x += tile_)
+            if (!d[c] && differs(a + x, b + x, std::min(tile_, w - x)))
+                d[c] = 1;
+    }
+
+    // merge, in tiles: a run of dirty tiles extends the region of the row
+    // above if it starts and ends at the same columns
+    open_.assign(cols, 0);
+    for (uint32_t r = 0; r < rows; ++r) {
+        auto const d = dirty_.data() + std::size_t(r) * cols;
+        for (uint32_t c = 0; c < cols;) {
+            if (!d[c]) {
+                ++c;
+                continue;
+            }
+            auto e = c + 1;
+            while (e < cols && d[e])
+                ++e;
+            auto const i = open_[c];
+            if (i && regions_[i - 1].w == e - c &&
+                regions_[i - 1].y + regions_[i - 1].h == r)
+                ++regions_[i - 1].h;
+            else {
+                regions_.push_back({c, r, e - c, 1});
+                open_[c] = uint32_t(regions_.size());
+            }
+            c = e;
+        }
+    }
+
+    for (auto& b : regions_) {
+        b.x *= tile_;
+        b.y *= tile_;
+        b.w = std::min(b.w * tile_, w - b.x);
+        b.h = std::min(b.h * tile_, h - b.y);
+        copy(cur, prev_, b);
+    }
+    return regions_;
+}
+
+auto frame_diff::update(page& p, surface<uint32_t> const& cur, uint32_t x,
+    uint32_t y, bool premultiply) -> bool
+{
+    for (auto const& b : diff(cur)) {
+        auto const src = cur.data() + b.y * cur.stride() + b.x;
+        if (!p.update({x + b.x, y + b.y, b.w, b.h}, src, cur.stride(),
+                premultiply)) {
+            prev_.reset();
+            return false;
+        }
+    }
+    return true;
+}
+
+auto frame_diff::dirty_pixels() const -> std::size_t
+{
+    auto n = std::size_t(0);
+    for (auto const& b : regions_)
+        n += std::size_t(b.w) * b.h;
+    return n;
+}
+
+} // namespace gtx::texture
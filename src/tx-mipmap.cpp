@@ -0,0 +1,57 @@
+#include <gtx/pixel/resample.hpp>
+#include <gtx/tx-mipmap.hpp>
+
+#include <algorithm>
+
+namespace gtx::texture {
+
+void mip_chain::generate(uint32_t const* data, std::size_t stride,
+    texel_box const& box, texel_size const& page_size, uint32_t levels)
+{
+    box_ = box;
+    page_ = page_size;
+    levels_.resize(levels > 1 ? levels - 1 : 0);
+    if (!data || !box.w || !box.h)
+        return;
+
+    // the source is only read, surfaces have no const pixel type
+    auto prev = surface<pixel::nargb8888>{
+        reinterpret_cast<pixel::nargb8888*>(const_cast<uint32_t*>(data)),
+        box.w, box.h, stride};
+
+    for (uint32_t i = 1; i < levels; ++i) {
+        auto const b = mip_box(box, i);
+        auto& img = levels_[i - 1];
+        if (img.width() != b.w || img.height() != b.h)
+            img = image<pixel::nargb8888>{b.w, b.h};
+
+        if (prev.width() == 2 * b.w && prev.height() == 2 * b.h)
+            pixel::halve(prev, img.view());
+        else
+            pixel::resample(prev, img.view(), {pixel::filter::box});
+        prev = img.view();
+    }
+}
+
+void mip_source::setup(texel_size const& sz, uint32_t levels)
+{
+    sz_ = sz;
+    levels_ = levels;
+    texels_.assign(levels > 1 ? std::size_t(sz.w) * sz.h : 0, 0);
+}
+
+void mip_source::update(texel_box const& box, uint32_t const* data,
+    std::size_t stride, mip_chain& chain)
+{
+    if (levels_ <= 1 || !data || box.x + box.w > sz_.w ||
+        box.y + box.h > sz_.h)
+        return;
+    for (uint32_t y = 0; y < box.h; ++y)
+        std::copy_n(data + y * stride, box.w,
+            texels_.data() + std::size_t(box.y + y) * sz_.w + box.x);
+    auto const r = mip_region(box, sz_, levels_);
+    chain.generate(texels_.data() + std::size_t(r.y) * sz_.w + r.x, sz_.w, r,
+        sz_, levels_);
+}
+
+} // namespace gtx::texture
@@ -0,0 +1,197 @@
+#include <gtx/tx-snapshot.hpp>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gtx::texture {
+
+#if defined(_WIN32)
+
+auto mapped_file::open(char const* path) -> bool
+{
+    close();
+    auto const file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    file_ = file;
+
+    auto size = LARGE_INTEGER{};
+    if (!GetFileSizeEx(file, &size) || !size.QuadPart) {
+        close();
+        return false;
+    }
+    mapping_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_) {
+        close();
+        return false;
+    }
+    data_ = static_cast<std::byte const*>(
+        MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (!data_) {
+        close();
+        return false;
+    }
+    size_ = std::size_t(size.QuadPart);
+    return true;
+}
+
+void mapped_file::close()
+{
+    if (data_)
+        UnmapViewOfFile(data_);
+    if (mapping_)
+        CloseHandle(mapping_);
+    if (file_)
+        CloseHandle(file_);
+    data_ = nullptr;
+    size_ = 0;
+    mapping_ = nullptr;
+    file_ = nullptr;
+}
+
+#else
+
+auto mapped_file::open(char const* path) -> bool
+{
+    close();
+    auto const fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st = {};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    // the mapping keeps the file referenced, the descriptor is not needed
+    auto const p =
+        mmap(nullptr, std::size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+        return false;
+    data_ = static_cast<std::byte const*>(p);
+    size_ = std::size_t(st.st_size);
+    return true;
+}
+
+void mapped_file::close()
+{
+    if (data_)
+        munmap(const_cast<std::byte*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+}
+
+#endif
+
+namespace {
+
+// within checks that n records of size bytes at offset fit in the data
+auto within(uint64_t offset, uint64_t n, uint64_t size, uint64_t bytes)
+    -> bool
+{
+    return offset % snapshot_alignment == 0 && offset <= bytes &&
+           n <= (bytes - offset) / size;
+}
+
+} // namespace
+
+auto check_snapshot(std::span<std::byte const> data, snapshot_expect const& e)
+    -> snapshot_header const*
+{
+    using detail::snapshot_table;
+
+    if (data.size() < sizeof(snapshot_header) ||
+        reinterpret_cast<uintptr_t>(data.data()) % alignof(snapshot_header))
+        return nullptr;
+
+    auto const h = snapshot_table<snapshot_header>(data, 0);
+    auto const bytes = uint64_t(data.size());
+    if (std::memcmp(h->magic, "gtxatlas", 8) != 0 ||
+        h->version != snapshot_version ||
+        h->header_bytes != sizeof(snapshot_header) ||
+        h->file_bytes != bytes || h->page_w != e.page_size.w ||
+        h->page_h != e.page_size.h || h->align != e.align ||
+        h->format != uint32_t(e.fmt) || h->payload_bytes != e.payload_bytes)
+        return nullptr;
+
+    if (!within(h->pages_offset, h->pages, sizeof(snapshot_page), bytes) ||
+        !within(h->rows_offset, h->rows, sizeof(snapshot_row), bytes) ||
+        !within(h->cells_offset, h->cells, sizeof(snapshot_cell), bytes) ||
+        !within(h->tiles_offset, h->tiles, sizeof(snapshot_tile), bytes) ||
+        !within(h->shared_offset, h->shared, sizeof(snapshot_shared), bytes) ||
+        (e.payload_bytes &&
+            !within(h->payloads_offset, h->tiles, e.payload_bytes, bytes)))
+        return nullptr;
+
+    // rows and cells are assigned in order, so the ranges must follow
+    // each other and cover the tables. The atlas keeps rows top to bottom
+    // and cells left to right, and expects at least one of each, so every
+    // row must lie below the previous one and every cell right of the
+    // previous one, within the page and its row.
+    auto const pages = snapshot_table<snapshot_page>(data, h->pages_offset);
+    auto const rows = snapshot_table<snapshot_row>(data, h->rows_offset);
+    auto const cells = snapshot_table<snapshot_cell>(data, h->cells_offset);
+    auto const texels = page_bytes(e.fmt, e.page_size);
+    auto next_row = uint32_t(0);
+    auto next_cell = uint32_t(0);
+    for (uint32_t i = 0; i < h->pages; ++i) {
+        auto const& p = pages[i];
+        if (p.texels_bytes != texels ||
+            !within(p.texels_offset, 1, texels, bytes) ||
+            p.first_row != next_row || !p.row_count ||
+            p.row_count > h->rows - next_row)
+            return nullptr;
+        next_row += p.row_count;
+        auto row_y = uint32_t(0);
+        for (auto r = rows + p.first_row; r != rows + next_row; ++r) {
+            if (r->first_cell != next_cell || !r->cell_count ||
+                r->cell_count > h->cells - next_cell || r->y < row_y ||
+                uint32_t(r->y) + r->h > h->page_h)
+                return nullptr;
+            row_y = uint32_t(r->y) + r->h;
+            next_cell += r->cell_count;
+            auto cell_x = uint32_t(0);
+            for (auto c = cells + r->first_cell; c != cells + next_cell; ++c) {
+                if (c->x < cell_x || uint32_t(c->x) + c->w > h->page_w ||
+                    c->h > r->h)
+                    return nullptr;
+                cell_x = uint32_t(c->x) + c->w;
+            }
+        }
+    }
+    if (next_row != h->rows || next_cell != h->cells)
+        return nullptr;
+
+    auto const tiles = snapshot_table<snapshot_tile>(data, h->tiles_offset);
+    for (uint32_t i = 0; i < h->tiles; ++i) {
+        auto const& t = tiles[i];
+        if (t.pageref >= h->pages || t.x + t.w > h->page_w ||
+            t.y + t.h > h->page_h || t.ox < 0 || t.oy < 0 ||
+            t.ox + t.w > t.src_w || t.oy + t.h > t.src_h)
+            return nullptr;
+    }
+
+    // the shared index refers to tiles and sources within the data, its
+    // hashes are sorted and unique
+    auto const shared =
+        snapshot_table<snapshot_shared>(data, h->shared_offset);
+    for (uint32_t i = 0; i < h->shared; ++i)
+        if (shared[i].tile >= h->tiles ||
+            shared[i].source_offset > bytes ||
+            shared[i].source_bytes > bytes - shared[i].source_offset ||
+            (i && shared[i].hash <= shared[i - 1].hash))
+            return nullptr;
+    return h;
+}
+
+} // namespace gtx::texture
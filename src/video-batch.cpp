@@ -0,0 +1,91 @@
+#include <gtx/shader/video-batch.hpp>
+
+#include <algorithm>
+
+namespace gtx::shdr {
+
+// backend-independent batching, the shader setup and the draw calls are
+// implemented in the backend specific sources
+
+void video_batch::clear()
+{
+    instances_.clear();
+    runs_.clear();
+}
+
+void video_batch::reserve(std::size_t n) { instances_.reserve(n); }
+
+void video_batch::push(texture::video_page const& v,
+    texture::uv_rect const& uv, vec2<float> const& pos, vec2<float> const& ax,
+    vec2<float> const& ay, vec4<float> const& clr)
+{
+    // nv12 frames sample u and v from the same plane
+    auto const nv12_layout = v.layout() == texture::yuv_layout::nv12;
+    texture::page_record const* r[3];
+    for (unsigned i = 0; i < 3; ++i) {
+        r[i] = texture::registry.find(
+            v.plane(nv12_layout ? std::min(i, 1u) : i).handle());
+        if (!r[i])
+            return;
+    }
+
+    auto& i = instances_.emplace_back();
+    i.pos = pos;
+    i.ax = ax;
+    i.ay = ay;
+    i.uv = uv;
+    i.clr = clr;
+    for (unsigned j = 0; j < 3; ++j)
+        i.planes[j] = r[j]->native_index;
+    i.mode = (nv12_layout ? nv12 : 0) |
+             (v.matrix() == pixel::yuv_matrix::bt709 ? bt709 : 0) |
+             (v.range() == pixel::yuv_range::full ? full_range : 0);
+
+    auto const n = uint32_t(instances_.size() - 1);
+    if (runs_.empty() || runs_.back().planes[0] != r[0]->native_handle ||
+        runs_.back().planes[1] != r[1]->native_handle)
+        runs_.push_back({{r[0]->native_handle, r[1]->native_handle,
+                             r[2]->native_handle},
+            n, 0});
+    ++runs_.back().count;
+}
+
+void video_batch::add(texture::video_page const& v, rect<float> const& dst,
+    vec4<float> const& clr)
+{
+    push(v, {0.0f, 0.0f, 1.0f, 1.0f}, dst.min, {dst.width(), 0.0f},
+        {0.0f, dst.height()}, clr);
+}
+
+void video_batch::add(texture::video_page const& v,
+    texture::texel_box const& box, rect<float> const& dst,
+    vec4<float> const& clr)
+{
+    auto const sz = v.get_size();
+    if (!sz.w || !sz.h)
+        return;
+    auto const sx = 1.0f / float(sz.w);
+    auto const sy = 1.0f / float(sz.h);
+    push(v,
+        {float(box.x) * sx, float(box.y) * sy, float(box.x + box.w) * sx,
+            float(box.y + box.h) * sy},
+        dst.min, {dst.width(), 0.0f}, {0.0f, dst.height()}, clr);
+}
+
+void video_batch::add(
+    texture::video_page const& v, xform const& m, vec4<float> const& clr)
+{
+    auto const sz = v.get_size();
+    auto const w = float(sz.w);
+    auto const h = float(sz.h);
+    push(v, {0.0f, 0.0f, 1.0f, 1.0f}, {m.dx, m.dy}, {m.m11 * w, m.m12 * w},
+        {m.m21 * h, m.m22 * h}, clr);
+}
+
+auto video_batch::prepare() -> std::span<instance const>
+{
+    // runs are kept in submission order while adding
+    return instances_;
+}
+
+} // namespace gtx::shdr
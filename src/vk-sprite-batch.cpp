@@ -0,0 +1,244 @@
+#include "spirv-sprite-batch.hpp"
+#include <algorithm>
+#include <cstring>
+#include <gtx/shader/sprite-batch.hpp>
+#include <memory>
+
+namespace gtx {
+extern device_info d;
+extern frame_info f;
+auto must_descriptor_set_layout() -> VkDescriptorSetLayout;
+} // namespace gtx
+
+namespace gtx::shdr {
+
+static constexpr VkDeviceSize min_stream_capacity = 64 * 1024;
+
+sprite_batch::sprite_batch()
+    : mvp_{mat4x4::identity()}
+    , bindless_{vk::bindless_enabled()}
+{
+    if (!d.device)
+        throw std::runtime_error("sprite_batch pipeline: missing device.");
+
+    auto vert = vk::shader{sprite_vert};
+    auto frag = bindless_ ? vk::shader{sprite_bindless_frag}
+                          : vk::shader{sprite_frag};
+
+    VkPipelineShaderStageCreateInfo stages[2] = {};
+    stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    stages[0].module = vert;
+    stages[0].pName = "main";
+    stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    stages[1].module = frag;
+    stages[1].pName = "main";
+
+    // binding description, one instance per sprite
+    VkVertexInputBindingDescription bd = {};
+    bd.stride = sizeof(instance);
+    bd.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+    bd.binding = 0;
+
+    // attributes to match fields in instance
+    VkVertexInputAttributeDescription attrs[7] = {};
+    attrs[0].location = 0;
+    attrs[0].binding = bd.binding;
+    attrs[0].format = VK_FORMAT_R32G32_SFLOAT;
+    attrs[0].offset = offsetof(instance, pos);
+    attrs[1].location = 1;
+    attrs[1].binding = bd.binding;
+    attrs[1].format = VK_FORMAT_R32G32_SFLOAT;
+    attrs[1].offset = offsetof(instance, ax);
+    attrs[2].location = 2;
+    attrs[2].binding = bd.binding;
+    attrs[2].format = VK_FORMAT_R32G32_SFLOAT;
+    attrs[2].offset = offsetof(instance, ay);
+    attrs[3].location = 3;
+    attrs[3].binding = bd.binding;
+    attrs[3].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    attrs[3].offset = offsetof(instance, uv);
+    attrs[4].location = 4;
+    attrs[4].binding = bd.binding;
+    attrs[4].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    attrs[4].offset = offsetof(instance, clr);
+    attrs[5].location = 5;
+    attrs[5].binding = bd.binding;
+    attrs[5].format = VK_FORMAT_R32_UINT;
+    attrs[5].offset = offsetof(instance, page);
+    attrs[6].location = 6;
+    attrs[6].binding = bd.binding;
+    attrs[6].format = VK_FORMAT_R32_UINT;
+    attrs[6].offset = offsetof(instance, mode);
+
+    VkPipelineVertexInputStateCreateInfo vi = {};
+    vi.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vi.vertexBindingDescriptionCount = 1;
+    vi.pVertexBindingDescriptions = &bd;
+    vi.vertexAttributeDescriptionCount = 7;
+    vi.pVertexAttributeDescriptions = attrs;
+
+    VkPipelineInputAssemblyStateCreateInfo ia_info = {};
+    ia_info.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    ia_info.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+
+    VkPipelineViewportStateCreateInfo viewport_info = {};
+    viewport_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewport_info.viewportCount = 1;
+    viewport_info.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo raster_info = {};
+    raster_info.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    raster_info.polygonMode = VK_POLYGON_MODE_FILL;
+    raster_info.cullMode = VK_CULL_MODE_NONE;
+    raster_info.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    raster_info.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo ms_info = {};
+    ms_info.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    ms_info.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineColorBlendAttachmentState cba = {};
+    cba.blendEnable = VK_TRUE;
+    cba.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    cba.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    cba.colorBlendOp = VK_BLEND_OP_ADD;
+    cba.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    cba.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    cba.alphaBlendOp = VK_BLEND_OP_ADD;
+    cba.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                         VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+    VkPipelineDepthStencilStateCreateInfo depth_info = {};
+    depth_info.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+
+    VkPipelineColorBlendStateCreateInfo blend_info = {};
+    blend_info.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    blend_info.attachmentCount = 1;
+    blend_info.pAttachments = &cba;
+
+    VkDynamicState dynamic_states[2] = {
+        VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo dynamic_state = {};
+    dynamic_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamic_state.dynamicStateCount = 2;
+    dynamic_state.pDynamicStates = dynamic_states;
+
+    VkPushConstantRange push_constant = {};
+    push_constant.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    push_constant.offset = 0;
+    push_constant.size = sizeof(mat4x4);
+
+    // set 0 is the page: a single sampler per page, or the bindless array
+    auto set_layout = bindless_ ? vk::bindless_set_layout()
+                                : must_descriptor_set_layout();
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &set_layout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &push_constant;
+
+    if (vkCreatePipelineLayout(d.device, &pipelineLayoutInfo, d.allocator,
+            &pipeline_layout_) != VK_SUCCESS)
+        throw std::runtime_error("failed to create pipeline layout.");
+
+    VkGraphicsPipelineCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    info.stageCount = 2;
+    info.pStages = stages;
+    info.pVertexInputState = &vi;
+    info.pInputAssemblyState = &ia_info;
+    info.pViewportState = &viewport_info;
+    info.pRasterizationState = &raster_info;
+    info.pMultisampleState = &ms_info;
+    info.pDepthStencilState = &depth_info;
+    info.pColorBlendState = &blend_info;
+    info.pDynamicState = &dynamic_state;
+    info.layout = pipeline_layout_;
+    info.renderPass = d.render_pass;
+
+    if (vkCreateGraphicsPipelines(d.device, d.pipeline_cache, 1, &info,
+            d.allocator, &pipeline_) != VK_SUCCESS) {
+        vkDestroyPipelineLayout(d.device, pipeline_layout_, d.allocator);
+        throw std::runtime_error("failed to create sprite_batch pipeline.");
+    }
+}
+
+sprite_batch::~sprite_batch()
+{
+    if (pipeline_)
+        vkDestroyPipeline(d.device, pipeline_, d.allocator);
+    if (pipeline_layout_)
+        vkDestroyPipelineLayout(d.device, pipeline_layout_, d.allocator);
+}
+
+void sprite_batch::setup_mvp(mat4x4 const& m) { mvp_ = m; }
+
+void sprite_batch::render(order o)
+{
+    // a single bindless draw keeps painter's order at no extra cost
+    auto stream = prepare(bindless_ ? order::submission : o);
+    if (stream.empty())
+        return;
+
+    auto cb = f.command_buffer;
+    if (!cb)
+        throw std::runtime_error("sprite_batch: missing command buffer.");
+
+    // segments are recycled round-robin, one per frame in flight, so the
+    // instance data of a frame still in flight is never overwritten
+    auto const frame = vk::frame_serial();
+    if (segments_[segment_].frame != frame) {
+        segment_ = (segment_ + 1) % frames_in_flight;
+        auto& s = segments_[segment_];
+        s.frame = frame;
+        s.used = 0;
+        s.retired.clear();
+    }
+
+    auto& s = segments_[segment_];
+    auto const bytes = VkDeviceSize(stream.size_bytes());
+    if (s.used + bytes > s.capacity) {
+        if (s.buffer)
+            s.retired.push_back(std::move(s.buffer));
+        s.capacity = std::max({bytes, 2 * s.capacity, min_stream_capacity});
+        s.buffer = std::make_unique<vk::buffer>(s.capacity,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        s.used = 0;
+    }
+
+    std::memcpy(
+        static_cast<char*>(s.buffer->mapped()) + s.used, stream.data(), bytes);
+    auto vb = VkBuffer(*s.buffer);
+    auto const offset = s.used;
+    s.used += bytes;
+
+    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_);
+    vkCmdPushConstants(cb, pipeline_layout_, VK_SHADER_STAGE_VERTEX_BIT, 0,
+        sizeof(mat4x4), &mvp_);
+    vkCmdBindVertexBuffers(cb, 0, 1, &vb, &offset);
+
+    if (bindless_) {
+        auto ds = vk::bindless_set();
+        vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS,
+            pipeline_layout_, 0, 1, &ds, 0, nullptr);
+        vkCmdDraw(cb, 4, uint32_t(stream.size()), 0, 0);
+        return;
+    }
+
+    for (auto const& r : runs_) {
+        auto ds = static_cast<VkDescriptorSet>(r.native_handle);
+        vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS,
+            pipeline_layout_, 0, 1, &ds, 0, nullptr);
+        vkCmdDraw(cb, 4, r.count, 0, r.first);
+    }
+}
+
+} // namespace gtx::shdr
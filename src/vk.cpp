@@ -1,7 +1,17 @@
 #include <gtx/device.hpp>
+#include <gtx/pixel/alpha.hpp>
+#include <gtx/tx-mipmap.hpp>
 #include <gtx/tx-page.hpp>
 #include <gtx/vk/vk.hpp>
+
+#include "tx-blocks.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <optional>
 #include <stdexcept>
+#include <utility>
 
 #ifdef GTX_VULKAN_SHADERC
 #include <shaderc/shaderc.hpp>
@@ -13,14 +23,140 @@ struct texture::page_data {
     texel_size sz = {0, 0};
     bool wrap = false;
     vk::image_info image;
-    vk::descriptor_set ds;
+    std::optional<vk::descriptor_set> ds; // empty in bindless mode
+    uint32_t index = uint32_t(-1);        // slot in the bindless table
+    page_handle handle;
+    format fmt = format::rgba8;
+    uint32_t levels = 1;
+    texture::mip_source mips;
+    bool initialized = false; // layout is shader read only after an update
+
+    ~page_data();
 };
 
 device_info d;
 frame_info f;
+uint64_t frame_count = 0;
+
+// memory_block is a single vkAllocateMemory allocation that is carved into
+// aligned sub-ranges, free ranges are kept sorted by offset and coalesced.
+// A block keeps the device it was allocated from, so that blocks still in
+// use when the device changes are freed on their own device later.
+struct vk::memory_block {
+    struct range {
+        VkDeviceSize offset;
+        VkDeviceSize size;
+    };
+
+    VkDevice device = nullptr;
+    VkAllocationCallbacks const* allocator = nullptr;
+    VkDeviceMemory memory = nullptr;
+    VkDeviceSize size = 0;
+    void* mapped = nullptr;
+    uint32_t memory_type = 0;
+    bool linear = false;
+    bool dedicated = false;
+    std::vector<range> free;
+
+    ~memory_block()
+    {
+        if (mapped)
+            vkUnmapMemory(device, memory);
+        if (memory)
+            vkFreeMemory(device, memory, allocator);
+    }
+
+    auto empty() const
+    {
+        return free.size() == 1 && free.front().size == size;
+    }
+
+    auto acquire(VkDeviceSize sz, VkDeviceSize alignment) -> VkDeviceSize
+    {
+        for (auto it = free.begin(); it != free.end(); ++it) {
+            auto const first =
+                (it->offset + alignment - 1) / alignment * alignment;
+            auto const last = first + sz;
+            if (last > it->offset + it->size)
+                continue;
+            auto const tail = range{last, it->offset + it->size - last};
+            if (first > it->offset)
+                it->size = first - it->offset;
+            else
+                it = free.erase(it);
+            if (tail.size)
+                free.insert(std::lower_bound(free.begin(), free.end(),
+                                tail.offset,
+                                [](auto const& r, auto o) {
+                                    return r.offset < o;
+                                }),
+                    tail);
+            return first;
+        }
+        return VkDeviceSize(-1);
+    }
+
+    void give_back(VkDeviceSize offset, VkDeviceSize sz)
+    {
+        auto it = std::lower_bound(free.begin(), free.end(), offset,
+            [](auto const& r, auto o) { return r.offset < o; });
+        it = free.insert(it, range{offset, sz});
+        if (auto next = it + 1;
+            next != free.end() && it->offset + it->size == next->offset) {
+            it->size += next->size;
+            free.erase(next);
+        }
+        if (it != free.begin()) {
+            auto prev = it - 1;
+            if (prev->offset + prev->size == it->offset) {
+                prev->size += it->size;
+                free.erase(it);
+            }
+        }
+    }
+};
+
+std::vector<std::unique_ptr<vk::memory_block>> memory_blocks;
+
+// default block sizes, requests above half a block get a dedicated allocation
+constexpr auto device_block_size = VkDeviceSize{64} << 20;
+constexpr auto host_block_size = VkDeviceSize{16} << 20;
 
 std::unique_ptr<vk::descriptor_set_layout> ds_layout;
 
+// frames a released bindless slot is held for, command buffers recorded
+// up to that many frames back may still read it (as the stream segments of
+// the batches)
+constexpr uint64_t bindless_frames_in_flight = 3;
+
+// bindless_table is a single update-after-bind descriptor set that holds
+// a combined image sampler for every page. Released slots are reused once
+// the frame that released them has retired, a new page never rewrites a
+// slot that a frame in flight may still sample.
+struct bindless_table {
+    struct released_slot {
+        uint32_t slot;
+        uint64_t frame;
+    };
+
+    uint32_t capacity = 0;
+    VkDescriptorSetLayout layout = nullptr;
+    VkDescriptorPool pool = nullptr;
+    VkDescriptorSet set = nullptr;
+    uint32_t next_slot = 0;
+    std::deque<released_slot> free_slots; // in release order
+
+    bindless_table(uint32_t capacity);
+    bindless_table(bindless_table const&) = delete;
+    ~bindless_table();
+
+    auto acquire() -> uint32_t;
+    void release(uint32_t slot) { free_slots.push_back({slot, frame_count}); }
+    void update(uint32_t slot, vk::image_info& img, vk::sampler& smp);
+};
+
+std::unique_ptr<bindless_table> bindless;
+
 std::vector<std::shared_ptr<texture::page_data>> pages;
 
 std::shared_ptr<vk::sampler> border_sampler;
@@ -34,11 +170,19 @@ void set_device(device_info const& v)
     border_sampler.reset();
     repeat_sampler.reset();
     ds_layout.reset();
+    bindless.reset();
+    // blocks with live suballocations (e.g. batch stream buffers) are kept
+    // until those are released, allocate no longer hands them out
+    std::erase_if(memory_blocks, [](auto const& b) { return b->empty(); });
 
     d = v;
 }
 
-void set_frame(frame_info const& v) { f = v; }
+void set_frame(frame_info const& v)
+{
+    f = v;
+    ++frame_count;
+}
 
 auto find_memory_type(
     uint32_t type_filter, VkMemoryPropertyFlags properties) -> uint32_t
@@ -57,6 +201,97 @@ auto find_memory_type(
     throw std::runtime_error("Failed to find suitable memory type.");
 }
 
+auto vk::allocate(VkMemoryRequirements const& requirements,
+    VkMemoryPropertyFlags properties, bool linear) -> allocation
+{
+    auto const memory_type =
+        find_memory_type(requirements.memoryTypeBits, properties);
+    auto const host_visible =
+        (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+    auto const block_size = host_visible ? host_block_size : device_block_size;
+    auto const alignment = std::max(requirements.alignment, VkDeviceSize{1});
+
+    auto ret = allocation{};
+    ret.size = requirements.size;
+
+    if (requirements.size <= block_size / 2) {
+        for (auto& b : memory_blocks) {
+            if (b->dedicated || b->device != d.device ||
+                b->memory_type != memory_type || b->linear != linear)
+                continue;
+            if (auto offset = b->acquire(requirements.size, alignment);
+                offset != VkDeviceSize(-1)) {
+                ret.memory = b->memory;
+                ret.offset = offset;
+                ret.mapped =
+                    b->mapped ? static_cast<char*>(b->mapped) + offset : nullptr;
+                ret.block_ = b.get();
+                return ret;
+            }
+        }
+    }
+
+    auto b = std::make_unique<memory_block>();
+    b->device = d.device;
+    b->allocator = d.allocator;
+    b->size = std::max(requirements.size, block_size);
+    b->memory_type = memory_type;
+    b->linear = linear;
+    b->dedicated = requirements.size > block_size / 2;
+    if (b->dedicated)
+        b->size = requirements.size;
+    b->free.push_back({0, b->size});
+
+    auto alloc_info = VkMemoryAllocateInfo{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = b->size;
+    alloc_info.memoryTypeIndex = memory_type;
+    if (vkAllocateMemory(d.device, &alloc_info, d.allocator, &b->memory) !=
+        VK_SUCCESS)
+        throw std::runtime_error("Failed to allocate device memory block.");
+
+    if (host_visible &&
+        vkMapMemory(d.device, b->memory, 0, VK_WHOLE_SIZE, 0, &b->mapped) !=
+            VK_SUCCESS)
+        throw std::runtime_error("Failed to map device memory block.");
+
+    ret.memory = b->memory;
+    ret.offset = b->acquire(requirements.size, alignment);
+    ret.mapped = b->mapped ? static_cast<char*>(b->mapped) + ret.offset
+                           : nullptr;
+    ret.block_ = b.get();
+    memory_blocks.push_back(std::move(b));
+    return ret;
+}
+
+void vk::release(allocation& a)
+{
+    auto b = std::exchange(a.block_, nullptr);
+    a.memory = nullptr;
+    a.mapped = nullptr;
+    if (!b)
+        return;
+
+    b->give_back(a.offset, a.size);
+    if (!b->empty())
+        return;
+
+    // keep one empty block per pool around to avoid churn on transient
+    // staging buffers, dedicated blocks and blocks of a previous device are
+    // returned to the driver right away
+    auto spare = b->dedicated || b->device != d.device;
+    for (auto& other : memory_blocks)
+        if (other.get() != b && !other->dedicated &&
+            other->device == b->device &&
+            other->memory_type == b->memory_type &&
+            other->linear == b->linear && other->empty())
+            spare = true;
+
+    if (spare)
+        std::erase_if(
+            memory_blocks, [b](auto const& other) { return other.get() == b; });
+}
+
 auto must_descriptor_set_layout() -> VkDescriptorSetLayout
 {
     if (!ds_layout)
@@ -85,7 +320,7 @@ vk::sampler::sampler(bool wrap)
     si.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
     si.mipLodBias = 0.0f;
     si.minLod = 0.0f;
-    si.maxLod = 0.0f;
+    si.maxLod = VK_LOD_CLAMP_NONE;
 
     if (vkCreateSampler(d.device, &si, d.allocator, &vk_sampler_) != VK_SUCCESS)
         throw std::runtime_error("Failed to create texture sampler!");
@@ -118,23 +353,21 @@ vk::buffer::buffer(VkDeviceSize size, VkBufferUsageFlags usage,
     VkMemoryRequirements mem_requirements;
     vkGetBufferMemoryRequirements(d.device, vk_buffer_, &mem_requirements);
 
-    auto allocate_info = VkMemoryAllocateInfo{};
-    allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocate_info.allocationSize = mem_requirements.size;
-    allocate_info.memoryTypeIndex =
-        find_memory_type(mem_requirements.memoryTypeBits, properties);
-
-    if (vkAllocateMemory(d.device, &allocate_info, d.allocator, &vk_memory_) !=
-        VK_SUCCESS) {
-        throw std::runtime_error("Failed to allocate buffer memory.");
+    try {
+        mem_ = allocate(mem_requirements, properties, true);
+    }
+    catch (...) {
+        vkDestroyBuffer(d.device, std::exchange(vk_buffer_, nullptr),
+            d.allocator);
+        throw;
     }
 
-    vkBindBufferMemory(d.device, vk_buffer_, vk_memory_, 0);
+    vkBindBufferMemory(d.device, vk_buffer_, mem_.memory, mem_.offset);
 }
 
 vk::buffer::buffer(buffer&& rhs)
     : vk_buffer_{std::exchange(rhs.vk_buffer_, nullptr)}
-    , vk_memory_{std::exchange(rhs.vk_memory_, nullptr)}
+    , mem_{std::exchange(rhs.mem_, allocation{})}
 {
 }
 
@@ -142,12 +375,12 @@ vk::buffer::~buffer()
 {
     if (vk_buffer_)
         vkDestroyBuffer(d.device, vk_buffer_, d.allocator);
-    if (vk_memory_)
-        vkFreeMemory(d.device, vk_memory_, d.allocator);
+    release(mem_);
 }
 
 vk::image_info::image_info(uint32_t width, uint32_t height, VkFormat format,
-    VkImageUsageFlags usage, VkMemoryPropertyFlags properties)
+    VkImageUsageFlags usage, VkMemoryPropertyFlags properties,
+    uint32_t mip_levels)
 {
     {
         auto create_info = VkImageCreateInfo{};
@@ -156,7 +389,7 @@ vk::image_info::image_info(uint32_t width, uint32_t height, VkFormat format,
         create_info.extent.width = width;
         create_info.extent.height = height;
         create_info.extent.depth = 1;
-        create_info.mipLevels = 1;
+        create_info.mipLevels = mip_levels;
         create_info.arrayLayers = 1;
         create_info.format = format;
         create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
@@ -173,17 +406,16 @@ vk::image_info::image_info(uint32_t width, uint32_t height, VkFormat format,
     VkMemoryRequirements mem_requirements;
     vkGetImageMemoryRequirements(d.device, vk_image_, &mem_requirements);
 
-    auto alloc_info = VkMemoryAllocateInfo{};
-    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    alloc_info.allocationSize = mem_requirements.size;
-    alloc_info.memoryTypeIndex =
-        find_memory_type(mem_requirements.memoryTypeBits, properties);
-
-    if (vkAllocateMemory(d.device, &alloc_info, d.allocator, &vk_memory_) !=
-        VK_SUCCESS)
-        throw std::runtime_error("Failed to allocate image memory.");
+    try {
+        mem_ = allocate(mem_requirements, properties, false);
+    }
+    catch (...) {
+        vkDestroyImage(d.device, std::exchange(vk_image_, nullptr),
+            d.allocator);
+        throw;
+    }
 
-    vkBindImageMemory(d.device, vk_image_, vk_memory_, 0);
+    vkBindImageMemory(d.device, vk_image_, mem_.memory, mem_.offset);
 
     VkImageViewCreateInfo view_info{};
     view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -192,7 +424,7 @@ vk::image_info::image_info(uint32_t width, uint32_t height, VkFormat format,
     view_info.format = format;
     view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     view_info.subresourceRange.baseMipLevel = 0;
-    view_info.subresourceRange.levelCount = 1;
+    view_info.subresourceRange.levelCount = mip_levels;
     view_info.subresourceRange.baseArrayLayer = 0;
     view_info.subresourceRange.layerCount = 1;
 
@@ -204,7 +436,7 @@ vk::image_info::image_info(uint32_t width, uint32_t height, VkFormat format,
 vk::image_info::image_info(image_info&& rhs)
     : vk_image_{std::exchange(rhs.vk_image_, nullptr)}
     , vk_view_{std::exchange(rhs.vk_view_, nullptr)}
-    , vk_memory_{std::exchange(rhs.vk_memory_, nullptr)}
+    , mem_{std::exchange(rhs.mem_, allocation{})}
 {
 }
 
@@ -212,10 +444,9 @@ vk::image_info::~image_info()
 {
     if (vk_view_)
         vkDestroyImageView(d.device, vk_view_, d.allocator);
-    if (vk_memory_)
-        vkFreeMemory(d.device, vk_memory_, d.allocator);
     if (vk_image_)
         vkDestroyImage(d.device, vk_image_, d.allocator);
+    release(mem_);
 }
 
 vk::descriptor_set_layout::descriptor_set_layout()
@@ -296,6 +527,179 @@ void vk::descriptor_set::update(image_info& img, sampler& smp)
     vkUpdateDescriptorSets(d.device, 1, &writes, 0, nullptr);
 }
 
+// bindless_capacity clamps a requested table size to the device limits,
+// it is 0 when the device lacks a descriptor indexing feature the table
+// and the bindless shaders use
+static auto bindless_capacity(uint32_t requested) -> uint32_t
+{
+    auto features = VkPhysicalDeviceDescriptorIndexingFeatures{};
+    features.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+    auto features2 = VkPhysicalDeviceFeatures2{};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features2.pNext = &features;
+    vkGetPhysicalDeviceFeatures2(d.physical_device, &features2);
+    if (!features.descriptorBindingPartiallyBound ||
+        !features.runtimeDescriptorArray ||
+        !features.shaderSampledImageArrayNonUniformIndexing ||
+        !features.descriptorBindingSampledImageUpdateAfterBind ||
+        !features.descriptorBindingUpdateUnusedWhilePending)
+        return 0;
+
+    auto indexing = VkPhysicalDeviceDescriptorIndexingProperties{};
+    indexing.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+    auto props = VkPhysicalDeviceProperties2{};
+    props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    props.pNext = &indexing;
+    vkGetPhysicalDeviceProperties2(d.physical_device, &props);
+    return std::min({requested,
+        indexing.maxDescriptorSetUpdateAfterBindSampledImages,
+        indexing.maxDescriptorSetUpdateAfterBindSamplers,
+        indexing.maxPerStageDescriptorUpdateAfterBindSamplers});
+}
+
+bindless_table::bindless_table(uint32_t capacity)
+    : capacity{capacity}
+{
+
+    auto const binding = VkDescriptorSetLayoutBinding{
+        .binding = 0,
+        .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .descriptorCount = capacity,
+        .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+        .pImmutableSamplers = nullptr,
+    };
+    auto const binding_flags = VkDescriptorBindingFlags{
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+        VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT};
+    auto const flags_info = VkDescriptorSetLayoutBindingFlagsCreateInfo{
+        .sType =
+            VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+        .pNext = nullptr,
+        .bindingCount = 1,
+        .pBindingFlags = &binding_flags,
+    };
+    auto const layout_info = VkDescriptorSetLayoutCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = &flags_info,
+        .flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+        .bindingCount = 1,
+        .pBindings = &binding,
+    };
+    if (vkCreateDescriptorSetLayout(d.device, &layout_info, d.allocator,
+            &layout) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create bindless set layout.");
+
+    auto const pool_size = VkDescriptorPoolSize{
+        .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .descriptorCount = capacity,
+    };
+    auto const pool_info = VkDescriptorPoolCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+        .maxSets = 1,
+        .poolSizeCount = 1,
+        .pPoolSizes = &pool_size,
+    };
+    if (vkCreateDescriptorPool(d.device, &pool_info, d.allocator, &pool) !=
+        VK_SUCCESS) {
+        vkDestroyDescriptorSetLayout(d.device, layout, d.allocator);
+        throw std::runtime_error("Failed to create bindless descriptor pool.");
+    }
+
+    auto const alloc_info = VkDescriptorSetAllocateInfo{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .pNext = nullptr,
+        .descriptorPool = pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &layout,
+    };
+    if (vkAllocateDescriptorSets(d.device, &alloc_info, &set) != VK_SUCCESS) {
+        vkDestroyDescriptorPool(d.device, pool, d.allocator);
+        vkDestroyDescriptorSetLayout(d.device, layout, d.allocator);
+        throw std::runtime_error("Failed to allocate bindless descriptor set.");
+    }
+}
+
+bindless_table::~bindless_table()
+{
+    // the set is released along with its pool
+    if (pool)
+        vkDestroyDescriptorPool(d.device, pool, d.allocator);
+    if (layout)
+        vkDestroyDescriptorSetLayout(d.device, layout, d.allocator);
+}
+
+auto bindless_table::acquire() -> uint32_t
+{
+    if (!free_slots.empty() &&
+        free_slots.front().frame + bindless_frames_in_flight <= frame_count) {
+        auto const slot = free_slots.front().slot;
+        free_slots.pop_front();
+        return slot;
+    }
+    if (next_slot >= capacity)
+        throw std::runtime_error("Bindless page table is full.");
+    return next_slot++;
+}
+
+void bindless_table::update(
+    uint32_t slot, vk::image_info& img, vk::sampler& smp)
+{
+    auto info = VkDescriptorImageInfo{};
+    info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    info.imageView = VkImageView(img);
+    info.sampler = smp;
+
+    auto writes = VkWriteDescriptorSet{};
+    writes.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes.dstSet = set;
+    writes.dstBinding = 0;
+    writes.dstArrayElement = slot;
+    writes.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writes.descriptorCount = 1;
+    writes.pImageInfo = &info;
+    vkUpdateDescriptorSets(d.device, 1, &writes, 0, nullptr);
+}
+
+auto vk::enable_bindless(uint32_t capacity) -> bool
+{
+    if (!d.device)
+        throw std::runtime_error("Bindless mode: missing device.");
+    if (!pages.empty())
+        throw std::runtime_error(
+            "Bindless mode must be enabled before creating pages.");
+    capacity = bindless_capacity(capacity);
+    if (!capacity)
+        return false;
+    bindless = std::make_unique<bindless_table>(capacity);
+    return true;
+}
+
+auto vk::frame_serial() -> uint64_t { return frame_count; }
+
+auto vk::bindless_enabled() -> bool { return bindless != nullptr; }
+
+auto vk::bindless_set_layout() -> VkDescriptorSetLayout
+{
+    return bindless ? bindless->layout : nullptr;
+}
+
+auto vk::bindless_set() -> VkDescriptorSet
+{
+    return bindless ? bindless->set : nullptr;
+}
+
+texture::page_data::~page_data()
+{
+    registry.erase(handle);
+    if (bindless && index != uint32_t(-1))
+        bindless->release(index);
+}
+
 static auto begin_single_time_commands(
     VkCommandPool command_pool) -> VkCommandBuffer
 {
@@ -342,63 +746,105 @@ static void end_single_time_commands(
     vkFreeCommandBuffers(d.device, command_pool, 1, &cb);
 }
 
+// image_upload is a region of one mip level, rows of row_bytes are stride
+// bytes apart in data, texels or blocks depending on the page format
+struct image_upload {
+    uint32_t level;
+    texture::texel_box box;
+    void const* data;
+    std::size_t stride;
+    std::size_t row_bytes;
+    uint32_t rows;
+};
+
+static auto texel_upload(uint32_t level, texture::texel_box const& box,
+    uint32_t const* data, std::size_t stride) -> image_upload
+{
+    return {level, box, data, stride * sizeof(uint32_t),
+        box.w * sizeof(uint32_t), box.h};
+}
+
 static void update_image_region(VkCommandPool command_pool, VkImage image,
-    uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint32_t const* data,
-    std::size_t data_stride_bytes)
+    uint32_t levels, bool initialized, std::span<image_upload const> uploads,
+    bool premultiply)
 {
-    auto const buffer_size = VkDeviceSize(w * h * sizeof(uint32_t));
+    auto buffer_size = VkDeviceSize(0);
+    for (auto const& u : uploads)
+        buffer_size += VkDeviceSize(u.row_bytes) * u.rows;
 
     auto staging_buffer =
         vk::buffer{buffer_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
                 VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
 
-    char* dst;
-    vkMapMemory(d.device, staging_buffer, 0, buffer_size, 0,
-        reinterpret_cast<void**>(&dst));
-    for (uint32_t y = 0; y < h; ++y) {
-        memcpy(dst, data, w * sizeof(uint32_t));
-        dst += w * sizeof(uint32_t);
-        data += data_stride_bytes;
+    // staging memory comes from a persistently mapped host-visible block,
+    // the regions are packed one after the other
+    auto regions = std::vector<VkBufferImageCopy>{};
+    regions.reserve(uploads.size());
+    auto offset = VkDeviceSize(0);
+    for (auto const& u : uploads) {
+        auto dst = static_cast<char*>(staging_buffer.mapped()) + offset;
+        if (premultiply)
+            pixel::premultiply(static_cast<uint32_t const*>(u.data),
+                u.stride / sizeof(uint32_t), reinterpret_cast<uint32_t*>(dst),
+                u.box.w, u.box.w, u.box.h);
+        else {
+            auto src = static_cast<char const*>(u.data);
+            for (uint32_t y = 0; y < u.rows; ++y) {
+                memcpy(dst, src, u.row_bytes);
+                dst += u.row_bytes;
+                src += u.stride;
+            }
+        }
+
+        auto region = VkBufferImageCopy{};
+        region.bufferOffset = offset;
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = u.level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = {
+            static_cast<int32_t>(u.box.x), static_cast<int32_t>(u.box.y), 0};
+        region.imageExtent = {u.box.w, u.box.h, 1};
+        regions.push_back(region);
+        offset += VkDeviceSize(u.row_bytes) * u.rows;
     }
-    vkUnmapMemory(d.device, staging_buffer);
 
     auto command_buffer = begin_single_time_commands(command_pool);
 
+    // once the image holds data its layout is kept, transitioning from
+    // undefined would discard the texels outside the updated regions
     auto copy_barrier = VkImageMemoryBarrier{};
     copy_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    copy_barrier.srcAccessMask = initialized ? VK_ACCESS_SHADER_READ_BIT : 0;
     copy_barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    copy_barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    copy_barrier.oldLayout = initialized
+                                 ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+                                 : VK_IMAGE_LAYOUT_UNDEFINED;
     copy_barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
     copy_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     copy_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     copy_barrier.image = image;
     copy_barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    copy_barrier.subresourceRange.levelCount = 1;
+    copy_barrier.subresourceRange.levelCount = levels;
     copy_barrier.subresourceRange.layerCount = 1;
     copy_barrier.subresourceRange.baseArrayLayer = 0;
     copy_barrier.subresourceRange.baseMipLevel = 0;
 
-    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_HOST_BIT,
+    vkCmdPipelineBarrier(command_buffer,
+        initialized ? VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+                    : VK_PIPELINE_STAGE_HOST_BIT,
         VK_PIPELINE_STAGE_TRANSFER_BIT,
         0,                 //
         0, nullptr,        //
         0, nullptr,        //
         1, &copy_barrier); //
 
-    auto region = VkBufferImageCopy{};
-    region.bufferOffset = 0;
-    region.bufferRowLength = 0;
-    region.bufferImageHeight = 0;
-    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    region.imageSubresource.mipLevel = 0;
-    region.imageSubresource.baseArrayLayer = 0;
-    region.imageSubresource.layerCount = 1;
-    region.imageOffset = {static_cast<int32_t>(x), static_cast<int32_t>(y), 0};
-    region.imageExtent = {w, h, 1};
-
     vkCmdCopyBufferToImage(command_buffer, staging_buffer, image,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, uint32_t(regions.size()),
+        regions.data());
 
     // Transition image layout back to shader read only optimal
     auto use_barrier = VkImageMemoryBarrier{};
@@ -411,7 +857,7 @@ static void update_image_region(VkCommandPool command_pool, VkImage image,
     use_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     use_barrier.image = image;
     use_barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    use_barrier.subresourceRange.levelCount = 1;
+    use_barrier.subresourceRange.levelCount = levels;
     use_barrier.subresourceRange.layerCount = 1;
 
     vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
@@ -424,62 +870,218 @@ static void update_image_region(VkCommandPool command_pool, VkImage image,
     end_single_time_commands(command_pool, command_buffer);
 }
 
-static auto new_page(texture::texel_size const& sz,
-    bool wrap) -> std::shared_ptr<texture::page_data>
+static auto vk_format(texture::format fmt) -> VkFormat
+{
+    switch (fmt) {
+    case texture::format::bgra8:
+        return VK_FORMAT_B8G8R8A8_UNORM;
+    case texture::format::bc1:
+        return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+    case texture::format::bc3:
+        return VK_FORMAT_BC3_UNORM_BLOCK;
+    case texture::format::bc7:
+        return VK_FORMAT_BC7_UNORM_BLOCK;
+    case texture::format::etc2_rgb8:
+        return VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK;
+    case texture::format::etc2_rgba8:
+        return VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK;
+    case texture::format::r8:
+        return VK_FORMAT_R8_UNORM;
+    case texture::format::rg8:
+        return VK_FORMAT_R8G8_UNORM;
+    default:
+        return VK_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+auto texture::supports(texture::format fmt) -> bool
+{
+    if (!is_compressed(fmt))
+        return true;
+    if (!d.physical_device)
+        return false;
+    auto props = VkFormatProperties{};
+    vkGetPhysicalDeviceFormatProperties(
+        d.physical_device, vk_format(fmt), &props);
+    return (props.optimalTilingFeatures &
+               VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+}
+
+static auto new_page(texture::texel_size const& sz, bool wrap,
+    texture::format fmt, uint32_t levels)
+    -> std::shared_ptr<texture::page_data>
 {
     if (!sz.w || !sz.h)
         return {};
 
-    auto info = vk::image_info{sz.w, sz.h, VK_FORMAT_R8G8B8A8_UNORM,
-        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT};
-
-    auto ds = vk::descriptor_set{};
+    if (!texture::supports(fmt))
+        throw std::runtime_error("Unsupported page format.");
 
-    if (wrap) {
-        if (!repeat_sampler)
-            repeat_sampler = std::make_shared<vk::sampler>(true);
-        ds.update(info, *repeat_sampler);
+    auto info = vk::image_info{sz.w, sz.h, vk_format(fmt),
+        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, levels};
+
+    auto& smp = wrap ? repeat_sampler : border_sampler;
+    if (!smp)
+        smp = std::make_shared<vk::sampler>(wrap);
+
+    auto p = std::make_shared<texture::page_data>(sz, wrap, std::move(info));
+    p->fmt = fmt;
+    p->levels = levels;
+    p->mips.setup(sz, levels);
+    if (bindless) {
+        p->index = bindless->acquire();
+        bindless->update(p->index, p->image, *smp);
     }
     else {
-        if (!border_sampler)
-            border_sampler = std::make_shared<vk::sampler>(false);
-        ds.update(info, *border_sampler);
+        p->ds.emplace();
+        p->ds->update(p->image, *smp);
     }
-
-    auto p = std::make_shared<texture::page_data>(
-        sz, wrap, std::move(info), std::move(ds));
+    auto native =
+        p->ds ? VkDescriptorSet(*p->ds) : VkDescriptorSet(bindless->set);
+    p->handle = texture::registry.insert(p, native, p->index, sz);
     pages.push_back(p);
     return p;
 }
 
 auto texture::page::update(texture::texel_box const& box, uint32_t const* data,
-    size_t data_stride_bytes) -> bool
+    size_t data_stride_bytes, bool premultiply) -> bool
 {
     if (!data || data_stride_bytes < size_t(box.w) || !f.command_pool)
         return false;
 
     if (auto pp = pd_.lock()) {
         auto& pd = *pp;
-        if (box.x + box.w > pd.sz.w || box.y + box.h > pd.sz.h)
+        if (box.x + box.w > pd.sz.w || box.y + box.h > pd.sz.h ||
+            is_plane(pd.fmt))
             return false;
 
-        update_image_region(f.command_pool, VkImage(pd.image), box.x, box.y,
-            box.w, box.h, data, data_stride_bytes);
+        if (is_compressed(pd.fmt)) {
+            // the encoder reuses its block buffer, keep a copy per level
+            auto blocks = std::vector<std::vector<std::byte>>{};
+            auto uploads = std::vector<image_upload>{};
+            auto const ok = detail::encode_levels(pd.fmt, pd.sz, pd.mips,
+                box, data, data_stride_bytes, premultiply,
+                [&](uint32_t level, texel_box const& b, void const* p) {
+                    auto const [row_bytes, rows] =
+                        detail::block_rows(pd.fmt, b);
+                    auto const bytes = static_cast<std::byte const*>(p);
+                    auto& copy =
+                        blocks.emplace_back(bytes, bytes + row_bytes * rows);
+                    uploads.push_back(
+                        {level, b, copy.data(), row_bytes, row_bytes, rows});
+                });
+            if (!ok)
+                return false;
+            update_image_region(f.command_pool, VkImage(pd.image), pd.levels,
+                pd.initialized, uploads, false);
+            pd.initialized = true;
+            return true;
+        }
+
+        auto uploads = std::vector<image_upload>{
+            texel_upload(0, box, data, data_stride_bytes)};
+        if (pd.levels > 1) {
+            // the mips are built from premultiplied texels
+            static std::vector<uint32_t> scratch;
+            if (premultiply) {
+                scratch.resize(size_t(box.w) * box.h);
+                pixel::premultiply(data, data_stride_bytes, scratch.data(),
+                    box.w, box.w, box.h);
+                data = scratch.data();
+                data_stride_bytes = box.w;
+                uploads[0] = texel_upload(0, box, data, data_stride_bytes);
+                premultiply = false;
+            }
+
+            static texture::mip_chain chain;
+            pd.mips.update(box, data, data_stride_bytes, chain);
+            for (uint32_t i = 1; i < pd.levels; ++i) {
+                auto const b = chain.box(i);
+                if (!b.w || !b.h)
+                    continue;
+                auto const level = chain.level(i);
+                uploads.push_back(texel_upload(i, b,
+                    reinterpret_cast<uint32_t const*>(level.data()),
+                    level.stride()));
+            }
+        }
+
+        update_image_region(f.command_pool, VkImage(pd.image), pd.levels,
+            pd.initialized, uploads, premultiply);
+        pd.initialized = true;
         return true;
     }
     return false;
 }
 
-auto texture::page::native_handle() const -> void*
+auto texture::page::update_blocks(
+    texture::texel_box const& box, void const* blocks, uint32_t level) -> bool
+{
+    if (!blocks || !f.command_pool)
+        return false;
+
+    if (auto pp = pd_.lock()) {
+        auto& pd = *pp;
+        if (!is_compressed(pd.fmt) || level >= pd.levels ||
+            !detail::block_aligned(box, mip_size(pd.sz, level)))
+            return false;
+
+        auto const [row_bytes, rows] = detail::block_rows(pd.fmt, box);
+        auto const upload =
+            image_upload{level, box, blocks, row_bytes, row_bytes, rows};
+        update_image_region(f.command_pool, VkImage(pd.image), pd.levels,
+            pd.initialized, {&upload, 1}, false);
+        pd.initialized = true;
+        return true;
+    }
+    return false;
+}
+
+auto texture::page::update_plane(texture::texel_box const& box,
+    void const* texels, size_t data_stride) -> bool
 {
+    if (!texels || data_stride < size_t(box.w) || !f.command_pool)
+        return false;
+
     if (auto pp = pd_.lock()) {
-        auto& ds = pp->ds;
-        return VkDescriptorSet(pp->ds);
+        auto& pd = *pp;
+        if (!is_plane(pd.fmt) || box.x + box.w > pd.sz.w ||
+            box.y + box.h > pd.sz.h)
+            return false;
+
+        auto const bytes = texel_bytes(pd.fmt);
+        auto const upload = image_upload{
+            0, box, texels, data_stride * bytes, box.w * bytes, box.h};
+        update_image_region(f.command_pool, VkImage(pd.image), pd.levels,
+            pd.initialized, {&upload, 1}, false);
+        pd.initialized = true;
+        return true;
     }
+    return false;
+}
+
+auto texture::page::native_handle() const -> void*
+{
+    if (auto pp = pd_.lock())
+        return pp->ds ? VkDescriptorSet(*pp->ds) : vk::bindless_set();
     return nullptr;
 }
 
+auto texture::page::native_index() const -> uint32_t
+{
+    if (auto pp = pd_.lock())
+        return pp->index;
+    return uint32_t(-1);
+}
+
+auto texture::page::handle() const -> texture::page_handle
+{
+    if (auto pp = pd_.lock())
+        return pp->handle;
+    return {};
+}
+
 auto texture::page::get_size() const -> texture::texel_size
 {
     if (auto pp = pd_.lock())
@@ -487,24 +1089,34 @@ auto texture::page::get_size() const -> texture::texel_size
     return {0, 0};
 }
 
-void texture::page::setup(texture::texel_size const& sz, bool wrap)
+auto texture::page::get_format() const -> texture::format
 {
+    if (auto pp = pd_.lock())
+        return pp->fmt;
+    return format::rgba8;
+}
+
+auto texture::page::get_levels() const -> uint32_t
+{
+    if (auto pp = pd_.lock())
+        return pp->levels;
+    return 0;
+}
+
+void texture::page::setup(texture::texel_size const& sz, bool wrap,
+    texture::format fmt, uint32_t levels)
+{
+    levels = is_plane(fmt) ? 1 : mip_levels(sz, levels);
     if (auto pp = pd_.lock()) {
-        if (pp->sz == sz && pp->wrap == wrap)
+        if (pp->sz == sz && pp->wrap == wrap && pp->fmt == fmt &&
+            pp->levels == levels)
             return;
     }
-    pd_ = new_page(sz, wrap);
+    pd_ = new_page(sz, wrap, fmt, levels);
 }
 
 void texture::page::release_all() { pages.clear(); }
 
-auto texture::sprite::native_handle() const -> void*
-{
-    if (auto pp = pd_.lock())
-        return VkDescriptorSet(pp->ds);
-    return nullptr;
-}
-
 auto create_glsl_shader_module(std::span<uint32_t const> compiled_code)
 {
     auto info = VkShaderModuleCreateInfo{};
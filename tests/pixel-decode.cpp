@@ -0,0 +1,190 @@
+#include <gtx/pixel/decode.hpp>
+
+#include <cstdio>
+#include <vector>
+
+// pixel-decode checks decoder corner cases against known QOI, PNM and TGA
+// encodings, small valid images and truncated ones
+
+using namespace gtx;
+
+namespace {
+
+auto failures = 0;
+
+void check(bool ok, char const* what)
+{
+    if (!ok) {
+        std::printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+auto bytes(std::vector<unsigned> const& v) -> std::vector<std::byte>
+{
+    auto b = std::vector<std::byte>{};
+    for (auto x : v)
+        b.push_back(std::byte(x));
+    return b;
+}
+
+// qoi wraps ops into a w x h rgba image with the end marker
+auto qoi(uint8_t w, uint8_t h, std::vector<unsigned> ops)
+    -> std::vector<std::byte>
+{
+    auto v = std::vector<unsigned>{'q', 'o', 'i', 'f', 0, 0, 0, w, 0, 0, 0,
+        h, 4, 0};
+    v.insert(v.end(), ops.begin(), ops.end());
+    v.insert(v.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+    return bytes(v);
+}
+
+void qoi_index_starts_transparent_black()
+{
+    // QOI_OP_INDEX 0 before any pixel was stored reads the zeroed index
+    auto const data = qoi(1, 1, {0x00});
+    auto px = pixel::nargb8888{0x12345678};
+    check(pixel::decode(data, surface<pixel::nargb8888>{&px, 1, 1}),
+        "qoi index 0 decodes");
+    check(px.value == 0x00000000, "qoi index 0 is transparent black");
+}
+
+void qoi_index_recalls_pixels()
+{
+    // QOI_OP_RGBA 10 20 30 40 then QOI_OP_INDEX of its hash
+    auto const slot = (10 * 3 + 20 * 5 + 30 * 7 + 40 * 11) % 64;
+    auto const data = qoi(2, 1, {0xff, 10, 20, 30, 40, unsigned(slot)});
+    pixel::nargb8888 px[2];
+    check(pixel::decode(data, surface<pixel::nargb8888>{px, 2, 1}),
+        "qoi rgba and index decode");
+    check(px[0].value == 0x280a141e && px[1].value == 0x280a141e,
+        "qoi index recalls the rgba pixel");
+}
+
+// pnm prefixes a header to the samples
+auto pnm(char const* header, std::vector<unsigned> samples)
+    -> std::vector<std::byte>
+{
+    auto v = std::vector<unsigned>{};
+    for (auto c = header; *c; ++c)
+        v.push_back(uint8_t(*c));
+    v.insert(v.end(), samples.begin(), samples.end());
+    return bytes(v);
+}
+
+void pnm_ppm_with_comment()
+{
+    auto const data = pnm("P6\n# gtx\n2 1\n255\n", {255, 0, 0, 0, 128, 255});
+    auto const info = pixel::probe(data);
+    check(info.format == pixel::image_format::pnm && info.size.w == 2 &&
+              info.size.h == 1 && !info.alpha,
+        "ppm probes as a 2x1 pnm without alpha");
+    pixel::nargb8888 px[2];
+    check(pixel::decode(data, surface<pixel::nargb8888>{px, 2, 1}),
+        "ppm decodes");
+    check(px[0].value == 0xffff0000 && px[1].value == 0xff0080ff,
+        "ppm samples are rgb with opaque alpha");
+}
+
+void pnm_pgm_wide_samples()
+{
+    // maxval above 255 stores big-endian 16-bit samples scaled to 8 bits
+    auto const data = pnm("P5 2 1 65535\n", {0x80, 0x00, 0xff, 0xff});
+    pixel::nargb8888 px[2];
+    check(pixel::decode(data, surface<pixel::nargb8888>{px, 2, 1}),
+        "16-bit pgm decodes");
+    check(px[0].value == 0xff808080 && px[1].value == 0xffffffff,
+        "16-bit pgm samples are scaled to grey");
+}
+
+void pnm_truncated()
+{
+    // two rows announced, one and a half stored
+    auto const data = pnm("P6 2 2 255\n", {1, 2, 3, 4, 5, 6, 7, 8, 9});
+    pixel::nargb8888 px[4] = {};
+    check(!pixel::decode(data, surface<pixel::nargb8888>{px, 2, 2}),
+        "truncated ppm fails");
+    check(px[0].value == 0xff010203 && px[2].value == 0,
+        "ppm rows before the truncation are decoded");
+    check(!pixel::decode(
+              pnm("P6 2 2", {}), surface<pixel::nargb8888>{px, 2, 2}),
+        "truncated ppm header fails");
+}
+
+// tga prefixes an 18 byte header without id or color map to the pixels
+auto tga(unsigned type, unsigned w, unsigned h, unsigned depth,
+    unsigned desc, std::vector<unsigned> pixels) -> std::vector<std::byte>
+{
+    auto v = std::vector<unsigned>{0, 0, type, 0, 0, 0, 0, 0, 0, 0, 0, 0, w,
+        0, h, 0, depth, desc};
+    v.insert(v.end(), pixels.begin(), pixels.end());
+    return bytes(v);
+}
+
+void tga_true_color_origins()
+{
+    // pixels are stored bgr, bottom row first unless bit 5 is set
+    auto const top = tga(2, 2, 1, 24, 0x20, {0, 0, 255, 255, 0, 0});
+    auto const info = pixel::probe(top);
+    check(info.format == pixel::image_format::tga && info.size.w == 2 &&
+              info.size.h == 1 && !info.alpha,
+        "tga probes as a 2x1 tga without alpha");
+    pixel::nargb8888 px[2];
+    check(pixel::decode(top, surface<pixel::nargb8888>{px, 2, 1}),
+        "24-bit tga decodes");
+    check(px[0].value == 0xffff0000 && px[1].value == 0xff0000ff,
+        "24-bit tga samples are bgr");
+
+    auto const bottom = tga(2, 1, 2, 24, 0, {0, 0, 255, 255, 0, 0});
+    check(pixel::decode(bottom, surface<pixel::nargb8888>{px, 1, 2}),
+        "bottom-up tga decodes");
+    check(px[0].value == 0xff0000ff && px[1].value == 0xffff0000,
+        "bottom-up tga rows are flipped");
+}
+
+void tga_rle_packets()
+{
+    // a repeat packet of 2 then a raw packet of 1, bgra with 8 alpha bits
+    auto const data = tga(10, 3, 1, 32, 0x28,
+        {0x81, 1, 2, 3, 4, 0x00, 5, 6, 7, 8});
+    check(pixel::probe(data).alpha, "32-bit tga has alpha");
+    pixel::nargb8888 px[3];
+    check(pixel::decode(data, surface<pixel::nargb8888>{px, 3, 1}),
+        "rle tga decodes");
+    check(px[0].value == 0x04030201 && px[1].value == 0x04030201 &&
+              px[2].value == 0x08070605,
+        "rle tga packets repeat and copy pixels");
+}
+
+void tga_truncated()
+{
+    pixel::nargb8888 px[4] = {};
+    auto const raw = tga(2, 2, 2, 24, 0x20, {1, 2, 3, 4, 5, 6, 7, 8, 9});
+    check(!pixel::decode(raw, surface<pixel::nargb8888>{px, 2, 2}),
+        "truncated tga fails");
+    check(px[0].value == 0xff030201 && px[2].value == 0xff090807 &&
+              px[3].value == 0,
+        "tga pixels before the truncation are decoded");
+    auto const rle = tga(10, 2, 1, 24, 0x20, {0x81});
+    check(!pixel::decode(rle, surface<pixel::nargb8888>{px, 2, 1}),
+        "a tga repeat packet without its pixel fails");
+    auto const header = tga(2, 2, 2, 24, 0x20, {});
+    check(!pixel::decode({header.data(), 12},
+              surface<pixel::nargb8888>{px, 2, 2}),
+        "a truncated tga header fails");
+}
+
+} // namespace
+
+int main()
+{
+    qoi_index_starts_transparent_black();
+    qoi_index_recalls_pixels();
+    pnm_ppm_with_comment();
+    pnm_pgm_wide_samples();
+    pnm_truncated();
+    tga_true_color_origins();
+    tga_rle_packets();
+    tga_truncated();
+    return failures ? 1 : 0;
+}
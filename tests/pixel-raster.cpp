@@ -0,0 +1,43 @@
+#include <gtx/pixel/raster.hpp>
+
+#include <cstdio>
+#include <vector>
+
+// pixel-raster fills paths whose edges reach outside the surface
+
+using namespace gtx;
+
+namespace {
+
+auto failures = 0;
+
+void check(bool ok, char const* what)
+{
+    if (!ok) {
+        std::printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+void triangle_across_left_edge()
+{
+    // the row steps of the long edge round to a little below x = 0, which
+    // once indexed the cell before the first row
+    auto p = pixel::path{};
+    p.move_to({58.6253662f, -16.4465637f});
+    p.line_to({-5.47097206f, 2.49735069f});
+    p.line_to({58.6253662f, 2.49735069f});
+    p.close();
+    auto px = std::vector<pixel::a8>(37 * 29);
+    pixel::fill(p, surface<pixel::a8>{px.data(), 37, 29});
+    check(px[36].value > 0 && px[3 * 37].value == 0,
+        "the triangle covers the top rows only");
+}
+
+} // namespace
+
+int main()
+{
+    triangle_across_left_edge();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,107 @@
+#include <gtx/tx-atlas.hpp>
+#include <gtx/tx-page.hpp>
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+// tx-atlas checks that erase_last gives the space of the tile inserted last
+// back, for each way insert_tile finds room, and that insert_shared
+// compares the pixels on a hash hit, pages are the host pages of
+// bench/cpu-page.cpp
+
+using namespace gtx;
+using namespace gtx::texture;
+
+namespace {
+
+using test_atlas = atlas<page, uint32_t>;
+
+auto failures = 0;
+
+void check(bool ok, char const* what)
+{
+    if (!ok) {
+        std::printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+// layout flattens the rows and cells of every page
+auto layout(test_atlas const& a) -> std::vector<unsigned>
+{
+    auto out = std::vector<unsigned>{unsigned(a.pages.size())};
+    for (auto const& p : a.pages)
+        for (auto const& r : p.rows) {
+            out.insert(out.end(), {r.y, r.h, r.sealed ? 1u : 0u});
+            for (auto const& c : r.cells)
+                out.insert(out.end(), {c.x, c.w, c.h});
+        }
+    return out;
+}
+
+// erased inserts a w by h tile, erases it and checks that the atlas is as
+// before and that inserting it again lands on the same spot
+void erased(test_atlas& a, uint16_t w, uint16_t h, char const* what)
+{
+    auto const before = layout(a);
+    auto const tiles = a.tiles.size();
+    a.insert_tile(w, h, 1);
+    auto const t = a.tiles.back();
+    check(a.erase_last(), what);
+    check(layout(a) == before && a.tiles.size() == tiles, what);
+    a.insert_tile(w, h, 2);
+    auto const& again = a.tiles.back();
+    check(again.x == t.x && again.y == t.y && again.pageref == t.pageref,
+        what);
+}
+
+void erase_last()
+{
+    auto a = test_atlas{64, 64};
+    check(!a.erase_last(), "nothing to erase in an empty atlas");
+    erased(a, 16, 16, "erasing the first tile drops its page");
+    erased(a, 16, 8, "erasing a tile at the end of a row");
+    erased(a, 8, 8, "erasing a tile in a cell");
+    erased(a, 48, 16, "erasing a tile in a new row");
+    check(a.pages[0].rows.size() == 2, "the tile took a new row");
+    erased(a, 32, 48, "erasing a tile on a new page");
+    check(a.pages.size() == 2, "the tile took a new page");
+    check(a.erase_last() && !a.erase_last(), "erase_last only erases once");
+
+    auto const px = std::vector<std::byte>(4 * 4 * 4);
+    a.insert_shared(4, 4, 0xabc, px, 3);
+    a.insert_shared(4, 4, 0xabc, px, 4);
+    check(!a.erase_last(), "a shared tile has no space to erase");
+}
+
+// insert_shared shares a rect only when the pixels match, not on the hash
+// alone
+void shared_collision()
+{
+    auto a = test_atlas{64, 64};
+    auto px = std::vector<std::byte>(4 * 4 * 4, std::byte{1});
+    auto const first = a.insert_shared(4, 4, 0xabc, px, 1);
+    auto const same = a.insert_shared(4, 4, 0xabc, px, 2);
+    check(first.upload && !same.upload && a.tiles[1].x == a.tiles[0].x &&
+              a.tiles[1].y == a.tiles[0].y,
+        "the same image is shared");
+    px[5] = std::byte{2};
+    auto const other = a.insert_shared(4, 4, 0xabc, px, 3);
+    check(other.upload &&
+              (a.tiles[2].x != a.tiles[0].x || a.tiles[2].y != a.tiles[0].y),
+        "another image under the same hash gets its own rect");
+    check(a.shared.at(0xabc).refs == 2 && a.shared.at(0xabc).tile == 0,
+        "the shared entry keeps the first image");
+    auto const small = a.insert_shared(4, 4, 0xabc, {px.data(), 32}, 4);
+    check(small.upload, "a shorter source is not shared");
+}
+
+} // namespace
+
+int main()
+{
+    erase_last();
+    shared_collision();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,76 @@
+#include <gtx/tx-atlas.hpp>
+#include <gtx/tx-mipmap.hpp>
+#include <gtx/tx-page.hpp>
+
+#include <cstdio>
+#include <vector>
+
+// tx-mipmap checks that small updates rebuild the coarse texels they share
+// with the rest of the page from all of its texels
+
+using namespace gtx;
+using namespace gtx::texture;
+
+namespace {
+
+auto failures = 0;
+
+void check(bool ok, char const* what)
+{
+    if (!ok) {
+        std::printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+void region_is_aligned()
+{
+    auto const r = mip_region({5, 6, 2, 9}, {100, 20}, 3);
+    check(r.x == 4 && r.y == 4 && r.w == 4 && r.h == 12,
+        "the region grows to multiples of 4");
+    auto const e = mip_region({97, 0, 2, 2}, {99, 99}, 3);
+    check(e.x == 96 && e.w == 3, "the region ends at the page edge");
+}
+
+void update_reads_the_page()
+{
+    auto src = mip_source{};
+    src.setup({16, 16}, 3);
+    auto chain = mip_chain{};
+
+    // a 2x2 white box in a transparent page: the level 2 texel over
+    // [4, 8) x [4, 8) averages 4 white texels of 16
+    uint32_t const white[] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff};
+    src.update({5, 5, 2, 2}, white, 2, chain);
+    auto const b = chain.box(2);
+    check(b.x == 1 && b.y == 1 && b.w == 1 && b.h == 1,
+        "level 2 of the update is one texel");
+    auto const a = chain.level(2).data()[0].a;
+    check(a >= 63 && a <= 65, "level 2 averages the whole region");
+
+    // a second box in the same region keeps the first one
+    src.update({4, 4, 1, 1}, white, 1, chain);
+    auto const a2 = chain.level(2).data()[0].a;
+    check(a2 >= 79 && a2 <= 81, "level 2 keeps the earlier update");
+}
+
+void atlas_pads_tiles()
+{
+    auto a = atlas<page, int>{64, 64, 1, 3};
+    check(a.align == 4, "three levels align tiles to 4");
+    a.insert_tile(3, 5, 1);
+    a.insert_tile(3, 3, 2);
+    check(a.tiles[1].x % 4 == 0 && a.tiles[1].y % 4 == 0,
+        "tiles start on whole texels of level 2");
+    check(a.pages[0].base.get_levels() == 3, "atlas pages get the levels");
+}
+
+} // namespace
+
+int main()
+{
+    region_is_aligned();
+    update_reads_the_page();
+    atlas_pads_tiles();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,169 @@
+#include <gtx/tx-snapshot.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+// tx-snapshot saves an atlas, loads it back and checks that snapshots with
+// inconsistent geometry are rejected, pages are the host pages of
+// bench/cpu-page.cpp
+
+using namespace gtx;
+using namespace gtx::texture;
+
+namespace {
+
+using test_atlas = atlas<page, uint32_t>;
+
+auto failures = 0;
+
+void check(bool ok, char const* what)
+{
+    if (!ok) {
+        std::printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+constexpr auto path = "tx-snapshot-test.gtxatlas";
+
+// source is the 4x4 image inserted with insert_shared
+auto const source = std::vector<std::byte>(4 * 4 * 4, std::byte{7});
+
+auto saved() -> std::vector<std::byte>
+{
+    auto a = test_atlas{64, 64};
+    a.insert_tile(16, 16, 1);
+    a.insert_tile(8, 8, 2);
+    a.insert_tile(48, 20, 3);
+    a.insert_shared(4, 4, 0xabc, source, 4);
+    a.insert_shared(4, 4, 0xabc, source, 5);
+    auto const texels = std::vector<std::byte>(
+        page_bytes(format::rgba8, {64, 64}) * a.pages.size());
+    auto spans = std::vector<std::span<std::byte const>>{};
+    for (std::size_t i = 0; i < a.pages.size(); ++i)
+        spans.push_back(std::span{texels}.subspan(
+            i * page_bytes(format::rgba8, {64, 64}),
+            page_bytes(format::rgba8, {64, 64})));
+    if (!save_snapshot(path, a, format::rgba8, spans))
+        return {};
+    auto in = std::ifstream{path, std::ios::binary};
+    auto const c = std::vector<char>{std::istreambuf_iterator<char>{in}, {}};
+    auto bytes = std::vector<std::byte>(c.size());
+    std::memcpy(bytes.data(), c.data(), c.size());
+    return bytes;
+}
+
+auto header(std::vector<std::byte>& data) -> snapshot_header&
+{
+    return *reinterpret_cast<snapshot_header*>(data.data());
+}
+
+template <typename T>
+auto table(std::vector<std::byte>& data, uint64_t offset) -> T*
+{
+    return reinterpret_cast<T*>(data.data() + offset);
+}
+
+auto loads(std::vector<std::byte> const& data) -> bool
+{
+    auto a = test_atlas{64, 64};
+    return load_snapshot(data, a, format::rgba8);
+}
+
+void round_trip()
+{
+    auto const data = saved();
+    check(!data.empty(), "snapshot saved");
+    auto a = test_atlas{64, 64};
+    check(load_snapshot(data, a, format::rgba8), "snapshot loads");
+    check(a.tiles.size() == 5 && a.tiles[2].payload == 3 &&
+              a.tiles[2].w == 48 && a.tiles[2].h == 20,
+        "tiles are restored");
+    auto const it = a.shared.find(0xabc);
+    check(it != a.shared.end() && it->second.tile == 3 &&
+              it->second.w == 4 && it->second.h == 4 && it->second.refs == 2 &&
+              it->second.source == source,
+        "the shared index is restored");
+    auto const again = a.insert_shared(4, 4, 0xabc, source, 6);
+    check(!again.upload && a.tiles.back().x == a.tiles[3].x &&
+              a.tiles.back().y == a.tiles[3].y,
+        "a restored shared image is reused");
+}
+
+void shared_outside_tiles()
+{
+    auto data = saved();
+    auto& h = header(data);
+    check(h.shared == 1, "the atlas has a shared image");
+    table<snapshot_shared>(data, h.shared_offset)[0].tile = h.tiles;
+    check(!loads(data), "a shared entry past the tiles is rejected");
+}
+
+void shared_source_outside()
+{
+    auto data = saved();
+    auto& h = header(data);
+    auto& s = table<snapshot_shared>(data, h.shared_offset)[0];
+    check(s.source_bytes == source.size(), "the shared source is saved");
+    s.source_offset = h.file_bytes - s.source_bytes + 1;
+    check(!loads(data), "a shared source past the data is rejected");
+}
+
+void row_outside_page()
+{
+    auto data = saved();
+    auto& h = header(data);
+    table<snapshot_row>(data, h.rows_offset)[0].y = 60;
+    check(!loads(data), "a row below the page is rejected");
+}
+
+void rows_overlap()
+{
+    auto data = saved();
+    auto& h = header(data);
+    auto rows = table<snapshot_row>(data, h.rows_offset);
+    check(h.rows == 2, "the atlas has two rows");
+    rows[1].y = uint16_t(rows[0].y + rows[0].h - 1);
+    check(!loads(data), "overlapping rows are rejected");
+}
+
+void cells_overlap()
+{
+    auto data = saved();
+    auto& h = header(data);
+    auto rows = table<snapshot_row>(data, h.rows_offset);
+    auto cells = table<snapshot_cell>(data, h.cells_offset);
+    check(rows[0].cell_count >= 2, "the first row has two cells");
+    cells[1].x = uint16_t(cells[0].x + cells[0].w - 1);
+    check(!loads(data), "overlapping cells are rejected");
+}
+
+void cell_outside_row()
+{
+    auto data = saved();
+    auto& h = header(data);
+    auto rows = table<snapshot_row>(data, h.rows_offset);
+    auto cells = table<snapshot_cell>(data, h.cells_offset);
+    cells[0].h = uint16_t(rows[0].h + 1);
+    check(!loads(data), "a cell taller than its row is rejected");
+    cells[0].h = rows[0].h;
+    cells[0].x = 60;
+    check(!loads(data), "a cell right of the page is rejected");
+}
+
+} // namespace
+
+int main()
+{
+    round_trip();
+    row_outside_page();
+    rows_overlap();
+    cells_overlap();
+    cell_outside_row();
+    shared_outside_tiles();
+    shared_source_outside();
+    std::remove(path);
+    return failures ? 1 : 0;
+}